@@ -0,0 +1,237 @@
+// This is a benchmark of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialGroup.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <unistd.h>
+
+// Spread between the first and the last port to receive a broadcast frame,
+// with a loop of writeBytes() and with ofSerialGroup::write(), over pseudo
+// terminals. Port 0 is a slow device: its output buffer is full when the
+// frame is sent and its reader only starts draining it after --slow-us,
+// which is what a stalled adapter looks like. The spread is measured on the
+// device side, among the other ports. A port whose device hung up must make
+// ofSerialGroup::write() fail it at once, not at the timeout.
+//
+// Usage: serial_bench_broadcast [--ports N] [--rounds N] [--frame BYTES]
+//                               [--slow-us US] [--out FILE]
+
+using Clock = std::chrono::steady_clock;
+
+struct ModeResult {
+	const char * name = "";
+	std::vector<double> spreadsUs;  ///< \brief Per round, among the healthy ports.
+	std::vector<double> lastUs;  ///< \brief Per round, from the write to the last healthy port.
+	size_t failed = 0;
+};
+
+//----------------------------------------------------------------
+static int64_t nowNs() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+//----------------------------------------------------------------
+static double percentile(std::vector<double> values, double p) {
+	if (values.empty()) return 0;
+	std::sort(values.begin(), values.end());
+	return values[std::min(values.size() - 1, size_t(p * double(values.size())))];
+}
+
+//----------------------------------------------------------------
+// Reads every master, stamps the arrival of each complete frame on ports 1..N-1.
+// Port 0 is only read from 'slowReadFrom' on, and its bytes are not counted.
+static void runDevices(const std::vector<int> & masters, size_t frameSize, std::atomic<int64_t> & slowReadFrom,
+	std::vector<std::atomic<int64_t>> & arrivals, std::atomic<bool> & bStop) {
+	std::vector<size_t> received(masters.size(), 0);
+	std::vector<struct pollfd> fds;
+	std::vector<size_t> index;
+	uint8_t buffer[4096];
+	while (!bStop) {
+		fds.clear();
+		index.clear();
+		const bool bSlowReadable = nowNs() >= slowReadFrom.load();
+		for (size_t i = bSlowReadable ? 0 : 1; i < masters.size(); i++) {
+			fds.push_back({ masters[i], POLLIN, 0 });
+			index.push_back(i);
+		}
+		if (::poll(fds.data(), nfds_t(fds.size()), bSlowReadable ? 10 : 0) <= 0) {
+			continue;
+		}
+		for (size_t k = 0; k < fds.size(); k++) {
+			if ((fds[k].revents & POLLIN) == 0) continue;
+			const auto n = read(fds[k].fd, buffer, sizeof(buffer));
+			const int64_t now = nowNs();
+			const size_t i = index[k];
+			if (n <= 0 || i == 0) continue;
+			const size_t before = received[i] / frameSize;
+			received[i] += size_t(n);
+			for (size_t frame = before; frame < received[i] / frameSize; frame++) {
+				arrivals[frame * masters.size() + i].store(now);
+			}
+		}
+	}
+}
+
+//----------------------------------------------------------------
+// Writes a frame to a healthy port and to one whose pseudo terminal master is closed.
+static bool checkHungUp(double & elapsedMs, bool & bFailed) {
+	int masters[2];
+	ofSerial ports[2];
+	ofSerialGroup group;
+	for (size_t i = 0; i < 2; i++) {
+		int slave = -1;
+		char slaveName[256];
+		if (openpty(&masters[i], &slave, slaveName, nullptr, nullptr) != 0) {
+			std::cerr << "openpty failed: " << strerror(errno) << std::endl;
+			return false;
+		}
+		if (!ports[i].setup(std::string_view(slaveName), 115200)) return false;
+		close(slave);
+		group.addPort(ports[i]);
+	}
+	// the slave now fails with EIO
+	close(masters[1]);
+
+	const std::vector<uint8_t> frame(64, 0x55);
+	auto & result = group.write(frame, std::chrono::seconds(2));
+	elapsedMs = std::chrono::duration<double, std::milli>(result.elapsed).count();
+	bFailed = result.ports[0].status == ofSerialWriteStatus::Done && result.ports[1].status == ofSerialWriteStatus::Failed;
+	for (auto & port : ports) port.close();
+	close(masters[0]);
+	return true;
+}
+
+//----------------------------------------------------------------
+int main(int argc, char * argv[]) {
+	size_t numPorts = 32;
+	size_t numRounds = 200;
+	size_t frameSize = 64;
+	int64_t slowUs = 2000;
+	std::string outPath;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		if (option == "--ports") numPorts = std::max<size_t>(size_t(std::stoul(argv[i + 1])), 2);
+		else if (option == "--rounds") numRounds = size_t(std::stoul(argv[i + 1]));
+		else if (option == "--frame") frameSize = std::max<size_t>(size_t(std::stoul(argv[i + 1])), 1);
+		else if (option == "--slow-us") slowUs = std::stoll(argv[i + 1]);
+		else if (option == "--out") outPath = argv[i + 1];
+		else {
+			std::cerr << "unknown option " << option << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::vector<int> masters(numPorts);
+	std::vector<std::unique_ptr<ofSerial>> ports(numPorts);
+	for (size_t i = 0; i < numPorts; i++) {
+		int slave = -1;
+		char slaveName[256];
+		if (openpty(&masters[i], &slave, slaveName, nullptr, nullptr) != 0) {
+			std::cerr << "openpty failed: " << strerror(errno) << std::endl;
+			return EXIT_FAILURE;
+		}
+		struct termios options;
+		tcgetattr(masters[i], &options);
+		cfmakeraw(&options);
+		tcsetattr(masters[i], TCSANOW, &options);
+		fcntl(masters[i], F_SETFL, O_NONBLOCK);
+		ports[i] = std::make_unique<ofSerial>();
+		if (!ports[i]->setup(std::string_view(slaveName), 115200)) {
+			return EXIT_FAILURE;
+		}
+		close(slave);
+	}
+
+	const std::vector<uint8_t> frame(frameSize, 0x55);
+	ModeResult modes[2];
+	modes[0].name = "write_loop";
+	modes[1].name = "group";
+	ofSerialGroup group;
+	for (auto & port : ports) group.addPort(*port);
+
+	for (size_t mode = 0; mode < 2; mode++) {
+		std::atomic<int64_t> slowReadFrom(0);
+		std::atomic<bool> bStop(false);
+		std::vector<std::atomic<int64_t>> arrivals(numRounds * numPorts);
+		for (auto & arrival : arrivals) arrival.store(0);
+		// the previous mode left port 0 full
+		uint8_t drain[4096];
+		while (read(masters[0], drain, sizeof(drain)) > 0) {}
+		std::thread devices(runDevices, std::cref(masters), frameSize, std::ref(slowReadFrom), std::ref(arrivals), std::ref(bStop));
+
+		std::vector<int64_t> starts(numRounds);
+		for (size_t round = 0; round < numRounds; round++) {
+			// fill the slow port while nobody reads it
+			slowReadFrom.store(INT64_MAX);
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			if (slowUs > 0) {
+				while (ports[0]->writeSome(frame.data(), frame.size()) > 0) {}
+			}
+
+			starts[round] = nowNs();
+			slowReadFrom.store(starts[round] + slowUs * 1000);
+			if (mode == 0) {
+				for (auto & port : ports) {
+					if (port->writeBytes(frame.data(), frame.size()) != frame.size()) modes[mode].failed++;
+				}
+			} else {
+				auto & result = group.write(frame, std::chrono::seconds(2));
+				modes[mode].failed += result.ports.size() - result.numDone;
+			}
+
+			// every healthy port got the frame
+			const auto deadline = Clock::now() + std::chrono::seconds(2);
+			for (size_t i = 1; i < numPorts; i++) {
+				while (arrivals[round * numPorts + i].load() == 0 && Clock::now() < deadline) std::this_thread::yield();
+			}
+			int64_t first = INT64_MAX, last = 0;
+			for (size_t i = 1; i < numPorts; i++) {
+				const int64_t arrival = arrivals[round * numPorts + i].load();
+				first = std::min(first, arrival);
+				last = std::max(last, arrival);
+			}
+			modes[mode].spreadsUs.push_back(double(last - first) / 1000.0);
+			modes[mode].lastUs.push_back(double(last - starts[round]) / 1000.0);
+		}
+		bStop = true;
+		devices.join();
+	}
+
+	double hungUpMs = 0;
+	bool bHungUpFailed = false;
+	const bool bHungUpOk = checkHungUp(hungUpMs, bHungUpFailed) && bHungUpFailed && hungUpMs < 500;
+
+	std::ostringstream out;
+	out << "{\n  \"benchmark\": \"broadcast\",\n  \"ports\": " << numPorts
+		<< ",\n  \"rounds\": " << numRounds
+		<< ",\n  \"frame_bytes\": " << frameSize
+		<< ",\n  \"slow_port_us\": " << slowUs
+		<< ",\n  \"modes\": [";
+	const char * separator = "\n";
+	for (auto & mode : modes) {
+		out << separator << "    { \"mode\": \"" << mode.name
+			<< "\", \"spread_p50_us\": " << percentile(mode.spreadsUs, 0.5)
+			<< ", \"spread_p99_us\": " << percentile(mode.spreadsUs, 0.99)
+			<< ", \"last_port_p50_us\": " << percentile(mode.lastUs, 0.5)
+			<< ", \"failed\": " << mode.failed << " }";
+		separator = ",\n";
+	}
+	out << "\n  ],\n  \"hung_up_port_failed\": " << (bHungUpFailed ? "true" : "false")
+		<< ",\n  \"hung_up_write_ms\": " << hungUpMs << "\n}\n";
+	std::cout << out.str();
+	if (!outPath.empty()) std::ofstream(outPath) << out.str();
+	for (auto fd : masters) close(fd);
+	return modes[0].failed + modes[1].failed == 0 && bHungUpOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
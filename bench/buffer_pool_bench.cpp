@@ -0,0 +1,293 @@
+// This is a benchmark of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerial.h"
+#include "ofSerialBufferPool.h"
+#include "ofSerialCrc.h"
+#include "ofSerialFraming.h"
+#include "ofSerialMpscQueue.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <pty.h>
+#include <unistd.h>
+
+// Fan-out of decoded frames to several consumer threads (a logger, a parser,
+// a forwarder...), each fed by its own queue and computing the CRC-32 of
+// every frame. The reader decodes a COBS stream in memory and hands each
+// frame over either as one std::vector copy per consumer, or as one pooled
+// buffer shared by all of them. The heap allocations made while streaming
+// are counted. A last pass checks ofSerial::readFrames() and readSome()
+// with a pool over a pseudo terminal, and that buffers released on consumer
+// threads that stay alive can all be acquired again by the reader.
+//
+// Usage: serial_bench_buffer_pool [--frames N] [--consumers N] [--out FILE]
+
+using Clock = std::chrono::steady_clock;
+
+static std::atomic<size_t> numAllocations(0);
+static std::atomic<uint32_t> crcSink(0);
+
+//----------------------------------------------------------------
+void * operator new(size_t size) {
+	numAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void * p = std::malloc(size ? size : 1)) return p;
+	std::abort();
+}
+
+//----------------------------------------------------------------
+void operator delete(void * p) noexcept {
+	std::free(p);
+}
+
+//----------------------------------------------------------------
+void operator delete(void * p, size_t) noexcept {
+	std::free(p);
+}
+
+struct ModeResult {
+	const char * name = "";
+	double seconds = 0;
+	size_t allocations = 0;
+	size_t badFrames = 0;
+	size_t peakInUse = 0;
+};
+
+//----------------------------------------------------------------
+// Frame i carries i in its first 8 bytes, its size varies from 16 to 1000 bytes.
+static std::vector<uint8_t> encodeStream(size_t numFrames) {
+	std::vector<uint8_t> stream;
+	std::vector<uint8_t> payload;
+	std::vector<uint8_t> encoded(ofSerialCobsEncoder::getMaxEncodedLength(1000));
+	for (uint64_t i = 0; i < numFrames; i++) {
+		payload.resize(16 + (i * 7919) % 985);
+		memcpy(payload.data(), &i, sizeof(i));
+		for (size_t k = sizeof(i); k < payload.size(); k++) payload[k] = uint8_t(i * 31 + k);
+		const size_t n = ofSerialCobsEncoder::encode(payload, encoded);
+		stream.insert(stream.end(), encoded.begin(), encoded.begin() + ptrdiff_t(n));
+	}
+	return stream;
+}
+
+//----------------------------------------------------------------
+// Consumer side shared by both modes: frames must come in order, the CRC keeps the bytes alive.
+static void consume(std::span<const uint8_t> frame, uint64_t & next, size_t & bad, uint32_t & crcs) {
+	uint64_t index = UINT64_MAX;
+	if (frame.size() >= sizeof(index)) memcpy(&index, frame.data(), sizeof(index));
+	if (index != next++) bad++;
+	crcs ^= ofSerialCrc32::compute(frame);
+}
+
+//----------------------------------------------------------------
+template<typename Item, typename Fanout>
+static ModeResult run(const char * name, const std::vector<uint8_t> & stream, size_t numFrames, size_t numConsumers, Fanout && fanout) {
+	ModeResult result;
+	result.name = name;
+	std::vector<std::unique_ptr<ofSerialMpscQueue<Item>>> queues;
+	for (size_t c = 0; c < numConsumers; c++) queues.push_back(std::make_unique<ofSerialMpscQueue<Item>>(256));
+	std::atomic<size_t> badFrames(0);
+	std::vector<std::thread> consumers;
+	for (size_t c = 0; c < numConsumers; c++) {
+		consumers.emplace_back([&, c]() {
+			uint64_t next = 0;
+			size_t bad = 0;
+			uint32_t crcs = 0;
+			Item item;
+			while (next < numFrames) {
+				if (!queues[c]->tryPop(item)) {
+					std::this_thread::yield();
+					continue;
+				}
+				consume(std::span<const uint8_t>(item.data(), item.size()), next, bad, crcs);
+				item = Item();
+			}
+			badFrames += bad;
+			crcSink ^= crcs;
+		});
+	}
+
+	ofSerialCobsDecoder decoder;
+	const size_t allocationsBefore = numAllocations.load();
+	const auto begin = Clock::now();
+	for (size_t offset = 0; offset < stream.size(); offset += 4096) {
+		decoder.feed(stream.data() + offset, std::min<size_t>(4096, stream.size() - offset), [&](std::span<const uint8_t> frame) {
+			fanout(frame, queues, result);
+		});
+	}
+	for (auto & consumer : consumers) consumer.join();
+	result.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+	result.allocations = numAllocations.load() - allocationsBefore;
+	result.badFrames = badFrames.load();
+	return result;
+}
+
+//----------------------------------------------------------------
+template<typename Item>
+static void push(ofSerialMpscQueue<Item> & queue, Item && item) {
+	while (!queue.tryPush(std::move(item))) std::this_thread::yield();
+}
+
+//----------------------------------------------------------------
+// readFrames() and readSome() with a pool, over a pseudo terminal.
+static bool checkPort(size_t numFrames) {
+	int master = -1, slave = -1;
+	char slaveName[256];
+	if (openpty(&master, &slave, slaveName, nullptr, nullptr) != 0) return false;
+	struct termios options;
+	tcgetattr(master, &options);
+	cfmakeraw(&options);
+	tcsetattr(master, TCSANOW, &options);
+	close(slave);
+	ofSerial port;
+	if (!port.setup(std::string_view(slaveName), 115200)) return false;
+
+	ofSerialBufferPool pool({ { 128, 64 }, { 1024, 64 } });
+	const auto stream = encodeStream(numFrames);
+	std::thread device([&]() {
+		for (size_t done = 0; done < stream.size();) {
+			const auto n = write(master, stream.data() + done, std::min<size_t>(1024, stream.size() - done));
+			if (n > 0) done += size_t(n);
+		}
+	});
+	ofSerialCobsDecoder decoder;
+	uint64_t next = 0;
+	size_t bad = 0;
+	uint32_t crcs = 0;
+	std::vector<ofSerialBuffer> held;
+	const auto deadline = Clock::now() + std::chrono::seconds(10);
+	while (next < numFrames && Clock::now() < deadline) {
+		port.readFrames(decoder, pool, [&](ofSerialBuffer frame) {
+			consume(frame.span(), next, bad, crcs);
+			held.push_back(std::move(frame));
+			if (held.size() > 16) held.erase(held.begin());
+		});
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+	device.join();
+	held.clear();
+
+	// readSome() fills the free space of a pooled buffer
+	ofSerialBuffer buffer = pool.acquire(100);
+	const auto written = write(master, "pooled", 6);
+	const auto result = port.readSome(buffer, Clock::now() + std::chrono::seconds(1));
+	const bool bSome = written == 6 && result && buffer.size() == 6 && memcmp(buffer.data(), "pooled", 6) == 0;
+	buffer.reset();
+
+	port.close();
+	close(master);
+	return next == numFrames && bad == 0 && bSome && pool.getNumInUse() == 0;
+}
+
+//----------------------------------------------------------------
+// Every buffer of a small pool is released on live consumer threads, the reader must get them all back.
+static bool checkExhaustion(size_t numConsumers, size_t & numFailed) {
+	ofSerialBufferPool pool(128, 64);
+	std::vector<std::unique_ptr<ofSerialMpscQueue<ofSerialBuffer>>> queues;
+	for (size_t c = 0; c < numConsumers; c++) queues.push_back(std::make_unique<ofSerialMpscQueue<ofSerialBuffer>>(64));
+	std::atomic<size_t> numReleased(0);
+	std::atomic<bool> bStop(false);
+	std::vector<std::thread> consumers;
+	for (size_t c = 0; c < numConsumers; c++) {
+		consumers.emplace_back([&, c]() {
+			ofSerialBuffer buffer;
+			while (!bStop) {
+				if (queues[c]->tryPop(buffer)) {
+					buffer.reset();
+					numReleased++;
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	bool bOk = true;
+	for (int round = 0; round < 4; round++) {
+		std::vector<ofSerialBuffer> buffers;
+		for (size_t i = 0; i < pool.getNumBuffers(); i++) buffers.push_back(pool.acquire(100));
+		for (auto & buffer : buffers) bOk = bOk && buffer;
+		// the consumers cache what they release, then wait for more
+		numReleased = 0;
+		for (size_t i = 0; i < buffers.size(); i++) push(*queues[i % numConsumers], std::move(buffers[i]));
+		while (numReleased < buffers.size()) std::this_thread::yield();
+	}
+	numFailed = pool.getNumFailed();
+	bStop = true;
+	for (auto & consumer : consumers) consumer.join();
+	return bOk && numFailed == 0 && pool.getNumInUse() == 0;
+}
+
+//----------------------------------------------------------------
+int main(int argc, char * argv[]) {
+	size_t numFrames = 200000;
+	size_t numConsumers = 3;
+	std::string outPath;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		if (option == "--frames") numFrames = size_t(std::stoul(argv[i + 1]));
+		else if (option == "--consumers") numConsumers = std::max<size_t>(size_t(std::stoul(argv[i + 1])), 1);
+		else if (option == "--out") outPath = argv[i + 1];
+		else {
+			std::cerr << "unknown option " << option << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const auto stream = encodeStream(numFrames);
+	ModeResult modes[2];
+	modes[0] = run<std::vector<uint8_t>>("vector_copies", stream, numFrames, numConsumers,
+		[](std::span<const uint8_t> frame, auto & queues, ModeResult &) {
+			for (auto & queue : queues) push(*queue, std::vector<uint8_t>(frame.begin(), frame.end()));
+		});
+
+	ofSerialBufferPool pool({ { 128, 1024 }, { 512, 1024 }, { 1024, 1024 } });
+	size_t numRetries = 0;
+	modes[1] = run<ofSerialBuffer>("shared_pool", stream, numFrames, numConsumers,
+		[&](std::span<const uint8_t> frame, auto & queues, ModeResult & result) {
+			ofSerialBuffer buffer = pool.acquire(frame.size());
+			while (!buffer) {
+				numRetries++;
+				std::this_thread::yield();
+				buffer = pool.acquire(frame.size());
+			}
+			memcpy(buffer.data(), frame.data(), frame.size());
+			buffer.resize(frame.size());
+			for (size_t c = 1; c < queues.size(); c++) push(*queues[c], ofSerialBuffer(buffer));
+			push(*queues[0], std::move(buffer));
+			result.peakInUse = std::max(result.peakInUse, pool.getNumInUse());
+		});
+	const bool bPortOk = checkPort(2000);
+	size_t exhaustionFailed = 0;
+	const bool bExhaustionOk = checkExhaustion(numConsumers, exhaustionFailed);
+
+	const bool bOk = modes[0].badFrames == 0 && modes[1].badFrames == 0 && pool.getNumInUse() == 0 && bPortOk && bExhaustionOk;
+	std::ostringstream out;
+	out << "{\n  \"benchmark\": \"buffer_pool\",\n  \"frames\": " << numFrames
+		<< ",\n  \"consumers\": " << numConsumers
+		<< ",\n  \"pool_bytes\": " << pool.getMemorySize()
+		<< ",\n  \"modes\": [";
+	const char * separator = "\n";
+	for (auto & mode : modes) {
+		out << separator << "    { \"mode\": \"" << mode.name
+			<< "\", \"frames_per_s\": " << double(numFrames) / mode.seconds
+			<< ", \"allocations_per_frame\": " << double(mode.allocations) / double(numFrames)
+			<< ", \"bad_frames\": " << mode.badFrames;
+		if (&mode == &modes[1]) out << ", \"peak_in_use\": " << mode.peakInUse << ", \"exhausted_retries\": " << numRetries;
+		out << " }";
+		separator = ",\n";
+	}
+	out << "\n  ],\n  \"port_check\": " << (bPortOk ? "true" : "false")
+		<< ",\n  \"consumer_caches_check\": " << (bExhaustionOk ? "true" : "false")
+		<< ",\n  \"consumer_caches_failed_acquires\": " << exhaustionFailed
+		<< ",\n  \"ok\": " << (bOk ? "true" : "false") << "\n}\n";
+	std::cout << out.str();
+	if (!outPath.empty()) std::ofstream(outPath) << out.str();
+	return bOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
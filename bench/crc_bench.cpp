@@ -0,0 +1,148 @@
+// This is a benchmark of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialCrc.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+// Throughput of the CRC kernels in GB/s against the bitwise loops they
+// replace, on frame sized and bulk buffers. Before measuring, checks the
+// standard check values and that feeding random chunks gives the same CRC
+// as one call.
+//
+// Usage: serial_bench_crc [--mb N] [--out FILE]
+
+using Clock = std::chrono::steady_clock;
+
+//----------------------------------------------------------------
+static uint16_t bitwiseModbus(uint16_t crc, const uint8_t * data, size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		crc ^= data[i];
+		for (int bit = 0; bit < 8; bit++) crc = (crc & 1) ? uint16_t((crc >> 1) ^ 0xA001) : uint16_t(crc >> 1);
+	}
+	return crc;
+}
+
+//----------------------------------------------------------------
+static uint16_t bitwiseCcitt(uint16_t crc, const uint8_t * data, size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		crc ^= uint16_t(data[i] << 8);
+		for (int bit = 0; bit < 8; bit++) crc = (crc & 0x8000) ? uint16_t((crc << 1) ^ 0x1021) : uint16_t(crc << 1);
+	}
+	return crc;
+}
+
+//----------------------------------------------------------------
+static uint32_t bitwiseCrc32(uint32_t reg, const uint8_t * data, size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		reg ^= data[i];
+		for (int bit = 0; bit < 8; bit++) reg = (reg & 1) ? (reg >> 1) ^ 0xEDB88320 : reg >> 1;
+	}
+	return reg;
+}
+
+//----------------------------------------------------------------
+template<typename Kernel>
+static double measure(Kernel kernel, const std::vector<uint8_t> & data, size_t blockSize, size_t totalBytes) {
+	const size_t numBlocks = std::max<size_t>(totalBytes / blockSize, 1);
+	uint32_t sink = 0;
+	const auto begin = Clock::now();
+	for (size_t i = 0; i < numBlocks; i++) {
+		const size_t offset = (i * blockSize) % (data.size() - blockSize + 1);
+		sink ^= uint32_t(kernel(data.data() + offset, blockSize));
+	}
+	const double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+	// keeps the loop from being optimized away
+	volatile uint32_t result = sink;
+	(void)result;
+	return double(numBlocks * blockSize) / seconds / 1e9;
+}
+
+//----------------------------------------------------------------
+static bool verify(const std::vector<uint8_t> & data) {
+	const uint8_t * check = reinterpret_cast<const uint8_t *>("123456789");
+	bool bOk = ofSerialCrc16Modbus::compute({ check, 9 }) == 0x4B37
+		&& ofSerialCrc16Ccitt::compute({ check, 9 }) == 0x29B1
+		&& ofSerialCrc16Ccitt::compute({ check, 9 }, 0) == 0x31C3
+		&& ofSerialCrc32::compute({ check, 9 }) == 0xCBF43926;
+
+	std::mt19937 rng(7);
+	for (size_t round = 0; round < 2000 && bOk; round++) {
+		const size_t length = rng() % 4096;
+		const size_t start = rng() % 64;
+		const uint8_t * p = data.data() + start;
+		ofSerialCrc16Modbus modbus;
+		ofSerialCrc16Ccitt ccitt;
+		ofSerialCrc32 crc32;
+		for (size_t done = 0; done < length;) {
+			const size_t chunk = std::min<size_t>(length - done, rng() % 300);
+			modbus.update(p + done, chunk);
+			ccitt.update(p + done, chunk);
+			crc32.update(p + done, chunk);
+			done += chunk;
+		}
+		bOk = modbus.get() == bitwiseModbus(0xFFFF, p, length)
+			&& ccitt.get() == bitwiseCcitt(0xFFFF, p, length)
+			&& crc32.get() == ~bitwiseCrc32(0xFFFFFFFF, p, length)
+			&& ofSerialCrc32::updateRegisterPortable(0xFFFFFFFF, p, length) == bitwiseCrc32(0xFFFFFFFF, p, length);
+
+		std::vector<uint8_t> frame(p, p + length);
+		frame.resize(length + 4);
+		crc32.write(frame.data() + length);
+		bOk = bOk && ofSerialCrc32::check(frame);
+		frame[0] ^= 1;
+		bOk = bOk && (length == 0 || !ofSerialCrc32::check(frame));
+	}
+	return bOk;
+}
+
+//----------------------------------------------------------------
+int main(int argc, char * argv[]) {
+	size_t totalBytes = size_t(256) << 20;
+	std::string outPath;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		if (option == "--mb") totalBytes = size_t(std::stoul(argv[i + 1])) << 20;
+		else if (option == "--out") outPath = argv[i + 1];
+		else {
+			std::cerr << "unknown option " << option << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::vector<uint8_t> data(size_t(4) << 20);
+	std::mt19937_64 rng(42);
+	for (auto & byte : data) byte = uint8_t(rng());
+
+	const bool bOk = verify(data);
+	if (!bOk) std::cerr << "crc mismatch" << std::endl;
+
+	const size_t blockSizes[] = { 64, 1024, 65536 };
+	std::ostringstream out;
+	out << "{\n  \"benchmark\": \"crc\",\n  \"crc32_kernel\": \"" << ofSerialCrc32::getKernelName() << "\",\n  \"gbps\": [";
+	const char * separator = "\n";
+	for (size_t blockSize : blockSizes) {
+		// the bitwise loops are far slower, a slice of the bytes is enough
+		const size_t bitwiseBytes = totalBytes / 64;
+		out << separator << "    { \"block\": " << blockSize
+			<< ", \"modbus_bitwise\": " << measure([](const uint8_t * p, size_t n) { return bitwiseModbus(0xFFFF, p, n); }, data, blockSize, bitwiseBytes)
+			<< ", \"modbus\": " << measure([](const uint8_t * p, size_t n) { return ofSerialCrc16Modbus::updateRegister(0xFFFF, p, n); }, data, blockSize, totalBytes)
+			<< ", \"ccitt_bitwise\": " << measure([](const uint8_t * p, size_t n) { return bitwiseCcitt(0xFFFF, p, n); }, data, blockSize, bitwiseBytes)
+			<< ", \"ccitt\": " << measure([](const uint8_t * p, size_t n) { return ofSerialCrc16Ccitt::updateRegister(0xFFFF, p, n); }, data, blockSize, totalBytes)
+			<< ", \"crc32_bitwise\": " << measure([](const uint8_t * p, size_t n) { return bitwiseCrc32(0xFFFFFFFF, p, n); }, data, blockSize, bitwiseBytes)
+			<< ", \"crc32_slicing8\": " << measure([](const uint8_t * p, size_t n) { return ofSerialCrc32::updateRegisterPortable(0xFFFFFFFF, p, n); }, data, blockSize, totalBytes)
+			<< ", \"crc32\": " << measure([](const uint8_t * p, size_t n) { return ofSerialCrc32::updateRegister(0xFFFFFFFF, p, n); }, data, blockSize, totalBytes)
+			<< " }";
+		separator = ",\n";
+	}
+	out << "\n  ],\n  \"ok\": " << (bOk ? "true" : "false") << "\n}\n";
+	std::cout << out.str();
+	if (!outPath.empty()) std::ofstream(outPath) << out.str();
+	return bOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,350 @@
+// This is a benchmark of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerial.h"
+#include "ofSerialFraming.h"
+#include "ofSerialTransport.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <poll.h>
+#include <pty.h>
+#include <unistd.h>
+
+// Checks the COBS, SLIP and length-prefix codecs, then measures the frames
+// per second each one decodes from a pseudo terminal through ofSerialPort.
+//
+// Round trips, for each codec: an empty frame, a frame made of delimiter
+// (and escape) bytes only, a frame of the maximum length and one byte above
+// it, fed whole, byte by byte and in odd chunks. A truncated frame must not
+// be emitted, and the decoder must decode the next frame after reset().
+//
+// ofSerial::setMaxFrameLength() is checked on a pseudo terminal: lines and
+// frames longer than the limit, with or without a delimiter in sight, are
+// dropped up to their delimiter and counted, the next ones come through.
+//
+// Usage: serial_bench_framing [--codecs cobs,slip,length] [--frames N]
+//                             [--frame FRAME_SIZE] [--out FILE]
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr size_t maxFrameLength = 1024;
+
+struct Codec {
+	std::string name;
+	std::function<std::unique_ptr<ofSerialFrameDecoder>()> makeDecoder;
+	std::function<size_t(std::span<const uint8_t> payload, std::span<uint8_t> out)> encode;
+	size_t maxEncodedLength = 0;
+	bool bEmitsEmptyFrames = true;  ///< \brief SLIP skips empty frames, they look like idle delimiters.
+};
+
+struct CodecResult {
+	std::string codec;
+	size_t checks = 0;
+	size_t failures = 0;
+	size_t frames = 0;
+	size_t wireBytes = 0;
+	double seconds = 0;
+	bool bStreamOk = false;
+};
+
+//----------------------------------------------------------------
+static std::vector<std::string> splitList(const std::string & list) {
+	std::vector<std::string> items;
+	std::stringstream stream(list);
+	std::string item;
+	while (std::getline(stream, item, ',')) {
+		if (!item.empty()) items.push_back(item);
+	}
+	return items;
+}
+
+//----------------------------------------------------------------
+static std::vector<Codec> makeCodecs() {
+	static ofSerialLengthPrefixEncoder lengthEncoder(maxFrameLength, 2, true);
+	std::vector<Codec> codecs(3);
+	codecs[0].name = "cobs";
+	codecs[0].makeDecoder = []() { return std::make_unique<ofSerialCobsDecoder>(maxFrameLength); };
+	codecs[0].encode = ofSerialCobsEncoder::encode;
+	codecs[0].maxEncodedLength = ofSerialCobsEncoder::getMaxEncodedLength(maxFrameLength + 1);
+	codecs[1].name = "slip";
+	codecs[1].makeDecoder = []() { return std::make_unique<ofSerialSlipDecoder>(maxFrameLength); };
+	codecs[1].encode = ofSerialSlipEncoder::encode;
+	codecs[1].maxEncodedLength = ofSerialSlipEncoder::getMaxEncodedLength(maxFrameLength + 1);
+	codecs[1].bEmitsEmptyFrames = false;
+	codecs[2].name = "length";
+	codecs[2].makeDecoder = []() { return std::make_unique<ofSerialLengthPrefixDecoder>(maxFrameLength, 2, true); };
+	codecs[2].encode = [](std::span<const uint8_t> payload, std::span<uint8_t> out) { return lengthEncoder.encode(payload, out); };
+	codecs[2].maxEncodedLength = lengthEncoder.getMaxEncodedLength(maxFrameLength + 1);
+	return codecs;
+}
+
+//----------------------------------------------------------------
+// Feeds 'wire' in chunks of 'chunk' bytes (0 for all at once) and collects the frames.
+static std::vector<std::vector<uint8_t>> decodeAll(ofSerialFrameDecoder & decoder, const std::vector<uint8_t> & wire, size_t chunk) {
+	std::vector<std::vector<uint8_t>> frames;
+	const size_t step = chunk > 0 ? chunk : std::max<size_t>(wire.size(), 1);
+	for (size_t offset = 0; offset < wire.size(); offset += step) {
+		decoder.feed(wire.data() + offset, std::min(step, wire.size() - offset), [&](std::span<const uint8_t> frame) {
+			frames.emplace_back(frame.begin(), frame.end());
+		});
+	}
+	return frames;
+}
+
+//----------------------------------------------------------------
+static std::vector<uint8_t> encode(const Codec & codec, const std::vector<uint8_t> & payload) {
+	std::vector<uint8_t> wire(codec.maxEncodedLength);
+	wire.resize(codec.encode(payload, wire));
+	return wire;
+}
+
+//----------------------------------------------------------------
+static void check(CodecResult & result, bool bPassed, const std::string & what) {
+	result.checks++;
+	if (!bPassed) {
+		result.failures++;
+		std::cerr << result.codec << ": " << what << " failed" << std::endl;
+	}
+}
+
+//----------------------------------------------------------------
+static void checkRoundTrips(const Codec & codec, CodecResult & result) {
+	std::vector<uint8_t> maxFrame(maxFrameLength);
+	for (size_t k = 0; k < maxFrame.size(); k++) maxFrame[k] = uint8_t(k * 7);
+	const std::vector<std::pair<std::string, std::vector<uint8_t>>> payloads = {
+		{ "empty frame", {} },
+		{ "zeros frame", std::vector<uint8_t>(600, 0x00) },
+		{ "slip specials frame", std::vector<uint8_t>(300, 0xC0) },
+		{ "slip escapes frame", std::vector<uint8_t>(300, 0xDB) },
+		{ "254 bytes frame", std::vector<uint8_t>(254, 0x55) },
+		{ "max length frame", maxFrame },
+	};
+	const size_t chunks[] = { 0, 1, 3, 255 };
+
+	for (auto & [what, payload] : payloads) {
+		// the frame twice in a row, so that the second one checks the state left by the first
+		const std::vector<uint8_t> encoded = encode(codec, payload);
+		std::vector<uint8_t> wire = encoded;
+		wire.insert(wire.end(), encoded.begin(), encoded.end());
+		for (size_t chunk : chunks) {
+			auto decoder = codec.makeDecoder();
+			const auto frames = decodeAll(*decoder, wire, chunk);
+			const size_t expected = payload.empty() && !codec.bEmitsEmptyFrames ? 0 : 2;
+			bool bPassed = !encoded.empty() && frames.size() == expected && decoder->getErrorCount() == 0;
+			for (auto & frame : frames) bPassed = bPassed && frame == payload;
+			check(result, bPassed, what + " in chunks of " + std::to_string(chunk));
+		}
+	}
+
+	// one byte above the limit is dropped, the next frame still decodes
+	std::vector<uint8_t> tooLong(maxFrameLength + 1, 0x33);
+	std::vector<uint8_t> wire = encode(codec, tooLong);
+	const std::vector<uint8_t> next = encode(codec, maxFrame);
+	wire.insert(wire.end(), next.begin(), next.end());
+	for (size_t chunk : chunks) {
+		auto decoder = codec.makeDecoder();
+		const auto frames = decodeAll(*decoder, wire, chunk);
+		check(result, frames.size() == 1 && frames[0] == maxFrame && decoder->getErrorCount() == 1, "oversized frame in chunks of " + std::to_string(chunk));
+	}
+
+	// a frame cut short emits nothing, reset() starts over
+	for (auto & [what, payload] : payloads) {
+		std::vector<uint8_t> truncated = encode(codec, payload);
+		truncated.pop_back();
+		auto decoder = codec.makeDecoder();
+		bool bPassed = decodeAll(*decoder, truncated, 0).empty() && decoder->getErrorCount() == 0;
+		decoder->reset();
+		const auto frames = decodeAll(*decoder, encode(codec, maxFrame), 0);
+		bPassed = bPassed && frames.size() == 1 && frames[0] == maxFrame;
+		check(result, bPassed, "truncated " + what);
+	}
+}
+
+//----------------------------------------------------------------
+// Frame i carries i in its first 8 bytes, the rest covers every byte value, delimiters included.
+static void fillFrame(std::vector<uint8_t> & payload, uint64_t index) {
+	memcpy(payload.data(), &index, sizeof(index));
+	for (size_t k = sizeof(index); k < payload.size(); k++) {
+		payload[k] = uint8_t(index * 31 + k);
+	}
+}
+
+//----------------------------------------------------------------
+static bool writeAllFd(int fd, const uint8_t * data, size_t length) {
+	while (length > 0) {
+		auto n = write(fd, data, length);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			if (errno != EAGAIN) return false;
+			struct pollfd pfd = { fd, POLLOUT, 0 };
+			if (::poll(&pfd, 1, 2000) <= 0) return false;
+			continue;
+		}
+		data += n;
+		length -= size_t(n);
+	}
+	return true;
+}
+
+//----------------------------------------------------------------
+// A fake device streams 'numFrames' encoded frames on a pseudo terminal, the port decodes and checks them.
+static void runStream(const Codec & codec, size_t numFrames, size_t frameSize, CodecResult & result) {
+	ofSerialPort<ofSerialPtyTransport> port;
+	if (!port.getTransport().setup()) return;
+	const int peer = port.getTransport().getPeerFileDescriptor();
+
+	std::thread device([&]() {
+		std::vector<uint8_t> payload(frameSize);
+		std::vector<uint8_t> encoded(codec.maxEncodedLength * 64);
+		size_t used = 0;
+		for (size_t i = 0; i < numFrames; i++) {
+			fillFrame(payload, i);
+			used += codec.encode(payload, std::span<uint8_t>(encoded.data() + used, encoded.size() - used));
+			if (encoded.size() - used < codec.maxEncodedLength || i + 1 == numFrames) {
+				if (!writeAllFd(peer, encoded.data(), used)) return;
+				result.wireBytes += used;
+				used = 0;
+			}
+		}
+	});
+
+	auto decoder = codec.makeDecoder();
+	std::vector<uint8_t> expected(frameSize);
+	bool bOk = true;
+	const auto begin = Clock::now();
+	while (result.frames < numFrames && bOk) {
+		port.readFrames(*decoder, [&](std::span<const uint8_t> frame) {
+			fillFrame(expected, result.frames);
+			if (frame.size() != frameSize || memcmp(frame.data(), expected.data(), frameSize) != 0) {
+				bOk = false;
+			}
+			result.frames++;
+		});
+		if (result.frames < numFrames && !port.waitReadable(2000)) {
+			std::cerr << codec.name << ": timeout after " << result.frames << " frames" << std::endl;
+			bOk = false;
+		}
+	}
+	result.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+	port.close();
+	device.join();
+	result.bStreamOk = bOk && result.frames == numFrames && decoder->getErrorCount() == 0;
+}
+
+//----------------------------------------------------------------
+// Oversized lines and delimiter-less floods through readStringUntil(), tryReadStringUntil() and readFrames(scanner).
+static bool checkMaxFrameLength(uint64_t & oversized) {
+	int master = -1, slave = -1;
+	char slaveName[256];
+	if (openpty(&master, &slave, slaveName, nullptr, nullptr) != 0) return false;
+	struct termios options;
+	tcgetattr(master, &options);
+	cfmakeraw(&options);
+	tcsetattr(master, TCSANOW, &options);
+	close(slave);
+	ofSerial port;
+	if (!port.setup(std::string_view(slaveName), 115200)) return false;
+	port.setMaxFrameLength(100);
+
+	// each reader meets a flood with no delimiter, the first and the last also a line longer than the limit in one piece
+	const std::string flood(20000, 'x');
+	const std::string line(200, 'y');
+	const std::string wire = flood + "\n" + line + "\nfirst\n" + flood + "\nsecond\n" + flood + "\n" + line + "\nthird\n";
+	std::thread device([&]() {
+		writeAllFd(master, reinterpret_cast<const uint8_t *>(wire.data()), wire.size());
+	});
+	bool bOk = port.readStringUntil('\n', 2000) == "first";
+
+	const auto deadline = Clock::now() + std::chrono::seconds(2);
+	std::string got;
+	while (!port.tryReadStringUntil('\n', got) && Clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+	bOk = bOk && got == "second";
+
+	ofSerialScanner newline({ '\n' });
+	std::vector<std::string> frames;
+	while (frames.empty() && Clock::now() < deadline) {
+		port.readFrames(newline, [&](const uint8_t * frame, size_t length, uint8_t) {
+			frames.emplace_back(reinterpret_cast<const char *>(frame), length);
+		});
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+	bOk = bOk && frames.size() == 1 && frames[0] == "third";
+	device.join();
+
+	oversized = port.getMetrics().bytesOversized;
+	port.close();
+	close(master);
+#if OF_SERIAL_METRICS
+	bOk = bOk && oversized == 3 * flood.size() + 2 * line.size();
+#endif
+	return bOk;
+}
+
+//----------------------------------------------------------------
+int main(int argc, char * argv[]) {
+	std::vector<std::string> names = { "cobs", "slip", "length" };
+	size_t numFrames = 200000;
+	size_t frameSize = 256;
+	std::string outPath;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		if (option == "--codecs") names = splitList(argv[i + 1]);
+		else if (option == "--frames") numFrames = size_t(std::stoul(argv[i + 1]));
+		else if (option == "--frame") frameSize = std::min<size_t>(std::max<size_t>(size_t(std::stoul(argv[i + 1])), 8), maxFrameLength);
+		else if (option == "--out") outPath = argv[i + 1];
+		else {
+			std::cerr << "unknown option " << option << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const auto codecs = makeCodecs();
+	std::vector<CodecResult> results;
+	for (auto & name : names) {
+		auto codec = std::find_if(codecs.begin(), codecs.end(), [&](const Codec & c) { return c.name == name; });
+		if (codec == codecs.end()) {
+			std::cerr << "unknown codec " << name << std::endl;
+			return EXIT_FAILURE;
+		}
+		CodecResult result;
+		result.codec = name;
+		checkRoundTrips(*codec, result);
+		runStream(*codec, numFrames, frameSize, result);
+		results.push_back(result);
+	}
+
+	uint64_t oversized = 0;
+	const bool bMaxFrameOk = checkMaxFrameLength(oversized);
+
+	bool bOk = bMaxFrameOk;
+	std::ostringstream out;
+	out << "{\n  \"benchmark\": \"framing\",\n  \"transport\": \"pty\",\n  \"frame_size\": " << frameSize
+		<< ",\n  \"max_frame_length_check\": " << (bMaxFrameOk ? "true" : "false")
+		<< ",\n  \"oversized_bytes_dropped\": " << oversized << ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const auto & result = results[i];
+		const bool bCodecOk = result.failures == 0 && result.bStreamOk;
+		bOk = bOk && bCodecOk;
+		out << "    { \"codec\": \"" << result.codec << "\""
+			<< ", \"round_trip_checks\": " << result.checks
+			<< ", \"round_trip_failures\": " << result.failures
+			<< ", \"frames\": " << result.frames
+			<< ", \"frames_per_s\": " << (result.seconds > 0 ? double(result.frames) / result.seconds : 0)
+			<< ", \"wire_mb_s\": " << (result.seconds > 0 ? double(result.wireBytes) / result.seconds / 1e6 : 0)
+			<< ", \"ok\": " << (bCodecOk ? "true" : "false") << " }"
+			<< (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	out << "  ]\n}\n";
+	std::cout << out.str();
+	if (!outPath.empty()) std::ofstream(outPath) << out.str();
+	return bOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,162 @@
+// This is a benchmark of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerial.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <poll.h>
+#include <pty.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+// Latency and CPU cost of the I/O profiles on a pseudo terminal. Ptys ignore
+// ASYNC_LOW_LATENCY, so only the VMIN/VTIME and frame gap effects show here.
+// Prints one JSON object per profile.
+
+using Clock = std::chrono::steady_clock;
+
+static double threadCpuMs() {
+	struct rusage l_usage;
+	getrusage(RUSAGE_THREAD, &l_usage);
+	return (double)l_usage.ru_utime.tv_sec * 1e3 + (double)l_usage.ru_utime.tv_usec / 1e3
+		+ (double)l_usage.ru_stime.tv_sec * 1e3 + (double)l_usage.ru_stime.tv_usec / 1e3;
+}
+
+static double percentile(std::vector<double>& values, double p) {
+	if (values.empty()) return 0;
+	std::sort(values.begin(), values.end());
+	return values[std::min(values.size() - 1, size_t(p * double(values.size())))];
+}
+
+static bool writeAll(int fd, const uint8_t* data, size_t length) {
+	while (length > 0) {
+		auto n = write(fd, data, length);
+		if (n < 0) {
+			if (errno == EAGAIN || errno == EINTR) continue;
+			return false;
+		}
+		data += n;
+		length -= size_t(n);
+	}
+	return true;
+}
+
+// A device sends a 32 bytes line every 2 ms, the latency is measured from the
+// write() on the device side to the return of readStringUntil().
+static void benchLatency(ofSerial& serial, int master, size_t messages, double& p50, double& p99, double& cpuPerMessage) {
+	std::vector<Clock::time_point> l_sent(messages);
+	std::atomic<size_t> l_published(0);
+	std::thread l_device([&]() {
+		std::string l_line(31, 'x');
+		l_line += '\n';
+		for (size_t i = 0; i < messages; i++) {
+			l_sent[i] = Clock::now();
+			l_published = i + 1;
+			writeAll(master, reinterpret_cast<const uint8_t*>(l_line.data()), l_line.size());
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+	});
+
+	std::vector<double> l_latencies;
+	const double l_cpuBegin = threadCpuMs();
+	for (size_t i = 0; i < messages; i++) {
+		const std::string l_line = serial.readStringUntil('\n', 50);
+		const auto l_now = Clock::now();
+		if (l_line.size() != 31 || l_published <= i) continue;
+		l_latencies.push_back(std::chrono::duration<double, std::micro>(l_now - l_sent[i]).count());
+	}
+	cpuPerMessage = (threadCpuMs() - l_cpuBegin) * 1e3 / double(messages);
+	l_device.join();
+
+	p50 = percentile(l_latencies, 0.50);
+	p99 = percentile(l_latencies, 0.99);
+}
+
+// The device streams 'total' bytes as fast as it can, the reader waits on the
+// file descriptor and reads what is there.
+static void benchThroughput(ofSerial& serial, int master, size_t total, double& mbPerSecond, double& bytesPerWakeup, double& cpuMs) {
+	std::thread l_device([&]() {
+		std::vector<uint8_t> l_chunk(4096, 'y');
+		for (size_t l_sent = 0; l_sent < total; l_sent += l_chunk.size()) {
+			writeAll(master, l_chunk.data(), std::min(l_chunk.size(), total - l_sent));
+		}
+	});
+
+	std::vector<uint8_t> l_buffer(65536);
+	size_t l_received = 0;
+	size_t l_wakeups = 0;
+	const double l_cpuBegin = threadCpuMs();
+	const auto l_begin = Clock::now();
+	while (l_received < total) {
+		// a bulk profile does not report the tail, read it on timeout
+		struct pollfd l_pfd = { serial.getFileDescriptor(), POLLIN, 0 };
+		::poll(&l_pfd, 1, 10);
+		l_wakeups++;
+		l_received += serial.readBytes(l_buffer.data(), l_buffer.size());
+	}
+	const double l_seconds = std::chrono::duration<double>(Clock::now() - l_begin).count();
+	cpuMs = threadCpuMs() - l_cpuBegin;
+	l_device.join();
+
+	mbPerSecond = double(total) / l_seconds / 1e6;
+	bytesPerWakeup = double(l_received) / double(l_wakeups);
+}
+
+int main(int argc, char* argv[]) {
+
+	const size_t l_messages = argc > 1 ? size_t(atoi(argv[1])) : 200;
+	const size_t l_bytes = argc > 2 ? size_t(atoi(argv[2])) : 8 << 20;
+
+	const ofSerialProfile l_profiles[] = {
+		ofSerialProfile::lowLatency(),
+		ofSerialProfile::bulk(16),
+		ofSerialProfile::bulk(),
+		ofSerialProfile::frameGap(std::chrono::microseconds(1000)),
+	};
+
+	for (auto& l_profile : l_profiles) {
+		int l_master = -1;
+		int l_slave = -1;
+		char l_name[256];
+		if (openpty(&l_master, &l_slave, l_name, nullptr, nullptr) != 0) {
+			std::cerr << "openpty failed: " << strerror(errno) << std::endl;
+			return EXIT_FAILURE;
+		}
+		// the master side must not mangle the test bytes either
+		struct termios l_raw;
+		tcgetattr(l_master, &l_raw);
+		cfmakeraw(&l_raw);
+		tcsetattr(l_master, TCSANOW, &l_raw);
+
+		ofSerial l_serial;
+		if (!l_serial.setup(std::string_view(l_name), 115200, 8, OF_SERIAL_PARITY_N, 1, l_profile)) {
+			std::cerr << "NOT CONNECTED " << l_name << std::endl;
+			return EXIT_FAILURE;
+		}
+		::close(l_slave);
+
+		double l_p50, l_p99, l_cpuPerMessage, l_mbPerSecond, l_bytesPerWakeup, l_cpuMs;
+		benchLatency(l_serial, l_master, l_messages, l_p50, l_p99, l_cpuPerMessage);
+		benchThroughput(l_serial, l_master, l_bytes, l_mbPerSecond, l_bytesPerWakeup, l_cpuMs);
+
+		std::cout << "{\"profile\": \"" << l_profile.getName() << "\""
+			<< ", \"vmin\": " << int(l_profile.minBytes)
+			<< ", \"frame_gap_us\": " << l_profile.frameGapUs
+			<< ", \"latency_p50_us\": " << l_p50
+			<< ", \"latency_p99_us\": " << l_p99
+			<< ", \"cpu_us_per_message\": " << l_cpuPerMessage
+			<< ", \"throughput_mb_s\": " << l_mbPerSecond
+			<< ", \"bytes_per_wakeup\": " << l_bytesPerWakeup
+			<< ", \"throughput_cpu_ms\": " << l_cpuMs
+			<< "}" << std::endl;
+
+		l_serial.close();
+		::close(l_master);
+	}
+	return EXIT_SUCCESS;
+}
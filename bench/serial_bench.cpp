@@ -0,0 +1,346 @@
+// This is a benchmark of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerial.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <poll.h>
+#include <pty.h>
+#include <unistd.h>
+
+// Throughput and per call latency of the ofSerial API on pseudo terminal
+// pairs, so that a change can be judged on a box without serial hardware.
+//
+// Usage: serial_bench [--ops readByte,readBytes,...] [--modes fd,ring]
+//                     [--sizes 1,64,1024] [--ports 1,4] [--threads 1,2]
+//                     [--bytes BYTES_PER_PORT] [--out FILE]
+//
+// Every combination of operation, read mode, message size, port count and
+// thread count is run once, the results are written as JSON.
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+	std::string op;
+	std::string mode;  // "fd": reads hit the device, "ring": startReaderThread()
+	size_t messageSize;
+	size_t numPorts;
+	size_t numThreads;
+	size_t bytesPerPort;
+};
+
+struct BenchResult {
+	size_t calls = 0;  // calls that moved data, or found some queued for available()
+	size_t emptyCalls = 0;  // calls that found nothing to read
+	size_t bytes = 0;
+	double seconds = 0;
+	std::vector<uint64_t> latencies;  // nanoseconds, one per counted call
+	bool bOk = true;
+};
+
+struct PtyPort {
+	int master = -1;
+	std::unique_ptr<ofSerial> serial;
+	size_t remaining = 0;
+};
+
+static const char * allOps[] = { "readByte", "readBytes", "readBytesVector", "readStringUntil", "writeBytes", "available" };
+
+//----------------------------------------------------------------
+static std::vector<std::string> splitList(const std::string & list) {
+	std::vector<std::string> items;
+	std::stringstream stream(list);
+	std::string item;
+	while(std::getline(stream, item, ',')) {
+		if(!item.empty()) items.push_back(item);
+	}
+	return items;
+}
+
+static std::vector<size_t> splitSizes(const std::string & list) {
+	std::vector<size_t> sizes;
+	for(auto & item : splitList(list)) {
+		sizes.push_back(size_t(std::stoul(item)));
+	}
+	return sizes;
+}
+
+//----------------------------------------------------------------
+static bool writeAll(int fd, const uint8_t * data, size_t length) {
+	while(length > 0) {
+		auto n = write(fd, data, length);
+		if(n < 0) {
+			if(errno == EAGAIN || errno == EINTR) continue;
+			return false;
+		}
+		data += n;
+		length -= size_t(n);
+	}
+	return true;
+}
+
+//----------------------------------------------------------------
+static bool openPorts(const BenchConfig & config, std::vector<PtyPort> & ports) {
+	for(size_t i = 0; i < config.numPorts; i++) {
+		PtyPort port;
+		int slave = -1;
+		char name[256];
+		if(openpty(&port.master, &slave, name, nullptr, nullptr) != 0) {
+			std::cerr << "openpty failed: " << strerror(errno) << std::endl;
+			return false;
+		}
+		struct termios raw;
+		tcgetattr(port.master, &raw);
+		cfmakeraw(&raw);
+		tcsetattr(port.master, TCSANOW, &raw);
+
+		port.serial = std::make_unique<ofSerial>();
+		if(!port.serial->setup(std::string_view(name), 115200)) {
+			::close(port.master);
+			::close(slave);
+			return false;
+		}
+		::close(slave);
+		if(config.mode == "ring" && !port.serial->startReaderThread(1 << 20)) {
+			return false;
+		}
+		port.remaining = config.bytesPerPort;
+		ports.push_back(std::move(port));
+	}
+	return true;
+}
+
+//----------------------------------------------------------------
+// Lets the feeders run when a call found nothing, the box may have one CPU.
+static void waitForData(const BenchConfig & config, ofSerial & serial) {
+	if(config.mode == "fd") {
+		struct pollfd pfd = { serial.getFileDescriptor(), POLLIN, 0 };
+		::poll(&pfd, 1, 1);
+	} else {
+		std::this_thread::yield();
+	}
+}
+
+//----------------------------------------------------------------
+// One call of the measured operation on one port.
+// Returns false when the call found nothing to do.
+static bool step(const BenchConfig & config, PtyPort & port, std::vector<uint8_t> & buffer, BenchResult & result) {
+	ofSerial & serial = *port.serial;
+	const auto begin = Clock::now();
+	size_t moved = 0;
+	bool bProductive = true;
+
+	if(config.op == "readByte") {
+		const int byte = serial.readByte();
+		bProductive = byte >= 0;
+		moved = bProductive ? 1 : 0;
+	} else if(config.op == "readBytes") {
+		moved = serial.readBytes(buffer.data(), std::min(config.messageSize, port.remaining));
+		bProductive = moved > 0;
+	} else if(config.op == "readBytesVector") {
+		moved = serial.readBytes().size();
+		bProductive = moved > 0;
+	} else if(config.op == "readStringUntil") {
+		const std::string line = serial.readStringUntil('\n', 1000);
+		moved = line.size() + 1;
+		bProductive = !line.empty() || config.messageSize == 1;
+	} else if(config.op == "writeBytes") {
+		moved = serial.writeBytes(buffer.data(), std::min(config.messageSize, port.remaining));
+		bProductive = moved > 0;
+	} else if(config.op == "available") {
+		// a call that found nothing queued measures the ioctl alone
+		bProductive = serial.available() > 0;
+	}
+
+	const auto end = Clock::now();
+	if(config.op == "available" && bProductive) {
+		// drain outside of the measured call, the feeder has to make progress
+		moved = serial.readBytes(buffer.data(), std::min(buffer.size(), port.remaining));
+	}
+	if(!bProductive) {
+		result.emptyCalls++;
+		return false;
+	}
+	result.calls++;
+	result.bytes += moved;
+	result.latencies.push_back(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()));
+	port.remaining -= std::min(moved, port.remaining);
+	return true;
+}
+
+//----------------------------------------------------------------
+static BenchResult runBench(const BenchConfig & config) {
+	BenchResult result;
+	std::vector<PtyPort> ports;
+	if(!openPorts(config, ports)) {
+		result.bOk = false;
+		for(auto & port : ports) ::close(port.master);
+		return result;
+	}
+
+	// the device side: feeders for the reads, sinks for the writes
+	const bool bWrite = config.op == "writeBytes";
+	std::atomic<bool> bGo(false);
+	std::vector<std::thread> devices;
+	for(auto & port : ports) {
+		devices.emplace_back([&config, &bGo, bWrite, master = port.master]() {
+			while(!bGo) std::this_thread::yield();
+			std::vector<uint8_t> message(std::max<size_t>(config.messageSize, 1), 'x');
+			if(config.op == "readStringUntil") message.back() = '\n';
+			size_t done = 0;
+			while(done < config.bytesPerPort) {
+				if(bWrite) {
+					uint8_t sink[65536];
+					auto n = read(master, sink, sizeof(sink));
+					if(n <= 0 && errno != EAGAIN && errno != EINTR) return;
+					done += n > 0 ? size_t(n) : 0;
+				} else {
+					const size_t length = std::min(message.size(), config.bytesPerPort - done);
+					if(!writeAll(master, message.data(), length)) return;
+					done += length;
+				}
+			}
+		});
+	}
+
+	// the application side, every thread owns ports i % numThreads
+	std::vector<BenchResult> threadResults(config.numThreads);
+	std::vector<std::thread> consumers;
+	for(size_t t = 0; t < config.numThreads; t++) {
+		consumers.emplace_back([&, t]() {
+			BenchResult & local = threadResults[t];
+			std::vector<uint8_t> buffer(std::max<size_t>(config.messageSize, 65536), 'w');
+			while(!bGo) std::this_thread::yield();
+			bool bBusy = true;
+			while(bBusy) {
+				bBusy = false;
+				bool bProgress = false;
+				for(size_t i = t; i < ports.size(); i += config.numThreads) {
+					if(ports[i].remaining == 0) continue;
+					bBusy = true;
+					if(step(config, ports[i], buffer, local)) {
+						bProgress = true;
+					} else if(config.numPorts == config.numThreads) {
+						waitForData(config, *ports[i].serial);
+					}
+				}
+				if(bBusy && !bProgress && config.numPorts != config.numThreads) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	const auto begin = Clock::now();
+	bGo = true;
+	for(auto & consumer : consumers) consumer.join();
+	result.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+	for(auto & device : devices) device.join();
+	for(auto & port : ports) {
+		port.serial->close();
+		::close(port.master);
+	}
+
+	for(auto & local : threadResults) {
+		result.calls += local.calls;
+		result.emptyCalls += local.emptyCalls;
+		result.bytes += local.bytes;
+		result.latencies.insert(result.latencies.end(), local.latencies.begin(), local.latencies.end());
+	}
+	return result;
+}
+
+//----------------------------------------------------------------
+static uint64_t percentile(const std::vector<uint64_t> & sorted, double p) {
+	if(sorted.empty()) return 0;
+	return sorted[std::min(sorted.size() - 1, size_t(p * double(sorted.size())))];
+}
+
+static void writeJson(std::ostream & out, const BenchConfig & config, BenchResult & result, bool bFirst) {
+	std::sort(result.latencies.begin(), result.latencies.end());
+	out << (bFirst ? "" : ",\n") << "    {"
+		<< "\"op\": \"" << config.op << "\", "
+		<< "\"mode\": \"" << config.mode << "\", "
+		<< "\"message_size\": " << config.messageSize << ", "
+		<< "\"ports\": " << config.numPorts << ", "
+		<< "\"threads\": " << config.numThreads << ", "
+		<< "\"ok\": " << (result.bOk ? "true" : "false") << ", "
+		<< "\"calls\": " << result.calls << ", "
+		<< "\"empty_calls\": " << result.emptyCalls << ", "
+		<< "\"bytes\": " << result.bytes << ", "
+		<< "\"seconds\": " << result.seconds << ", "
+		<< "\"throughput_mb_s\": " << (result.seconds > 0 ? double(result.bytes) / result.seconds / 1e6 : 0) << ", "
+		<< "\"calls_per_s\": " << (result.seconds > 0 ? double(result.calls) / result.seconds : 0) << ", "
+		<< "\"latency_ns\": {"
+		<< "\"p50\": " << percentile(result.latencies, 0.5) << ", "
+		<< "\"p99\": " << percentile(result.latencies, 0.99) << ", "
+		<< "\"p999\": " << percentile(result.latencies, 0.999) << ", "
+		<< "\"max\": " << (result.latencies.empty() ? 0 : result.latencies.back())
+		<< "}}";
+}
+
+//----------------------------------------------------------------
+int main(int argc, char * argv[]) {
+	std::vector<std::string> ops(std::begin(allOps), std::end(allOps));
+	std::vector<std::string> modes = { "fd", "ring" };
+	std::vector<size_t> sizes = { 1, 64, 1024 };
+	std::vector<size_t> portCounts = { 1, 4 };
+	std::vector<size_t> threadCounts = { 1, 2 };
+	size_t bytesPerPort = 256 * 1024;
+	std::string outPath;
+
+	for(int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		const std::string value = argv[i + 1];
+		if(option == "--ops") ops = splitList(value);
+		else if(option == "--modes") modes = splitList(value);
+		else if(option == "--sizes") sizes = splitSizes(value);
+		else if(option == "--ports") portCounts = splitSizes(value);
+		else if(option == "--threads") threadCounts = splitSizes(value);
+		else if(option == "--bytes") bytesPerPort = size_t(std::stoul(value));
+		else if(option == "--out") outPath = value;
+		else {
+			std::cerr << "unknown option " << option << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::ofstream file;
+	if(!outPath.empty()) file.open(outPath);
+	std::ostream & out = outPath.empty() ? std::cout : file;
+
+	out << "{\n  \"benchmark\": \"serial_bench\",\n"
+		<< "  \"scanner\": \"" << ofSerialScanner::getKernelName() << "\",\n"
+		<< "  \"bytes_per_port\": " << bytesPerPort << ",\n"
+		<< "  \"results\": [\n";
+	bool bFirst = true;
+	bool bAllOk = true;
+	for(auto & op : ops) {
+		for(auto & mode : modes) {
+			// the reader thread only changes the reads
+			if(op == "writeBytes" && mode != modes.front()) continue;
+			for(size_t size : sizes) {
+				for(size_t numPorts : portCounts) {
+					for(size_t numThreads : threadCounts) {
+						if(numThreads > numPorts || numThreads == 0) continue;
+						BenchConfig config = { op, mode, std::max<size_t>(size, 1), numPorts, numThreads, bytesPerPort };
+						BenchResult result = runBench(config);
+						bAllOk = bAllOk && result.bOk;
+						writeJson(out, config, result, bFirst);
+						bFirst = false;
+						out.flush();
+					}
+				}
+			}
+		}
+	}
+	out << "\n  ]\n}" << std::endl;
+	return bAllOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,269 @@
+// This is a stress test of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerial.h"
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <unistd.h>
+
+// Exercises the concurrency contract of ofSerial over pseudo terminals, and
+// is meant to run under ThreadSanitizer (cmake -DTSAN=ON):
+// - duplex: one thread writes coalesced lines while another reads them back
+//   from an echoing device, each side without any lock,
+// - producers: several threads push frames on the writer thread queue, the
+//   device checks that every frame arrived whole and in order per producer,
+// - close: a port is closed while a reader waits for a line, a writer is
+//   stuck on a full output buffer and a third thread keeps calling
+//   writeSome(); they must all return at once, and nothing may reach the
+//   pseudo terminal opened next, which usually reuses the descriptor number.
+//
+// Usage: serial_stress_threads [--lines N] [--frames N] [--producers N]
+//                              [--rounds N] [--out FILE]
+
+using Clock = std::chrono::steady_clock;
+
+struct Pty {
+	int master = -1;
+	std::string slaveName;
+};
+
+//----------------------------------------------------------------
+static bool openPty(Pty & pty) {
+	int slave = -1;
+	char slaveName[256];
+	if (openpty(&pty.master, &slave, slaveName, nullptr, nullptr) != 0) {
+		std::cerr << "openpty failed: " << strerror(errno) << std::endl;
+		return false;
+	}
+	struct termios options;
+	tcgetattr(pty.master, &options);
+	cfmakeraw(&options);
+	tcsetattr(pty.master, TCSANOW, &options);
+	fcntl(pty.master, F_SETFL, O_NONBLOCK);
+	pty.slaveName = slaveName;
+	close(slave);
+	return true;
+}
+
+//----------------------------------------------------------------
+static bool waitIn(int fd, int timeoutMs) {
+	struct pollfd pfd = { fd, POLLIN, 0 };
+	return ::poll(&pfd, 1, timeoutMs) > 0;
+}
+
+//----------------------------------------------------------------
+// A writer and a reader thread on the same port, the device echoes every byte.
+static bool runDuplex(size_t numLines, size_t & mismatches) {
+	Pty pty;
+	ofSerial port;
+	if (!openPty(pty) || !port.setup(std::string_view(pty.slaveName), 115200)) return false;
+	port.setWriteCoalescing(64, std::chrono::microseconds(200));
+
+	std::atomic<bool> bStop(false);
+	std::thread device([&]() {
+		uint8_t buffer[4096];
+		while (!bStop) {
+			if (!waitIn(pty.master, 10)) continue;
+			const auto n = read(pty.master, buffer, sizeof(buffer));
+			for (ssize_t done = 0; n > 0 && done < n;) {
+				const auto w = write(pty.master, buffer + done, size_t(n - done));
+				if (w > 0) done += w;
+				else if (errno == EAGAIN) std::this_thread::yield();
+				else break;
+			}
+		}
+	});
+	std::thread writer([&]() {
+		for (size_t i = 0; i < numLines; i++) {
+			port.writeBytes("L" + std::to_string(i) + "\n");
+		}
+		port.flushWrites();
+	});
+	std::thread reader([&]() {
+		for (size_t i = 0; i < numLines; i++) {
+			if (port.readStringUntil('\n', 5000) != "L" + std::to_string(i)) mismatches++;
+		}
+	});
+	writer.join();
+	reader.join();
+	bStop = true;
+	device.join();
+	port.close();
+	close(pty.master);
+	return true;
+}
+
+//----------------------------------------------------------------
+// Producers push 4 byte frames [producer, sequence low, sequence high, 0xA5] through the writer thread.
+static bool runProducers(size_t numProducers, size_t numFrames, size_t & received, size_t & misordered) {
+	Pty pty;
+	ofSerial port;
+	if (!openPty(pty) || !port.setup(std::string_view(pty.slaveName), 115200)) return false;
+	port.startWriterThread(32);
+
+	std::atomic<bool> bStop(false);
+	std::thread device([&]() {
+		std::vector<size_t> next(numProducers, 0);
+		uint8_t frame[4];
+		size_t have = 0;
+		uint8_t buffer[4096];
+		while (!bStop || waitIn(pty.master, 50)) {
+			if (!waitIn(pty.master, 10)) continue;
+			const auto n = read(pty.master, buffer, sizeof(buffer));
+			for (ssize_t i = 0; i < n; i++) {
+				frame[have++] = buffer[i];
+				if (have < 4) continue;
+				have = 0;
+				const size_t producer = frame[0];
+				const size_t sequence = size_t(frame[1]) | (size_t(frame[2]) << 8);
+				if (frame[3] != 0xA5 || producer >= numProducers || sequence != (next[producer] & 0xFFFF)) misordered++;
+				if (producer < numProducers) next[producer] = sequence + 1;
+				received++;
+			}
+		}
+	});
+	std::vector<std::thread> producers;
+	for (size_t p = 0; p < numProducers; p++) {
+		producers.emplace_back([&, p]() {
+			for (size_t i = 0; i < numFrames; i++) {
+				std::vector<uint8_t> frame = { uint8_t(p), uint8_t(i), uint8_t(i >> 8), 0xA5 };
+				if (i % 2 == 0) {
+					// blocks while the queue is full
+					port.writeBytes(frame.data(), frame.size());
+				} else {
+					while (port.writeAsync(std::vector<uint8_t>(frame)).getStatus() == ofSerialWriteStatus::Rejected) {
+						std::this_thread::yield();
+					}
+				}
+			}
+		});
+	}
+	for (auto & producer : producers) producer.join();
+	port.stopWriterThread();
+	bStop = true;
+	device.join();
+	port.close();
+	close(pty.master);
+	return true;
+}
+
+//----------------------------------------------------------------
+// Closes a port under blocked I/O, then checks that the next opening receives nothing.
+static bool runClose(size_t numRounds, double & maxCloseMs, double & maxExitMs, size_t & leaks, size_t & badEpochs) {
+	for (size_t round = 0; round < numRounds; round++) {
+		Pty pty;
+		ofSerial port;
+		if (!openPty(pty) || !port.setup(std::string_view(pty.slaveName), 115200)) return false;
+		port.setWriteTimeout(std::chrono::seconds(10));
+		const uint32_t epoch = port.getEpoch();
+
+		std::atomic<bool> bStop(false);
+		std::atomic<int64_t> lastExit(0);
+		auto stamp = [&lastExit]() {
+			const int64_t now = Clock::now().time_since_epoch().count();
+			int64_t previous = lastExit.load();
+			while (previous < now && !lastExit.compare_exchange_weak(previous, now)) {}
+		};
+		std::thread reader([&]() {
+			port.readStringUntil('\n', 10000);
+			stamp();
+		});
+		std::thread writer([&]() {
+			// nobody reads the device, the output buffer fills up and the write waits
+			const std::vector<uint8_t> chunk(4096, 'w');
+			while (port.writeBytes(chunk.data(), chunk.size()) == chunk.size()) {}
+			stamp();
+		});
+		std::thread poker([&]() {
+			const uint8_t byte = 'x';
+			while (!bStop) {
+				if (port.isInitialized()) port.writeSome(&byte, 1);
+				std::this_thread::yield();
+			}
+		});
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		const auto closing = Clock::now();
+		port.close();
+		const auto closed = Clock::now();
+		maxCloseMs = std::max(maxCloseMs, std::chrono::duration<double, std::milli>(closed - closing).count());
+		if (port.getEpoch() != epoch + 1) badEpochs++;
+
+		// the next pseudo terminal usually gets the descriptor numbers just freed
+		Pty next;
+		if (!openPty(next)) return false;
+		const int nextSlave = open(next.slaveName.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+		reader.join();
+		writer.join();
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		bStop = true;
+		poker.join();
+		maxExitMs = std::max(maxExitMs, std::chrono::duration<double, std::milli>(Clock::duration(lastExit.load()) - closing.time_since_epoch()).count());
+
+		uint8_t buffer[256];
+		if (waitIn(next.master, 0) && read(next.master, buffer, sizeof(buffer)) > 0) leaks++;
+		close(nextSlave);
+		close(next.master);
+		close(pty.master);
+	}
+	return true;
+}
+
+//----------------------------------------------------------------
+int main(int argc, char * argv[]) {
+	size_t numLines = 20000;
+	size_t numFrames = 20000;
+	size_t numProducers = 4;
+	size_t numRounds = 50;
+	std::string outPath;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		if (option == "--lines") numLines = size_t(std::stoul(argv[i + 1]));
+		else if (option == "--frames") numFrames = std::min<size_t>(size_t(std::stoul(argv[i + 1])), 65536);
+		else if (option == "--producers") numProducers = std::min<size_t>(std::max<size_t>(size_t(std::stoul(argv[i + 1])), 1), 255);
+		else if (option == "--rounds") numRounds = size_t(std::stoul(argv[i + 1]));
+		else if (option == "--out") outPath = argv[i + 1];
+		else {
+			std::cerr << "unknown option " << option << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	size_t mismatches = 0;
+	size_t received = 0;
+	size_t misordered = 0;
+	double maxCloseMs = 0;
+	double maxExitMs = 0;
+	size_t leaks = 0;
+	size_t badEpochs = 0;
+	bool bRan = runDuplex(numLines, mismatches);
+	bRan = bRan && runProducers(numProducers, numFrames, received, misordered);
+	bRan = bRan && runClose(numRounds, maxCloseMs, maxExitMs, leaks, badEpochs);
+
+	const bool bOk = bRan && mismatches == 0 && received == numProducers * numFrames && misordered == 0
+		&& leaks == 0 && badEpochs == 0 && maxExitMs < 1000;
+	std::ostringstream out;
+	out << "{\n  \"benchmark\": \"thread_stress\",\n  \"duplex_lines\": " << numLines
+		<< ",\n  \"duplex_mismatches\": " << mismatches
+		<< ",\n  \"producer_frames\": " << numProducers * numFrames
+		<< ",\n  \"producer_frames_received\": " << received
+		<< ",\n  \"producer_frames_misordered\": " << misordered
+		<< ",\n  \"close_rounds\": " << numRounds
+		<< ",\n  \"close_max_ms\": " << maxCloseMs
+		<< ",\n  \"close_blocked_calls_exit_max_ms\": " << maxExitMs
+		<< ",\n  \"close_leaks_into_next_fd\": " << leaks
+		<< ",\n  \"close_bad_epochs\": " << badEpochs
+		<< ",\n  \"ok\": " << (bOk ? "true" : "false") << "\n}\n";
+	std::cout << out.str();
+	if (!outPath.empty()) std::ofstream(outPath) << out.str();
+	return bOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
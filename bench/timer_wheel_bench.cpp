@@ -0,0 +1,104 @@
+// This is a benchmark of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialTimerWheel.h"
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <vector>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// Cost of arming, re-arming, cancelling and firing timeouts on an
+// ofSerialTimerWheel, with deadlines spread between 1 ms and 60 s like
+// per-request timeouts. For comparison, one timerfd_settime() per timeout,
+// which is what a timerfd per port or per request would cost.
+//
+// Usage: serial_bench_timer_wheel [--timers N] [--out FILE]
+
+using Clock = std::chrono::steady_clock;
+
+//----------------------------------------------------------------
+static double nsPer(Clock::time_point begin, size_t count) {
+	return std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / double(count);
+}
+
+//----------------------------------------------------------------
+int main(int argc, char * argv[]) {
+	size_t numTimers = 1000000;
+	std::string outPath;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		if (option == "--timers") numTimers = size_t(std::stoul(argv[i + 1]));
+		else if (option == "--out") outPath = argv[i + 1];
+		else {
+			std::cerr << "unknown option " << option << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	size_t fired = 0;
+	std::vector<std::unique_ptr<ofSerialTimer>> timers(numTimers);
+	for (auto & timer : timers) {
+		timer = std::make_unique<ofSerialTimer>([&fired]() { fired++; });
+	}
+	std::mt19937_64 rng(42);
+	std::uniform_int_distribution<int64_t> spread(1000, 60000000);
+	std::vector<Clock::duration> delays(numTimers);
+	for (auto & delay : delays) delay = std::chrono::microseconds(spread(rng));
+
+	ofSerialTimerWheel wheel;
+	const auto base = Clock::now();
+
+	auto begin = Clock::now();
+	for (size_t i = 0; i < numTimers; i++) wheel.arm(*timers[i], base + delays[i]);
+	const double armNs = nsPer(begin, numTimers);
+
+	// a request answered in time pushes its port timeout back
+	begin = Clock::now();
+	for (size_t i = 0; i < numTimers; i++) wheel.arm(*timers[i], base + delays[numTimers - 1 - i]);
+	const double rearmNs = nsPer(begin, numTimers);
+
+	begin = Clock::now();
+	for (size_t i = 0; i < numTimers; i += 2) timers[i]->cancel();
+	const double cancelNs = nsPer(begin, (numTimers + 1) / 2);
+	const size_t numArmed = wheel.getNumArmed();
+
+	// let a minute go by, a millisecond at a time
+	begin = Clock::now();
+	for (auto now = base; now <= base + std::chrono::seconds(61); now += std::chrono::milliseconds(1)) {
+		wheel.advance(now);
+	}
+	const double fireNs = nsPer(begin, std::max<size_t>(fired, 1));
+	const bool bOk = fired == numArmed && wheel.getNumArmed() == 0;
+
+	// one timerfd_settime() per timeout
+	const int timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	const size_t numSyscalls = std::min<size_t>(numTimers, 100000);
+	begin = Clock::now();
+	for (size_t i = 0; i < numSyscalls; i++) {
+		struct itimerspec spec = {};
+		spec.it_value.tv_sec = 60;
+		spec.it_value.tv_nsec = long(i % 1000000);
+		timerfd_settime(timerFd, 0, &spec, nullptr);
+	}
+	const double timerFdNs = nsPer(begin, numSyscalls);
+	close(timerFd);
+
+	std::ostringstream out;
+	out << "{\n  \"benchmark\": \"timer_wheel\",\n  \"timers\": " << numTimers
+		<< ",\n  \"arm_ns\": " << armNs
+		<< ",\n  \"rearm_ns\": " << rearmNs
+		<< ",\n  \"cancel_ns\": " << cancelNs
+		<< ",\n  \"fire_ns\": " << fireNs
+		<< ",\n  \"fired\": " << fired
+		<< ",\n  \"timerfd_settime_ns\": " << timerFdNs
+		<< ",\n  \"ok\": " << (bOk ? "true" : "false") << "\n}\n";
+	std::cout << out.str();
+	if (!outPath.empty()) std::ofstream(outPath) << out.str();
+	return bOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
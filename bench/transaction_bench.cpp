@@ -0,0 +1,282 @@
+// This is a benchmark of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialTransactions.h"
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <poll.h>
+#include <pty.h>
+#include <unistd.h>
+
+// Request/response throughput against a fake device behind a pseudo terminal,
+// for several window sizes. The device answers each COBS request after a
+// fixed delay, like a USB adapter and its firmware would, and keeps working
+// on the next requests meanwhile. Every response is checked, and so is
+// that requests sent by the completions of cancelAll() and of the destructor
+// never reach the device.
+//
+// Usage: serial_bench_transactions [--windows 1,2,4,8,16] [--requests N]
+//                                  [--latency-us US] [--out FILE]
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr size_t requestSize = 16;
+static constexpr size_t responseSize = 32;
+
+struct WindowResult {
+	size_t window = 0;
+	size_t done = 0;
+	size_t failed = 0;
+	double seconds = 0;
+	double meanRoundTripUs = 0;
+};
+
+//----------------------------------------------------------------
+static std::vector<size_t> splitList(const std::string & list) {
+	std::vector<size_t> items;
+	std::stringstream stream(list);
+	std::string item;
+	while (std::getline(stream, item, ',')) {
+		if (!item.empty()) items.push_back(size_t(std::stoul(item)));
+	}
+	return items;
+}
+
+//----------------------------------------------------------------
+static bool writeAll(int fd, const uint8_t * data, size_t length) {
+	while (length > 0) {
+		auto n = write(fd, data, length);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			if (errno != EAGAIN) return false;
+			struct pollfd pfd = { fd, POLLOUT, 0 };
+			if (::poll(&pfd, 1, 2000) <= 0) return false;
+			continue;
+		}
+		data += n;
+		length -= size_t(n);
+	}
+	return true;
+}
+
+//----------------------------------------------------------------
+// Answers every request with its id followed by a pattern, 'latency' after it came in.
+static void runDevice(int master, std::chrono::microseconds latency, std::atomic<bool> & bStop) {
+	struct Reply {
+		Clock::time_point due;
+		uint32_t id;
+	};
+	std::deque<Reply> replies;
+	ofSerialCobsDecoder decoder(requestSize);
+	std::vector<uint8_t> buffer(4096);
+	std::vector<uint8_t> payload(responseSize);
+	std::vector<uint8_t> encoded(ofSerialCobsEncoder::getMaxEncodedLength(responseSize));
+	while (!bStop) {
+		int timeoutMs = 10;
+		if (!replies.empty()) {
+			const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(replies.front().due - Clock::now()).count();
+			timeoutMs = int(std::max<long long>(left, 0));
+		}
+		struct pollfd pfd = { master, POLLIN, 0 };
+		if (::poll(&pfd, 1, timeoutMs) > 0) {
+			const auto n = read(master, buffer.data(), buffer.size());
+			const auto now = Clock::now();
+			if (n > 0) {
+				decoder.feed(buffer.data(), size_t(n), [&](std::span<const uint8_t> frame) {
+					uint32_t id;
+					if (frame.size() != requestSize) return;
+					memcpy(&id, frame.data(), sizeof(id));
+					replies.push_back({ now + latency, id });
+				});
+			}
+		}
+		while (!replies.empty() && replies.front().due <= Clock::now()) {
+			const uint32_t id = replies.front().id;
+			replies.pop_front();
+			memcpy(payload.data(), &id, sizeof(id));
+			for (size_t k = sizeof(id); k < responseSize; k++) payload[k] = uint8_t(id + k);
+			const size_t length = ofSerialCobsEncoder::encode(payload, encoded);
+			if (!writeAll(master, encoded.data(), length)) return;
+		}
+	}
+}
+
+//----------------------------------------------------------------
+static WindowResult runWindow(const char * slaveName, int master, size_t window, size_t numRequests, std::chrono::microseconds latency) {
+	WindowResult result;
+	result.window = window;
+
+	std::atomic<bool> bStop(false);
+	std::thread device(runDevice, master, latency, std::ref(bStop));
+
+	ofSerial serial;
+	serial.setup(std::string_view(slaveName), 115200);
+	ofSerialCobsDecoder decoder(responseSize);
+	ofSerialTransactions transactions(serial, decoder, [](std::span<const uint8_t> frame, uint32_t & id) {
+		if (frame.size() < sizeof(id)) return false;
+		memcpy(&id, frame.data(), sizeof(id));
+		return true;
+	}, window);
+
+	std::vector<uint8_t> payload(requestSize);
+	std::vector<uint8_t> encoded(ofSerialCobsEncoder::getMaxEncodedLength(requestSize));
+	double roundTripUs = 0;
+	auto onComplete = [&](const ofSerialTransaction & transaction) {
+		const auto response = transaction.getResponse();
+		bool bOk = transaction.getStatus() == ofSerialTransactionStatus::Done && response.size() == responseSize;
+		for (size_t k = sizeof(uint32_t); bOk && k < responseSize; k++) {
+			bOk = response[k] == uint8_t(transaction.getId() + k);
+		}
+		if (bOk) {
+			result.done++;
+			roundTripUs += double(transaction.getRoundTrip().count());
+		} else {
+			result.failed++;
+		}
+	};
+
+	const auto begin = Clock::now();
+	uint32_t next = 0;
+	while (result.done + result.failed < numRequests) {
+		while (next < numRequests && transactions.getNumPending() < window) {
+			memcpy(payload.data(), &next, sizeof(next));
+			const size_t length = ofSerialCobsEncoder::encode(payload, encoded);
+			transactions.send(next, std::span<const uint8_t>(encoded.data(), length), std::chrono::milliseconds(1000), onComplete);
+			next++;
+		}
+		transactions.update(-1);
+	}
+	result.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+	result.meanRoundTripUs = result.done > 0 ? roundTripUs / double(result.done) : 0;
+
+	serial.close();
+	bStop = true;
+	device.join();
+	return result;
+}
+
+//----------------------------------------------------------------
+// Completions that send again while cancelAll() and the destructor run, with nobody answering.
+static bool checkCancel(size_t & writtenAfterCancel, size_t & rejectedWhileClosing) {
+	int master = -1;
+	int slave = -1;
+	char slaveName[256];
+	if (openpty(&master, &slave, slaveName, nullptr, nullptr) != 0) {
+		std::cerr << "openpty failed: " << strerror(errno) << std::endl;
+		return false;
+	}
+	struct termios options;
+	tcgetattr(master, &options);
+	cfmakeraw(&options);
+	tcsetattr(master, TCSANOW, &options);
+
+	ofSerial serial;
+	serial.setup(std::string_view(slaveName), 115200);
+	ofSerialCobsDecoder decoder(responseSize);
+	const std::vector<uint8_t> request(requestSize, 'r');
+	size_t written = 0;
+	auto drain = [&]() {
+		uint8_t buffer[256];
+		struct pollfd pfd = { master, POLLIN, 0 };
+		while (::poll(&pfd, 1, 50) > 0) {
+			const auto n = read(master, buffer, sizeof(buffer));
+			if (n <= 0) break;
+			written += size_t(n);
+		}
+	};
+	{
+		ofSerialTransactions transactions(serial, decoder, [](std::span<const uint8_t>, uint32_t &) { return false; }, 1);
+		bool bClosing = false;
+		std::function<void(const ofSerialTransaction &)> onComplete = [&](const ofSerialTransaction & transaction) {
+			const auto resent = transactions.send(transaction.getId() + 100, request, std::chrono::milliseconds(1000), transaction.getId() < 100 ? onComplete : nullptr);
+			if (bClosing && resent.getStatus() == ofSerialTransactionStatus::Rejected) rejectedWhileClosing++;
+		};
+		// the window holds one, the others stay queued
+		for (uint32_t id = 0; id < 3; id++) {
+			transactions.send(id, request, std::chrono::milliseconds(1000), onComplete);
+		}
+		drain();
+		written = 0;
+		transactions.cancelAll();
+		for (uint32_t id = 0; id < 3; id++) {
+			transactions.send(id, request, std::chrono::milliseconds(1000), onComplete);
+		}
+		drain();
+		written = written > requestSize ? written - requestSize : 0;
+		bClosing = true;
+	}
+	drain();
+	writtenAfterCancel = written;
+
+	serial.close();
+	close(slave);
+	close(master);
+	return true;
+}
+
+//----------------------------------------------------------------
+int main(int argc, char * argv[]) {
+	std::vector<size_t> windows = { 1, 2, 4, 8, 16 };
+	size_t numRequests = 2000;
+	std::chrono::microseconds latency(1000);
+	std::string outPath;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		if (option == "--windows") windows = splitList(argv[i + 1]);
+		else if (option == "--requests") numRequests = size_t(std::stoul(argv[i + 1]));
+		else if (option == "--latency-us") latency = std::chrono::microseconds(std::stol(argv[i + 1]));
+		else if (option == "--out") outPath = argv[i + 1];
+		else {
+			std::cerr << "unknown option " << option << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	int master = -1;
+	int slave = -1;
+	char slaveName[256];
+	if (openpty(&master, &slave, slaveName, nullptr, nullptr) != 0) {
+		std::cerr << "openpty failed: " << strerror(errno) << std::endl;
+		return EXIT_FAILURE;
+	}
+	struct termios options;
+	tcgetattr(master, &options);
+	cfmakeraw(&options);
+	tcsetattr(master, TCSANOW, &options);
+
+	std::vector<WindowResult> results;
+	for (size_t window : windows) {
+		results.push_back(runWindow(slaveName, master, std::max<size_t>(window, 1), numRequests, latency));
+	}
+	close(slave);
+	close(master);
+
+	size_t writtenAfterCancel = 0;
+	size_t rejectedWhileClosing = 0;
+	bool bOk = checkCancel(writtenAfterCancel, rejectedWhileClosing) && writtenAfterCancel == 0 && rejectedWhileClosing == 3;
+	std::ostringstream out;
+	out << "{\n  \"benchmark\": \"transactions\",\n  \"requests\": " << numRequests << ",\n  \"latency_us\": " << latency.count()
+		<< ",\n  \"cancel_bytes_written_after\": " << writtenAfterCancel
+		<< ",\n  \"cancel_sends_rejected_while_closing\": " << rejectedWhileClosing << ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const auto & result = results[i];
+		bOk = bOk && result.failed == 0 && result.done == numRequests;
+		out << "    { \"window\": " << result.window
+			<< ", \"done\": " << result.done
+			<< ", \"failed\": " << result.failed
+			<< ", \"seconds\": " << result.seconds
+			<< ", \"transactions_per_s\": " << (result.seconds > 0 ? double(result.done) / result.seconds : 0)
+			<< ", \"mean_round_trip_us\": " << result.meanRoundTripUs << " }"
+			<< (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	out << "  ]\n}\n";
+	std::cout << out.str();
+	if (!outPath.empty()) std::ofstream(outPath) << out.str();
+	return bOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
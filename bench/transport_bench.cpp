@@ -0,0 +1,253 @@
+// This is a benchmark of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialTransport.h"
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// A fake device streams COBS frames to an ofSerialPort which decodes them,
+// on each transport: the in-memory loopback, a unix socket pair and a
+// pseudo terminal. Every frame is checked.
+//
+// readExactly() is then checked on each transport: Done, Timeout on a
+// silent peer, and Disconnected once the peer closed its end, after the
+// bytes it sent before.
+//
+// Usage: serial_bench_transport [--transports loopback,socketpair,pty]
+//                               [--bytes BYTES] [--frame FRAME_SIZE] [--out FILE]
+//
+// --bytes applies to the loopback, the kernel transports move 1/16 of it
+// so that a run stays short.
+
+using Clock = std::chrono::steady_clock;
+
+struct TransportResult {
+	std::string transport;
+	size_t bytes = 0;
+	size_t frames = 0;
+	double seconds = 0;
+	bool bOk = false;
+};
+
+//----------------------------------------------------------------
+static std::vector<std::string> splitList(const std::string & list) {
+	std::vector<std::string> items;
+	std::stringstream stream(list);
+	std::string item;
+	while (std::getline(stream, item, ',')) {
+		if (!item.empty()) items.push_back(item);
+	}
+	return items;
+}
+
+//----------------------------------------------------------------
+// Frame i carries i in its first 8 bytes, then a pattern derived from it.
+static void fillFrame(std::vector<uint8_t> & payload, uint64_t index) {
+	memcpy(payload.data(), &index, sizeof(index));
+	for (size_t k = sizeof(index); k < payload.size(); k++) {
+		payload[k] = uint8_t(index * 31 + k);
+	}
+}
+
+// 'writeAll' sends bytes from the device side, the port decodes them.
+template<class Transport, class WriteAll>
+static TransportResult run(const std::string & name, ofSerialPort<Transport> & port, WriteAll && writeAll, size_t bytes, size_t frameSize) {
+	TransportResult result;
+	result.transport = name;
+	const size_t numFrames = std::max<size_t>(bytes / frameSize, 1);
+
+	std::thread device([&]() {
+		std::vector<uint8_t> payload(frameSize);
+		std::vector<uint8_t> encoded(ofSerialCobsEncoder::getMaxEncodedLength(frameSize) * 64);
+		size_t used = 0;
+		for (size_t i = 0; i < numFrames; i++) {
+			fillFrame(payload, i);
+			used += ofSerialCobsEncoder::encode(payload, std::span<uint8_t>(encoded.data() + used, encoded.size() - used));
+			if (encoded.size() - used < ofSerialCobsEncoder::getMaxEncodedLength(frameSize) || i + 1 == numFrames) {
+				if (!writeAll(encoded.data(), used)) return;
+				used = 0;
+			}
+		}
+	});
+
+	ofSerialCobsDecoder decoder(frameSize);
+	std::vector<uint8_t> expected(frameSize);
+	size_t received = 0;
+	size_t wireBytes = 0;
+	bool bOk = true;
+	const auto begin = Clock::now();
+	while (received < numFrames && bOk) {
+		port.readFrames(decoder, [&](std::span<const uint8_t> frame) {
+			fillFrame(expected, received);
+			if (frame.size() != frameSize || memcmp(frame.data(), expected.data(), frameSize) != 0) {
+				bOk = false;
+			}
+			wireBytes += frame.size();
+			received++;
+		});
+		if (received < numFrames && !port.waitReadable(2000)) {
+			std::cerr << name << ": timeout after " << received << " frames" << std::endl;
+			bOk = false;
+		}
+	}
+	result.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+	port.close();
+	device.join();
+
+	result.bytes = wireBytes;
+	result.frames = received;
+	result.bOk = bOk && received == numFrames && decoder.getErrorCount() == 0;
+	return result;
+}
+
+//----------------------------------------------------------------
+static bool writeAllFd(int fd, const uint8_t * data, size_t length) {
+	while (length > 0) {
+		auto n = write(fd, data, length);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			if (errno != EAGAIN) return false;
+			struct pollfd pfd = { fd, POLLOUT, 0 };
+			if (::poll(&pfd, 1, 2000) <= 0) return false;
+			continue;
+		}
+		data += n;
+		length -= size_t(n);
+	}
+	return true;
+}
+
+//----------------------------------------------------------------
+// 'hangUp' closes the device side after it sent "abc".
+template<class Transport, class Send, class HangUp>
+static bool checkReadExactly(const std::string & name, ofSerialPort<Transport> & port, Send && send, HangUp && hangUp) {
+	uint8_t buffer[8];
+	bool bOk = send("abcdef") && port.readExactly(buffer, 3, Clock::now() + std::chrono::seconds(1)).status == ofSerialReadStatus::Done;
+	auto result = port.readExactly(buffer, 4, Clock::now() + std::chrono::milliseconds(20));
+	bOk = bOk && result.status == ofSerialReadStatus::Timeout && result.bytesRead == 3 && memcmp(buffer, "def", 3) == 0;
+	bOk = bOk && send("abc");
+	hangUp();
+	result = port.readExactly(buffer, 8, Clock::now() + std::chrono::seconds(1));
+	bOk = bOk && result.status == ofSerialReadStatus::Disconnected;
+	// a pty drops what its master sent when the master closes, the other transports hand it over first
+	bOk = bOk && (name == "pty" || (result.bytesRead == 3 && memcmp(buffer, "abc", 3) == 0));
+	port.close();
+	bOk = bOk && port.readExactly(buffer, 1, Clock::now()).status == ofSerialReadStatus::Closed;
+	if (!bOk) std::cerr << name << ": readExactly() check failed" << std::endl;
+	return bOk;
+}
+
+//----------------------------------------------------------------
+static bool checkReadExactlyAll() {
+	bool bOk = true;
+	{
+		ofSerialLoopback loopback(4096);
+		ofSerialPort<ofSerialLoopbackTransport> host(loopback, ofSerialLoopback::Host);
+		ofSerialPort<ofSerialLoopbackTransport> device(loopback, ofSerialLoopback::Device);
+		bOk = checkReadExactly("loopback", host, [&](const char * text) {
+			return device.writeBytes(reinterpret_cast<const uint8_t *>(text), strlen(text)) == strlen(text);
+		}, [&]() { device.close(); }) && bOk;
+		uint8_t byte = 0;
+		bOk = bOk && device.writeBytes(&byte, 1, 10) == 0;
+	}
+	for (const std::string name : { "socketpair", "pty" }) {
+		ofSerialPort<ofSerialSocketpairTransport> socketpair;
+		ofSerialPort<ofSerialPtyTransport> pty;
+		int peer = -1;
+		if (name == "socketpair" && socketpair.getTransport().setup()) peer = socketpair.getTransport().getPeerFileDescriptor();
+		if (name == "pty" && pty.getTransport().setup()) peer = pty.getTransport().getPeerFileDescriptor();
+		if (peer == -1) return false;
+		auto send = [peer](const char * text) { return writeAllFd(peer, reinterpret_cast<const uint8_t *>(text), strlen(text)); };
+		// the transport owns the peer descriptor, it is shut down rather than closed twice
+		auto hangUp = [peer]() {
+			if (shutdown(peer, SHUT_RDWR) != 0) {
+				const int nullFd = open("/dev/null", O_RDWR);
+				dup2(nullFd, peer);
+				close(nullFd);
+			}
+		};
+		if (name == "socketpair") bOk = checkReadExactly(name, socketpair, send, hangUp) && bOk;
+		else bOk = checkReadExactly(name, pty, send, hangUp) && bOk;
+	}
+	return bOk;
+}
+
+//----------------------------------------------------------------
+int main(int argc, char * argv[]) {
+	std::vector<std::string> transports = { "loopback", "socketpair", "pty" };
+	size_t bytes = size_t(2) << 30;
+	size_t frameSize = 256;
+	std::string outPath;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		if (option == "--transports") transports = splitList(argv[i + 1]);
+		else if (option == "--bytes") bytes = size_t(std::stoull(argv[i + 1]));
+		else if (option == "--frame") frameSize = std::max<size_t>(size_t(std::stoul(argv[i + 1])), 8);
+		else if (option == "--out") outPath = argv[i + 1];
+		else {
+			std::cerr << "unknown option " << option << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::vector<TransportResult> results;
+	for (auto & name : transports) {
+		if (name == "loopback") {
+			ofSerialLoopback loopback(1 << 20);
+			ofSerialPort<ofSerialLoopbackTransport> host(loopback, ofSerialLoopback::Host);
+			ofSerialPort<ofSerialLoopbackTransport> device(loopback, ofSerialLoopback::Device);
+			results.push_back(run(name, host, [&](const uint8_t * data, size_t length) {
+				return device.writeBytes(data, length, 2000) == length;
+			}, bytes, frameSize));
+		} else if (name == "socketpair") {
+			ofSerialPort<ofSerialSocketpairTransport> host;
+			if (!host.getTransport().setup(1 << 20)) return EXIT_FAILURE;
+			const int peer = host.getTransport().getPeerFileDescriptor();
+			results.push_back(run(name, host, [peer](const uint8_t * data, size_t length) {
+				return writeAllFd(peer, data, length);
+			}, bytes / 16, frameSize));
+		} else if (name == "pty") {
+			ofSerialPort<ofSerialPtyTransport> host;
+			if (!host.getTransport().setup()) return EXIT_FAILURE;
+			const int peer = host.getTransport().getPeerFileDescriptor();
+			results.push_back(run(name, host, [peer](const uint8_t * data, size_t length) {
+				return writeAllFd(peer, data, length);
+			}, bytes / 16, frameSize));
+		} else {
+			std::cerr << "unknown transport " << name << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const bool bReadExactlyOk = checkReadExactlyAll();
+
+	bool bOk = bReadExactlyOk;
+	std::ostringstream out;
+	out << "{\n  \"benchmark\": \"transport\",\n  \"frame_size\": " << frameSize
+		<< ",\n  \"read_exactly_check\": " << (bReadExactlyOk ? "true" : "false") << ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const auto & result = results[i];
+		bOk = bOk && result.bOk;
+		out << "    { \"transport\": \"" << result.transport << "\""
+			<< ", \"bytes\": " << result.bytes
+			<< ", \"frames\": " << result.frames
+			<< ", \"seconds\": " << result.seconds
+			<< ", \"throughput_mb_s\": " << (result.seconds > 0 ? double(result.bytes) / result.seconds / 1e6 : 0)
+			<< ", \"ok\": " << (result.bOk ? "true" : "false") << " }"
+			<< (i + 1 < results.size() ? ",\n" : "\n");
+	}
+	out << "  ]\n}\n";
+	std::cout << out.str();
+	if (!outPath.empty()) std::ofstream(outPath) << out.str();
+	return bOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
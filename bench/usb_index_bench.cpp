@@ -0,0 +1,187 @@
+// This is a benchmark of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialUsbIndex.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Builds a fake sysfs and /dev tree in a temporary directory, then measures
+// how long ofSerialUsbIndex takes to index it and to answer lookups. Every
+// lookup is checked, the exit code is non zero if one of them is wrong.
+//
+// Usage: serial_bench_usb_index [--devices N] [--lookups N] [--out FILE]
+//
+// The tree holds N USB adapters: odd ones are FT2232 style with two
+// ttyUSB ports, even ones single port CDC ACM boards. Platform ports and
+// virtual terminals are added around them, they must not be indexed.
+
+using Clock = std::chrono::steady_clock;
+
+//----------------------------------------------------------------
+static bool makeDirs(const std::string & path) {
+	for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+		const std::string part = path.substr(0, slash);
+		if (mkdir(part.c_str(), 0755) != 0 && errno != EEXIST) {
+			std::cerr << "mkdir " << part << ": " << strerror(errno) << std::endl;
+			return false;
+		}
+		if (slash == std::string::npos) return true;
+	}
+}
+
+static void writeFile(const std::string & path, const std::string & content) {
+	std::ofstream(path) << content << "\n";
+}
+
+static bool makeLink(const std::string & target, const std::string & link) {
+	if (symlink(target.c_str(), link.c_str()) != 0) {
+		std::cerr << "symlink " << link << ": " << strerror(errno) << std::endl;
+		return false;
+	}
+	return true;
+}
+
+static std::string hex4(unsigned value) {
+	char text[8];
+	snprintf(text, sizeof(text), "%04x", value);
+	return text;
+}
+
+static std::string serialOf(size_t device) {
+	return "SN" + std::to_string(100000 + device);
+}
+
+//----------------------------------------------------------------
+// One tty of a USB device: class/tty/<tty>/device points at the interface
+// (ACM) or at a port directory below it (ttyUSB), as on a real system.
+static bool addTty(const std::string & root, const std::string & usbDevice, unsigned interfaceNumber, const std::string & tty, bool bPortDir, const std::string & byId) {
+	const std::string interfaceDir = usbDevice + usbDevice.substr(usbDevice.rfind('/')) + ":1." + std::to_string(interfaceNumber);
+	std::string deviceDir = interfaceDir;
+	if (bPortDir) deviceDir += "/" + tty;
+	if (!makeDirs(deviceDir) || !makeDirs(root + "/sys/class/tty/" + tty)) return false;
+	writeFile(interfaceDir + "/bInterfaceNumber", hex4(interfaceNumber).substr(2));
+	writeFile(root + "/dev/" + tty, "");
+	if (!makeLink(deviceDir, root + "/sys/class/tty/" + tty + "/device")) return false;
+	return makeLink("../../" + tty, root + "/dev/serial/by-id/" + byId);
+}
+
+static bool buildTree(const std::string & root, size_t numDevices) {
+	if (!makeDirs(root + "/dev/serial/by-id") || !makeDirs(root + "/sys/class/tty")) return false;
+	size_t usb = 0;
+	size_t acm = 0;
+	for (size_t i = 0; i < numDevices; i++) {
+		const std::string usbDevice = root + "/sys/devices/pci0000:00/usb1/1-" + std::to_string(i);
+		if (!makeDirs(usbDevice)) return false;
+		const bool bDual = i % 2 == 1;
+		writeFile(usbDevice + "/idVendor", bDual ? "0403" : "2341");
+		writeFile(usbDevice + "/idProduct", bDual ? "6010" : hex4(unsigned(i % 64)));
+		writeFile(usbDevice + "/serial", serialOf(i));
+		writeFile(usbDevice + "/manufacturer", bDual ? "FTDI" : "Arduino");
+		writeFile(usbDevice + "/product", bDual ? "Dual RS232" : "Board");
+		if (bDual) {
+			for (unsigned k = 0; k < 2; k++) {
+				const std::string tty = "ttyUSB" + std::to_string(usb++);
+				if (!addTty(root, usbDevice, k, tty, true, "usb-FTDI_Dual_RS232_" + serialOf(i) + "-if0" + std::to_string(k) + "-port0")) return false;
+			}
+		} else {
+			const std::string tty = "ttyACM" + std::to_string(acm++);
+			if (!addTty(root, usbDevice, 0, tty, false, "usb-Arduino_Board_" + serialOf(i) + "-if00")) return false;
+		}
+	}
+	for (size_t i = 0; i < 32; i++) {
+		const std::string platform = root + "/sys/devices/platform/serial8250/ttyS" + std::to_string(i);
+		if (!makeDirs(platform) || !makeDirs(root + "/sys/class/tty/ttyS" + std::to_string(i))) return false;
+		if (!makeLink("../../../devices/platform/serial8250", root + "/sys/class/tty/ttyS" + std::to_string(i) + "/device")) return false;
+		if (!makeDirs(root + "/sys/class/tty/tty" + std::to_string(i))) return false;
+	}
+	return true;
+}
+
+//----------------------------------------------------------------
+int main(int argc, char * argv[]) {
+	size_t numDevices = 1000;
+	size_t numLookups = 1000000;
+	std::string outPath;
+	for (int i = 1; i + 1 < argc; i += 2) {
+		const std::string option = argv[i];
+		if (option == "--devices") numDevices = size_t(std::stoul(argv[i + 1]));
+		else if (option == "--lookups") numLookups = size_t(std::stoul(argv[i + 1]));
+		else if (option == "--out") outPath = argv[i + 1];
+		else {
+			std::cerr << "unknown option " << option << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	if (numDevices == 0) numDevices = 1;
+
+	char rootTemplate[] = "/tmp/serial_usb_index_XXXXXX";
+	if (mkdtemp(rootTemplate) == nullptr) {
+		std::cerr << "mkdtemp: " << strerror(errno) << std::endl;
+		return EXIT_FAILURE;
+	}
+	const std::string root = rootTemplate;
+	if (!buildTree(root, numDevices)) return EXIT_FAILURE;
+
+	const size_t expected = numDevices + numDevices / 2;
+	auto begin = Clock::now();
+	ofSerialUsbIndex index(root + "/sys", root + "/dev");
+	const double buildSeconds = std::chrono::duration<double>(Clock::now() - begin).count();
+	bool bOk = index.getDevices().size() == expected;
+	if (!bOk) std::cerr << "indexed " << index.getDevices().size() << " devices, expected " << expected << std::endl;
+
+	// identity lookups, checked against what the tree was built with
+	begin = Clock::now();
+	size_t checksum = 0;
+	for (size_t n = 0; n < numLookups; n++) {
+		const size_t i = (n * 7919) % numDevices;
+		const bool bDual = i % 2 == 1;
+		const std::string serial = serialOf(i);
+		auto device = bDual ? index.findInterface(0x0403, 0x6010, serial, uint8_t(n & 1)) : index.find(0x2341, uint16_t(i % 64), serial);
+		if (device == nullptr || device->serialNumber != serial || (bDual && device->interfaceNumber != (n & 1))) {
+			std::cerr << "wrong lookup for device " << i << std::endl;
+			bOk = false;
+			break;
+		}
+		checksum += device->ttyName.size();
+	}
+	const double identitySeconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+	begin = Clock::now();
+	for (size_t n = 0; n < numLookups && bOk; n++) {
+		const auto & device = index.getDevices()[n % index.getDevices().size()];
+		if (index.findByIdPath(device.byIdPath) != &device || index.findByName(device.devicePath) != &device) {
+			std::cerr << "wrong path lookup for " << device.ttyName << std::endl;
+			bOk = false;
+		}
+	}
+	const double pathSeconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+	if (index.findByName("ttyS0") != nullptr || index.findByName("tty0") != nullptr) {
+		std::cerr << "non USB ports were indexed" << std::endl;
+		bOk = false;
+	}
+
+	std::ostringstream out;
+	out << "{\n  \"benchmark\": \"usb_index\",\n"
+		<< "  \"devices\": " << numDevices << ",\n"
+		<< "  \"ttys\": " << index.getDevices().size() << ",\n"
+		<< "  \"build_ms\": " << buildSeconds * 1000 << ",\n"
+		<< "  \"identity_lookup_ns\": " << identitySeconds * 1e9 / double(numLookups) << ",\n"
+		<< "  \"path_lookup_ns\": " << pathSeconds * 1e9 / double(numLookups * 2) << ",\n"
+		<< "  \"checksum\": " << checksum << ",\n"
+		<< "  \"ok\": " << (bOk ? "true" : "false") << "\n}\n";
+	std::cout << out.str();
+	if (!outPath.empty()) std::ofstream(outPath) << out.str();
+
+	const std::string cleanup = "rm -rf '" + root + "'";
+	if (system(cleanup.c_str()) != 0) std::cerr << "could not remove " << root << std::endl;
+	return bOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,109 @@
+// This is an example of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialCoroutine.h"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <cstring>
+#include <poll.h>
+#include <pty.h>
+#include <unistd.h>
+
+// One conversation per port: send a request, read the reply line and its
+// 4 bytes trailer. Every conversation runs in the same thread.
+static ofSerialTask<> conversation(ofSerialCoroutinePort& port, size_t requests, size_t& replies) {
+	for (size_t i = 0; i < requests; i++) {
+		const std::string l_request = "PING " + std::to_string(i) + "\n";
+		co_await port.write(l_request);
+		const std::optional<std::string> l_line = co_await port.readUntil('\n');
+		if (!l_line) {
+			std::cout << "NO REPLY " << i << std::endl;
+			co_return;
+		}
+		const std::vector<uint8_t> l_trailer = co_await port.readExactly(4);
+		if (*l_line != "PONG " + std::to_string(i) || l_trailer.size() != 4) {
+			std::cout << "BAD REPLY " << *l_line << std::endl;
+			co_return;
+		}
+		replies++;
+	}
+}
+
+// ofSerialScheduler example: pseudo terminals stand in for real devices, a
+// thread answers every "PING n" line with "PONG n" and a trailer.
+int main(int argc, char* argv[]) {
+
+	const size_t l_num_ports = argc > 1 ? size_t(atoi(argv[1])) : 16;
+	const size_t l_requests = argc > 2 ? size_t(atoi(argv[2])) : 1000;
+
+	// Create the pty pairs and open the slave side with ofSerial
+	std::vector<int> l_masters;
+	std::vector<std::unique_ptr<ofSerial>> l_ports;
+	for (size_t i = 0; i < l_num_ports; i++) {
+		int l_master = -1;
+		int l_slave = -1;
+		char l_name[256];
+		if (openpty(&l_master, &l_slave, l_name, nullptr, nullptr) != 0) {
+			std::cout << "openpty failed: " << strerror(errno) << std::endl;
+			return EXIT_FAILURE;
+		}
+		auto l_serial = std::make_unique<ofSerial>();
+		if (!l_serial->setup(std::string_view(l_name), 115200)) {
+			std::cout << "NOT CONNECTED " << l_name << std::endl;
+			return EXIT_FAILURE;
+		}
+		::close(l_slave);
+		l_masters.push_back(l_master);
+		l_ports.push_back(std::move(l_serial));
+	}
+
+	// The fake devices
+	std::atomic<bool> l_stop(false);
+	std::thread l_devices([&]() {
+		std::vector<std::string> l_lines(l_num_ports);
+		std::vector<pollfd> l_fds;
+		for (int l_master : l_masters) {
+			l_fds.push_back({ l_master, POLLIN, 0 });
+		}
+		while (!l_stop) {
+			if (::poll(l_fds.data(), l_fds.size(), 100) <= 0) continue;
+			for (size_t i = 0; i < l_num_ports; i++) {
+				if (!(l_fds[i].revents & POLLIN)) continue;
+				char l_buffer[256];
+				auto n = read(l_masters[i], l_buffer, sizeof(l_buffer));
+				for (ssize_t k = 0; k < n; k++) {
+					if (l_buffer[k] != '\n') {
+						l_lines[i] += l_buffer[k];
+						continue;
+					}
+					const std::string l_reply = "PONG" + l_lines[i].substr(4) + "\n\x01\x02\x03\x04";
+					auto unused = write(l_masters[i], l_reply.data(), l_reply.size());
+					(void)unused;
+					l_lines[i].clear();
+				}
+			}
+		}
+	});
+
+	ofSerialScheduler l_scheduler;
+	std::vector<std::unique_ptr<ofSerialCoroutinePort>> l_coroutinePorts;
+	size_t l_replies = 0;
+	for (auto& l_port : l_ports) {
+		l_coroutinePorts.push_back(std::make_unique<ofSerialCoroutinePort>(l_scheduler, *l_port));
+		l_scheduler.spawn(conversation(*l_coroutinePorts.back(), l_requests, l_replies));
+	}
+
+	const auto l_begin = std::chrono::steady_clock::now();
+	l_scheduler.run();
+	const auto l_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - l_begin).count();
+	l_stop = true;
+	l_devices.join();
+
+	std::cout << "PORTS " << l_num_ports << std::endl;
+	std::cout << "REPLIES " << l_replies << " / " << l_num_ports * l_requests << std::endl;
+	std::cout << "ELAPSED " << l_elapsed << " s" << std::endl;
+	return l_replies == l_num_ports * l_requests ? EXIT_SUCCESS : EXIT_FAILURE;
+}
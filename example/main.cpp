@@ -4,8 +4,9 @@
 
 #include "ofSerial.h"
 
+#include <array>
 #include <iostream>
-#include <thread>
+#include <span>
 
 // ofSerial standalone example
 int main(int argc, char* argv[]) {
@@ -34,6 +35,7 @@ int main(int argc, char* argv[]) {
 	}
 
 	std::cout << std::endl;
+	std::array<uint8_t, 1024> l_buffer;
 	while (true) {
 
 		// Get and send data
@@ -48,18 +50,19 @@ int main(int argc, char* argv[]) {
 		// l_serial.flush(true, true);
 		// l_serial.writeData(l_input);
 
-		// Wait the answer
-		while(!l_serial.available()) {
-			std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		// Wait the answer, readSome() wakes up as soon as data arrives
+		const auto l_result = l_serial.readSome(l_buffer, std::chrono::seconds(1));
+		if (l_result.status == ofSerialReadStatus::Timeout) {
+			continue;
+		}
+		if (!l_result) {
+			std::cout << (l_result.status == ofSerialReadStatus::Disconnected ? "DISCONNECTED" : "READ FAILED") << std::endl;
+			break;
 		}
 
-		// Check if there is data to read
-		int l_bytes_to_read = l_serial.available();
-	
 		// // Print number of bytes 
-		// std::cout << std::endl << "RECEIVED " << std::dec << l_bytes_to_read << " BYTES" << std::endl;
-		// int l_bytes_read = l_serial.readData(l_bytes_to_process, l_bytes_to_read);
-		auto bytes = l_serial.readBytes();
+		// std::cout << std::endl << "RECEIVED " << std::dec << l_result.bytesRead << " BYTES" << std::endl;
+		const std::span<const uint8_t> bytes(l_buffer.data(), l_result.bytesRead);
 		{
 			auto print_hex = [](const uint8_t chr){
 
@@ -73,9 +76,9 @@ int main(int argc, char* argv[]) {
 			std::cout << "bytes:" << std::oct << bytes.size(); 
 			std::cout << "str:" << std::string(bytes.begin(), bytes.end()); 
 			std::cout << std::endl << std::hex << std::uppercase << '[';
-			for (auto it = bytes.cbegin(); it != bytes.cend(); ++it) {
+			for (auto it = bytes.begin(); it != bytes.end(); ++it) {
 				print_hex(*it);
-				if(it != std::prev(bytes.cend())) std::cout << ',';
+				if(it != std::prev(bytes.end())) std::cout << ',';
 			}
 			std::cout << ']' << std::endl;
 		}
@@ -0,0 +1,90 @@
+// This is an example of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialReactor.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <cstring>
+#include <pty.h>
+#include <unistd.h>
+
+// ofSerialReactor example: pseudo terminals stand in for real devices, every
+// port is serviced by a single reactor thread.
+int main(int argc, char* argv[]) {
+
+	const size_t l_num_ports = argc > 1 ? size_t(atoi(argv[1])) : 16;
+	const size_t l_bytes_per_port = argc > 2 ? size_t(atoi(argv[2])) : 65536;
+
+	// Create the pty pairs and open the slave side with ofSerial
+	std::vector<int> l_masters;
+	std::vector<std::unique_ptr<ofSerial>> l_ports;
+	for (size_t i = 0; i < l_num_ports; i++) {
+		int l_master = -1;
+		int l_slave = -1;
+		char l_name[256];
+		if (openpty(&l_master, &l_slave, l_name, nullptr, nullptr) != 0) {
+			std::cout << "openpty failed: " << strerror(errno) << std::endl;
+			return EXIT_FAILURE;
+		}
+		auto l_serial = std::make_unique<ofSerial>();
+		if (!l_serial->setup(std::string_view(l_name), 115200)) {
+			std::cout << "NOT CONNECTED " << l_name << std::endl;
+			return EXIT_FAILURE;
+		}
+		::close(l_slave);
+		l_masters.push_back(l_master);
+		l_ports.push_back(std::move(l_serial));
+	}
+
+	// Register every port, count what we receive and when devices go away
+	ofSerialReactor l_reactor;
+	size_t l_received = 0;
+	size_t l_hangups = 0;
+	for (auto& l_port : l_ports) {
+		l_reactor.addPort(*l_port,
+			[&](ofSerial&, const uint8_t*, size_t length) {
+				l_received += length;
+			},
+			nullptr,
+			[&](ofSerial&) {
+				if (++l_hangups == l_num_ports) {
+					l_reactor.stop();
+				}
+			});
+	}
+
+	// Feed every port from another thread, then hang up
+	std::thread l_writer([&]() {
+		std::vector<uint8_t> l_chunk(1024, 'x');
+		for (size_t l_sent = 0; l_sent < l_bytes_per_port; l_sent += l_chunk.size()) {
+			// the last chunk is cut to the requested count
+			const size_t l_length = std::min(l_chunk.size(), l_bytes_per_port - l_sent);
+			for (int l_master : l_masters) {
+				size_t l_done = 0;
+				while (l_done < l_length) {
+					auto n = write(l_master, l_chunk.data() + l_done, l_length - l_done);
+					if (n > 0) l_done += size_t(n);
+				}
+			}
+		}
+		// let the reactor drain the ttys before closing the masters
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		for (int l_master : l_masters) {
+			::close(l_master);
+		}
+	});
+
+	const auto l_begin = std::chrono::steady_clock::now();
+	l_reactor.run();
+	const auto l_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - l_begin).count();
+	l_writer.join();
+
+	std::cout << "PORTS " << l_num_ports << std::endl;
+	std::cout << "RECEIVED " << l_received << " / " << l_num_ports * l_bytes_per_port << " BYTES" << std::endl;
+	std::cout << "HANGUPS " << l_hangups << std::endl;
+	std::cout << "ELAPSED " << l_elapsed << " s" << std::endl;
+	return l_received == l_num_ports * l_bytes_per_port ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -18,6 +18,10 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include "ofSerial.h"
+#include "ofSerialBufferPool.h"
+#include "ofSerialConfig.h"
+#include "ofSerialDeviceRegistry.h"
+#include "ofSerialFraming.h"
 
 
 #if defined( TARGET_OSX )
@@ -26,21 +30,24 @@
 
 #if defined( TARGET_OSX ) || defined( TARGET_LINUX )
 	#include <sys/ioctl.h>
-	#include <dirent.h>
 	#include <fcntl.h>
+	#include <poll.h>
+	#include <sys/uio.h>
+	#include <unistd.h>
 #endif
 
 #if defined( TARGET_LINUX )
 	#include <linux/serial.h>
 	#include <unistd.h>
 	#include <cstring>
-	// Some things for serial compilation:
-	#define B14400	14400
-	#define B28800	28800
+	#include "ofSerialTermios2.h"
+#endif
+
+#if defined( TARGET_OSX )
+	#include <IOKit/serial/ioss.h>
 #endif
 
 #include <iostream>
-#include <sstream>
 using std::vector;
 using std::string;
 
@@ -173,71 +180,19 @@ ofSerial::~ofSerial(){
 	bInited = false;
 }
 
-//----------------------------------------------------------------
-#if defined( TARGET_OSX )
-static bool isDeviceArduino( ofSerialDeviceInfo & A ){
-	return (strstr(A.getDeviceName().c_str(), "usbserial") != nullptr
-			|| strstr(A.getDeviceName().c_str(), "usbmodem") != nullptr);
-}
-#endif
-
 //----------------------------------------------------------------
 void ofSerial::buildDeviceList() {
 	deviceType = "serial";
-	devices.clear();
-	vector <string> prefixMatch;
-
-	#ifdef TARGET_OSX
-
-		prefixMatch.push_back("cu.");
-		prefixMatch.push_back("tty.");
-
-	#endif
-
-	#ifdef TARGET_LINUX
-
-		prefixMatch.push_back("ttyACM");
-		prefixMatch.push_back("ttyS");
-		prefixMatch.push_back("ttyUSB");
-		prefixMatch.push_back("rfc");
-
-	#endif
 
 	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
-		DIR *dir;
-		struct dirent *entry;
-		dir = opendir("/dev");
 
-		std::string deviceName	= "";
-		int deviceCount		= 0;
-
-		if (dir == NULL){
-			std::cerr << "buildDeviceList(): error listing devices in /dev" << "\r\n" << std::endl;
-		} else {
-			//for each device
-			while((entry = readdir(dir)) != NULL){
-				deviceName = (char *)entry->d_name;
-
-				//we go through the prefixes
-				for(auto & prefix: prefixMatch){
-					//if the device name is size_ter than the prefix
-					if(deviceName.size() > prefix.size()){
-						//do they match ?
-						if(deviceName.substr(0, prefix.size()) == prefix.c_str()){
-							devices.push_back(ofSerialDeviceInfo("/dev/"+deviceName, deviceName, deviceCount));
-							deviceCount++;
-							break;
-						}
-					}
-				}
-			}
-			closedir(dir);
-		}
+		ofSerialDeviceRegistry::getDefault().copyDevices(devices, devicesGeneration);
 
 	#endif
 
 	#ifdef TARGET_WIN32
 
+		devices.clear();
 		enumerateWin32Ports();
 		for(int i = 0; i < nPorts; i++) {
 			//NOTE: we give the short port name for both as that is what the user should pass and the short name is more friendly
@@ -246,16 +201,6 @@ void ofSerial::buildDeviceList() {
 
 	#endif
 
-	#if defined( TARGET_OSX )
-		//here we sort the device to have the aruino ones first.
-		partition(devices.begin(), devices.end(), isDeviceArduino);
-		//we are reordering the device ids. too!
-		int k = 0;
-		for(auto & device: devices){
-			device.deviceID = k++;
-		}
-	#endif
-
 	bHaveEnumeratedDevices = true;
 }
 
@@ -265,8 +210,39 @@ vector <ofSerialDeviceInfo> ofSerial::getDeviceList(){
 	return devices;
 }
 
+//----------------------------------------------------------------
+const vector <ofSerialDeviceInfo> & ofSerial::getDevices(){
+	buildDeviceList();
+	return devices;
+}
+
 //----------------------------------------------------------------
 void ofSerial::close(){
+	stopWriterThread();
+	// a write in progress on another thread keeps its staged bytes, it reports what it could not send
+	if(tryLockWriteSide()){
+		flushStaged();
+		unlockWriteSide();
+	}
+
+	// no I/O starts from here, the calls in flight are woken up and leave
+	uint64_t state = ioState.fetch_and(~ioOpen, std::memory_order_acq_rel);
+	if((state & ioOpen) != 0){
+		#ifndef TARGET_WIN32
+			const uint8_t one = 1;
+			auto unused = write(closeWakePipe[1], &one, 1);
+			(void)unused;
+		#else
+			// completes a pending WaitCommEvent()
+			SetCommMask(hComm, 0);
+		#endif
+	}
+	state &= ~ioOpen;
+	while((state & ioUserMask) != 0){
+		ioState.wait(state, std::memory_order_acquire);
+		state = ioState.load(std::memory_order_acquire);
+	}
+	stopReaderThread();
 
 	#ifdef TARGET_WIN32
 
@@ -280,11 +256,16 @@ void ofSerial::close(){
 				CloseHandle(osReader.hEvent);
 				osReader.hEvent = NULL;
 			}
+			if (osWaiter.hEvent) {
+				CloseHandle(osWaiter.hEvent);
+				osWaiter.hEvent = NULL;
+			}
 			if (hComm != INVALID_HANDLE_VALUE) {
 				CloseHandle(hComm);
 				hComm = INVALID_HANDLE_VALUE;
 			}
 			hComm = INVALID_HANDLE_VALUE;
+			ioState.store(((state >> ioEpochShift) + 1) << ioEpochShift, std::memory_order_release);
 			bInited = false;
 		}
 
@@ -293,6 +274,12 @@ void ofSerial::close(){
 		if(bInited){
 			tcsetattr(fd, TCSANOW, &oldoptions);
 			::close(fd);
+			for(int * pipeFd: {&closeWakePipe[0], &closeWakePipe[1]}){
+				::close(*pipeFd);
+				*pipeFd = -1;
+			}
+			// the descriptor number may be reused from now on, by another opening
+			ioState.store(((state >> ioEpochShift) + 1) << ioEpochShift, std::memory_order_release);
 			bInited = false;
 		}
 		// [CHECK] -- anything else need to be reset?
@@ -301,171 +288,173 @@ void ofSerial::close(){
 }
 
 //----------------------------------------------------------------
-bool ofSerial::setup(const std::string_view portName, size_t baud, size_t data, size_t parity, size_t stop) {
-	bInited = false;
+bool ofSerial::isBaudSupported(size_t baud){
+	if(baud == 0 || baud > UINT32_MAX){
+		return false;
+	}
+	#if defined( TARGET_LINUX )
+		// the other rates go through termios2 and BOTHER
+		return isStandardBaud(baud) || ofSerialHasArbitraryBaud();
+	#elif defined( TARGET_OSX ) && defined( IOSSIOSPEED )
+		return true;
+	#elif defined( TARGET_WIN32 )
+		// the DCB takes any rate
+		return true;
+	#else
+		return isStandardBaud(baud);
+	#endif
+}
 
-	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
+#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
+//----------------------------------------------------------------
+bool ofSerial::openPort(const std::string_view portName){
+	//lets account for the name being passed in instead of the device path
+	std::string portPath(portName);
+	if(portName.size() > 5 && portName.substr(0, 5) != "/dev/"){
+		portPath = "/dev/" + portPath;
+	}
 
-		//lets account for the name being passed in instead of the device path
-		if(portName.size() > 5 && portName.substr(0, 5) != "/dev/"){
-			portName = "/dev/" + portName;
-		}
+	fd = open(portPath.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if(fd == -1){
+		std::cerr << "Unable to open " << portName << std::endl << std::endl;
+		return false;
+	}
 
-		fd = open(portName.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
-		if(fd == -1){
-			std::cerr << "Unable to open " << portName << std::endl << std::endl;
-			return false;
-		}
+	if(tcgetattr(fd, &oldoptions) != 0) {
+		std::cerr <<  "Error " << errno <<" from tcgetattr: " << strerror(errno) << std::endl;
+		::close(fd);
+		fd = -1;
+		return false;
+	}
+	return true;
+}
 
-		struct termios options;
-		if(tcgetattr(fd, &oldoptions) != 0) {
-			std::cerr <<  "Error " << errno <<" from tcgetattr: " << strerror(errno) << std::endl;
-			return false;
-		}
-		options = oldoptions;
+//----------------------------------------------------------------
+bool ofSerial::applyTermios(struct termios options, speed_t speed){
+	cfsetispeed(&options, speed);
+	cfsetospeed(&options, speed);
+	if(tcsetattr(fd, TCSANOW, &options) != 0){
+		std::cerr <<  "Error " << errno <<" from tcsetattr: " << strerror(errno) << std::endl;
+		::close(fd);
+		fd = -1;
+		return false;
+	}
+	return true;
+}
+#endif
 
-		switch(baud){
-			case 300:
-				cfsetispeed(&options, B300);
-				cfsetospeed(&options, B300);
-				break;
-			case 1200:
-				cfsetispeed(&options, B1200);
-				cfsetospeed(&options, B1200);
-				break;
-			case 2400:
-				cfsetispeed(&options, B2400);
-				cfsetospeed(&options, B2400);
-				break;
-			case 4800:
-				cfsetispeed(&options, B4800);
-				cfsetospeed(&options, B4800);
-				break;
-			case 9600:
-				cfsetispeed(&options, B9600);
-				cfsetospeed(&options, B9600);
-				break;
-			case 14400:
-				cfsetispeed(&options, B14400);
-				cfsetospeed(&options, B14400);
-				break;
-			case 19200:
-				cfsetispeed(&options, B19200);
-				cfsetospeed(&options, B19200);
-				break;
-			case 28800:
-				cfsetispeed(&options, B28800);
-				cfsetospeed(&options, B28800);
-				break;
-			case 38400:
-				cfsetispeed(&options, B38400);
-				cfsetospeed(&options, B38400);
-				break;
-			case 57600:
-				cfsetispeed(&options, B57600);
-				cfsetospeed(&options, B57600);
-				break;
-			case 115200:
-				cfsetispeed(&options, B115200);
-				cfsetospeed(&options, B115200);
-				break;
-			case 230400:
-				cfsetispeed(&options, B230400);
-				cfsetospeed(&options, B230400);
-				break;
-			case 12000000: 
-				cfsetispeed(&options, 12000000);
-				cfsetospeed(&options, 12000000);	
-				break;
-			default:
-				cfsetispeed(&options, B9600);
-				cfsetospeed(&options, B9600);
-				std::cerr << "setup(): cannot set " << baud << " bps, setting to 9600" << std::endl;
-				break;
-		}
-		switch (data) {
-			case 5:
-				options.c_cflag |= CS5; // 5 bits per byte
-				break;
-			case 6:
-				options.c_cflag |= CS6; // 6 bits per byte
-				break;
-			case 7:
-				options.c_cflag |= CS7; // 7 bits per byte
-				break;
-			case 8:
-			default:
-				options.c_cflag |= CS8; // 8 bits per byte (most common)
-		}
-		switch (parity) {
-			case OF_SERIAL_PARITY_E:
-				options.c_cflag |= PARENB; // Enable parity bit
-				options.c_cflag &= ~PARODD; // Even parity (disable odd bit)
-				break;
-			case OF_SERIAL_PARITY_O:
-				options.c_cflag |= PARENB; // Enable parity bit
-				options.c_cflag |= PARODD; // Odd parity
-				break;
-			case OF_SERIAL_PARITY_N:
-			default:
-				options.c_cflag &= ~PARENB; // Clear parity bit, disabling parity (most common)
+//----------------------------------------------------------------
+bool ofSerial::publishOpened(){
+	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
+		if(pipe(closeWakePipe) != 0){
+			std::cerr << "setup(): unable to create pipe: " << strerror(errno) << std::endl;
+			tcsetattr(fd, TCSANOW, &oldoptions);
+			::close(fd);
+			fd = -1;
+			return false;
 		}
-		switch (stop) {
-			case 2:
-				options.c_cflag |= CSTOPB; // Enable stop field, two stop bit used in communication
-				break;
-			case 1:
-			default:
-				options.c_cflag &= ~CSTOPB; // Clear stop field, only one stop bit used in communication (most common)
+		for(int pipeFd: closeWakePipe){
+			fcntl(pipeFd, F_SETFL, O_NONBLOCK);
 		}
+	#endif
+	ioState.fetch_or(ioOpen, std::memory_order_release);
+	bInited = true;
+	return true;
+}
 
-		options.c_cflag &= ~CSIZE; // Clear all bits that set the data size 
-		#if defined( TARGET_LINUX )
-			options.c_cflag &= ~CRTSCTS; // Disable RTS/CTS hardware flow control (most common)
-		#endif
+#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
 
-		options.c_cflag |= CREAD | CLOCAL; // Turn on READ & ignore ctrl lines (CLOCAL = 1)
+//----------------------------------------------------------------
+bool ofSerial::setupTermios(const std::string_view portName, struct termios (*makeTermios)(struct termios), speed_t speed, size_t baud, const ofSerialProfile & newProfile){
+	close();
+	profile = newProfile;
+	metrics.reset();
 
-		#if defined( TARGET_LINUX )
-			options.c_lflag &= ~ICANON;
-			options.c_lflag &= ~ECHO; // Disable echo
-		#endif
+	if(!openPort(portName) || !applyTermios(makeTermios(oldoptions), speed)){
+		return false;
+	}
 
-		options.c_lflag &= ~ECHOE; // Disable erasure
-		options.c_lflag &= ~ECHONL; // Disable new-line echo
+	achievedBaud = baud;
+	#if defined( TARGET_LINUX )
+		const size_t reportedBaud = ofSerialGetBaud(fd);
+		if(reportedBaud != 0){
+			achievedBaud = reportedBaud;
+		}
+	#endif
+	if(achievedBaud * 50 < baud * 49 || achievedBaud * 50 > baud * 51){
+		std::cerr << "setup(): asked for " << baud << " bps, the driver applied " << achievedBaud << " bps" << std::endl;
+	}
+	setLowLatency(profile.bLowLatency);
+	bBulkReads = profile.minBytes > 1;
 
-		#if defined( TARGET_LINUX )
-			options.c_lflag &= ~ISIG; // Disable interpretation of INTR, QUIT and SUSP
-			options.c_iflag &= ~(IXON | IXOFF | IXANY); // Turn off s/w flow ctrl
-		#endif
+	return publishOpened();
+}
+#endif
 
-		options.c_iflag &= ~(IGNBRK|BRKINT|PARMRK|ISTRIP|INLCR|IGNCR|ICRNL); // Disable any special handling of received bytes
-		options.c_oflag &= ~OPOST; // Prevent special interpretation of output bytes (e.g. newline chars)
-		options.c_oflag &= ~ONLCR; // Prevent conversion of newline to carriage return/line feed
-	
-		#if defined( TARGET_OSX )
-			options.c_oflag &= ~OXTABS; // Prevent conversion of tabs to spaces (NOT PRESENT ON LINUX)
-			options.c_oflag &= ~ONOEOT; // Prevent removal of C-d chars (0x004) in output (NOT PRESENT ON LINUX)
-		#endif
-		
-		options.c_cc[VTIME] = 10;    // Wait for up to 1s (10 deciseconds), returning as soon as any data is received.
-		options.c_cc[VMIN] = 0;
+//----------------------------------------------------------------
+bool ofSerial::setup(const std::string_view portName, size_t baud, size_t data, size_t parity, size_t stop, const ofSerialProfile & newProfile) {
+	close();
+	profile = newProfile;
+	metrics.reset();
+
+	if(!isFrameLegal(data, parity, stop)){
+		std::cerr << "setup(): invalid frame, " << data << " data bits, parity " << parity << ", " << stop << " stop bits" << std::endl;
+		return false;
+	}
+
+	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
 
-		if (tcsetattr(fd, TCSANOW, &options) != 0) {
-			std::cerr <<  "Error " << errno <<" from tcsetattr: " << strerror(errno) << std::endl;
-			return 1;
+		if(!openPort(portName)){
+			return false;
 		}
-		
-		#ifdef TARGET_LINUX
-			struct serial_struct kernel_serial_settings;
-			if (ioctl(fd, TIOCGSERIAL, &kernel_serial_settings) == 0) {
-				kernel_serial_settings.flags |= ASYNC_LOW_LATENCY;
-				ioctl(fd, TIOCSSERIAL, &kernel_serial_settings);
+
+		// rates without a Bxxx constant are set with termios2 once the rest is applied
+		speed_t speed;
+		const bool bStandardBaud = ofSerialFindSpeed(baud, speed);
+		if(!bStandardBaud && !isBaudSupported(baud)){
+			std::cerr << "setup(): cannot set " << baud << " bps on this platform" << std::endl;
+			::close(fd);
+			fd = -1;
+			return false;
+		}
+		if(!applyTermios(ofSerialMakeTermios(oldoptions, data, parity, stop, profile.minBytes, profile.interByteDeciseconds), bStandardBaud ? speed : B38400)){
+			return false;
+		}
+
+		achievedBaud = baud;
+		#if defined( TARGET_LINUX )
+			if(!bStandardBaud && !ofSerialSetArbitraryBaud(fd, baud)){
+				std::cerr << "setup(): cannot set " << baud << " bps: " << strerror(errno) << std::endl;
+				tcsetattr(fd, TCSANOW, &oldoptions);
+				::close(fd);
+				fd = -1;
+				return false;
+			}
+			// drivers round to what their divisor can do, and report it
+			const size_t reportedBaud = ofSerialGetBaud(fd);
+			if(reportedBaud != 0){
+				achievedBaud = reportedBaud;
+			}
+		#elif defined( TARGET_OSX )
+			if(!bStandardBaud){
+				speed_t customSpeed = speed_t(baud);
+				if(ioctl(fd, IOSSIOSPEED, &customSpeed) == -1){
+					std::cerr << "setup(): cannot set " << baud << " bps: " << strerror(errno) << std::endl;
+					tcsetattr(fd, TCSANOW, &oldoptions);
+					::close(fd);
+					fd = -1;
+					return false;
+				}
 			}
 		#endif
+		if(achievedBaud * 50 < baud * 49 || achievedBaud * 50 > baud * 51){
+			std::cerr << "setup(): asked for " << baud << " bps, the driver applied " << achievedBaud << " bps" << std::endl;
+		}
+		
+		setLowLatency(profile.bLowLatency);
+		bBulkReads = profile.minBytes > 1;
 
-		bInited = true;
-		return true;
+		return publishOpened();
 
 	#elif defined(TARGET_WIN32)
 		std::string pn(portName.size() + 10, '\0');
@@ -492,7 +481,12 @@ bool ofSerial::setup(const std::string_view portName, size_t baud, size_t data,
 			return false;
 		}
 
-		size_t l_baud = this->isBuadLegal(baud) ? baud : 9600;
+		if (!isBaudSupported(baud)) {
+			std::cerr << "setup(): cannot set " << baud << " bps" << std::endl;
+			close();
+			return false;
+		}
+		size_t l_baud = baud;
 		size_t l_data = 8;
 		size_t l_stop = ONESTOPBIT;
 		size_t l_parity = NOPARITY;
@@ -528,6 +522,15 @@ bool ofSerial::setup(const std::string_view portName, size_t baud, size_t data,
 			return false;
 		}
 
+		// the driver keeps what its divisor can do
+		achievedBaud = l_baud;
+		if (GetCommState(hComm, &dcbSerialParams)) {
+			achievedBaud = dcbSerialParams.BaudRate;
+		}
+		if (achievedBaud * 50 < l_baud * 49 || achievedBaud * 50 > l_baud * 51) {
+			std::cerr << "setup(): asked for " << l_baud << " bps, the driver applied " << achievedBaud << " bps" << std::endl;
+		}
+
 		COMMTIMEOUTS timeouts = { 0 };
 		timeouts.ReadIntervalTimeout = MAXDWORD;
 		timeouts.ReadTotalTimeoutConstant = 0;
@@ -552,9 +555,14 @@ bool ofSerial::setup(const std::string_view portName, size_t baud, size_t data,
 			close();
 			return false;
 		}
+		osWaiter.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+		if (osWaiter.hEvent == NULL || !SetCommMask(hComm, EV_RXCHAR)) {
+			std::cerr << "setup(): error while creating the receive event" << std::endl;
+			close();
+			return false;
+		}
 		
-		bInited = true;
-		return true;
+		return publishOpened();
 
 	#else
 
@@ -571,190 +579,1069 @@ size_t ofSerial::writeBytes(const uint8_t * buffer, size_t length) {
 		return 0;
 	}
 
-	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
-		size_t written=0;
-		fd_set wfds;
-		struct timeval tv;
-
-		while (written < length) {
-			auto n = write(fd, buffer + written, length - written);
-			if (n < 0 && (errno == EAGAIN || errno == EINTR)) n = 0;
-			if (n < 0) return 0;
-			if (n > 0) {
-				written += n;
-			} else {
-				tv.tv_sec = 10;
-				tv.tv_usec = 0;
-				FD_ZERO(&wfds);
-				FD_SET(fd, &wfds);
-				n = select(fd+1, NULL, &wfds, NULL, &tv);
-				if (n < 0 && errno == EINTR) n = 1;
-				if (n <= 0) return 0;
-			}
-		}
-		return written;
-	#elif defined(TARGET_WIN32)
-
-		DWORD written;
+	// queue behind the pending async writes, unless called back from the writer thread
+	if(bWriterRunning && std::this_thread::get_id() != writerThread.get_id()){
+		WriteRequest request;
+		request.data = std::span<const uint8_t>(buffer, length);
+		auto handle = enqueueWrite(std::move(request), true);
+		handle.wait();
+		return handle.getBytesWritten();
+	}
 
-		if (!WriteFile(hComm, buffer, length, &written, &osWriter)) {
-			if (GetLastError() != ERROR_IO_PENDING) {
-				std::cerr << "writeData(): couldn't write to port" << std::endl;
-				return 0;
-			}
+	WriteSideLock lock(*this);
+	if(txCoalesceThreshold == 0){
+		return writeGather(nullptr, 0, buffer, length);
+	}
 
-			DWORD waitRes = WaitForSingleObject(osWriter.hEvent, INFINITE);
-			if (waitRes == WAIT_OBJECT_0) {
-				if (!GetOverlappedResult(hComm, &osWriter, &written, FALSE)) {
-					std::cerr << "writeData(): GetOverlappedResult error during write" << std::endl;
-					return 0;
+	// small writes are staged, the first one starts the flush timer
+	if(txStagedLength + length < txCoalesceThreshold){
+		const auto now = std::chrono::steady_clock::now();
+		const bool bFirst = txStagedLength == 0;
+		if(bFirst){
+			txFirstStagedTime = now;
 		}
-			} else {
-				std::cerr << "writeData(): WaitForSingleObject error during write" << std::endl;
-				return 0;
+		memcpy(txStaging.get() + txStagedLength, buffer, length);
+		txStagedLength += length;
+		if(now - txFirstStagedTime >= txCoalesceDelay){
+			return flushStaged() ? length : 0;
+		}
+		if(bFirst){
+			txDeadline.store((txFirstStagedTime + txCoalesceDelay).time_since_epoch().count(), std::memory_order_release);
+			if(onWriteStaged){
+				onWriteStaged(*this);
 			}
 		}
-		return written;
-
-	#else
-
-		return 0;
+		return length;
+	}
 
-	#endif
+	// the threshold is reached: staged bytes and this buffer leave together
+	const size_t staged = txStagedLength;
+	clearStaged();
+	const size_t written = writeGather(txStaging.get(), staged, buffer, length);
+	return written > staged ? written - staged : 0;
 }
 
+#ifndef TARGET_WIN32
 //----------------------------------------------------------------
-std::string ofSerial::readStringUntil(const char delimiter, const int timeout) {
-	std::stringstream l_data;
-	const clock_t l_begin_time = clock();
-	while (true) {
-		if ((static_cast<float>(clock() - l_begin_time) / CLOCKS_PER_SEC) > (timeout / 1000.0)) {
-			return l_data.str();
-		}
-		if (available()) {
-			while (available()) {
-				char l_byte = readByte();
-				if (l_byte == delimiter) {
-					return l_data.str();
-				}
-				l_data << l_byte;
-			}
+size_t ofSerial::writeSome(const uint8_t * buffer, size_t length, ofSerialWriteStatus * status){
+	if(status){
+		*status = ofSerialWriteStatus::Failed;
+	}
+	if(!bInited){
+		std::cerr << "writeSome(): serial not inited" << std::endl;
+		return 0;
+	}
+	IoGuard guard(*this);
+	if(!guard){
+		return 0;
+	}
+	const auto begin = metrics.now();
+	auto n = write(fd, buffer, length);
+	metrics.addWriteCall();
+	metrics.addWriteLatency(begin);
+	if(n < 0){
+		metrics.addError(errno);
+		if(errno != EAGAIN && errno != EINTR){
+			std::cerr << "writeSome(): couldn't write to port: " << errno << " " << strerror(errno) << std::endl;
+		} else if(status){
+			*status = ofSerialWriteStatus::Pending;
 		}
+		return 0;
+	}
+	metrics.addBytesWritten(size_t(n));
+	captureBytes(ofSerialCapture::Write, buffer, size_t(n));
+	if(status){
+		*status = size_t(n) == length ? ofSerialWriteStatus::Done : ofSerialWriteStatus::Pending;
 	}
-	return l_data.str();
+	return size_t(n);
 }
+#endif
 
-std::vector<uint8_t> ofSerial::readBytes(){
-	const size_t ava = available();
-	if(ava == 0) return {};
-	std::vector<uint8_t> bytes;
-	bytes.resize(ava);
-	readBytes(bytes.data(), ava);
-	return bytes;
+//----------------------------------------------------------------
+bool ofSerial::startWriterThread(size_t maxQueuedWrites){
+	if(!bInited){
+		std::cerr << "startWriterThread(): serial not inited" << std::endl;
+		return false;
+	}
+	if(bWriterRunning){
+		return true;
+	}
+
+	flushWrites();
+	writeQueue = std::make_unique<ofSerialMpscQueue<WriteRequest>>(std::max<size_t>(maxQueuedWrites, 1));
+	bWriterStop = false;
+	bWriterRunning = true;
+	writerThread = std::thread(&ofSerial::writerThreadLoop, this);
+	return true;
 }
 
 //----------------------------------------------------------------
-size_t ofSerial::readBytes(uint8_t * buffer, size_t length){
-	if (!bInited){
-		std::cerr << "readData(): serial not inited" << std::endl;
-		return 0;
+void ofSerial::stopWriterThread(){
+	if(!bWriterRunning){
+		return;
+	}
+	// wakes the writer thread and the producers waiting for space
+	bWriterStop = true;
+	writeQueuePushes.fetch_add(1, std::memory_order_release);
+	writeQueuePushes.notify_all();
+	writeQueuePops.fetch_add(1, std::memory_order_release);
+	writeQueuePops.notify_all();
+	if(writerThread.joinable()){
+		writerThread.join();
 	}
 
-	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
-
-		auto nRead = read(fd, buffer, length);
-		if(nRead < 0){
-			if ( errno == EAGAIN )
-				return OF_SERIAL_NO_DATA;
-			std::cerr << "readData(): couldn't read from port: " << errno << " " << strerror(errno) << std::endl;
-			return 0;
-		}
-		return nRead;
+	// producers that checked bWriterStop before it was set may still push
+	uint32_t producers;
+	while((producers = writeProducers.load(std::memory_order_acquire)) != 0){
+		writeProducers.wait(producers, std::memory_order_acquire);
+	}
+	failQueuedWrites();
+	bWriterRunning = false;
+}
 
-	#elif defined( TARGET_WIN32 )
+//----------------------------------------------------------------
+ofSerialWriteHandle ofSerial::writeAsync(std::vector<uint8_t> && data, WriteCallback onComplete){
+	WriteRequest request;
+	request.owned = std::move(data);
+	request.data = std::span<const uint8_t>(request.owned.data(), request.owned.size());
+	request.onComplete = std::move(onComplete);
+	return enqueueWrite(std::move(request), false);
+}
 
-		DWORD nRead = 0;
+//----------------------------------------------------------------
+ofSerialWriteHandle ofSerial::writeAsyncBorrowed(std::span<const uint8_t> data, WriteCallback onComplete){
+	WriteRequest request;
+	request.data = data;
+	request.onComplete = std::move(onComplete);
+	return enqueueWrite(std::move(request), false);
+}
 
+//----------------------------------------------------------------
+ofSerialWriteHandle ofSerial::enqueueWrite(WriteRequest && request, bool bWaitForSpace){
+	ofSerialWriteHandle handle;
+	if(!bWriterRunning){
+		std::cerr << "writeAsync(): writer thread not running" << std::endl;
+		return handle;
+	}
 
-		if (!ReadFile(hComm, buffer, length, &nRead, &osReader)) {
-			if (GetLastError() != ERROR_IO_PENDING) {
-				std::cerr << "readData(): couldn't read from port" << std::endl;
-				return 0;
-			} else {
-				WaitForSingleObject(osReader.hEvent, INFINITE);
-				if (GetOverlappedResult(hComm, &osReader, &nRead, FALSE)) {
-					buffer[nRead] = '\0';
-				}
+	// counted before bWriterStop is looked at, stopWriterThread() waits for the producers that missed it
+	writeProducers.fetch_add(1);
+	if(!bWriterStop){
+		handle.state = std::make_shared<ofSerialWriteHandle::State>();
+		request.state = handle.state;
+		bool bPushed = false;
+		while(true){
+			// read before trying, a pop after it changes the counter and wait() returns
+			const uint32_t pops = writeQueuePops.load(std::memory_order_acquire);
+			bPushed = writeQueue->tryPush(std::move(request));
+			if(bPushed || !bWaitForSpace || bWriterStop){
+				break;
 			}
+			writeQueuePops.wait(pops, std::memory_order_acquire);
+		}
+		if(bPushed){
+			writeQueuePushes.fetch_add(1, std::memory_order_release);
+			writeQueuePushes.notify_one();
 		} else {
-			buffer[nRead] = '\0';
+			handle.state.reset();
 		}
-
-		return nRead;
-
-	#else
-
-		std::cerr << "Not defined in this platform" << std::endl;
-		return -1;
-
-	#endif
+	}
+	writeProducers.fetch_sub(1, std::memory_order_release);
+	writeProducers.notify_all();
+	return handle;
 }
 
+//----------------------------------------------------------------
+size_t ofSerial::getWriteQueueLength() const{
+	return writeQueue ? writeQueue->size() : 0;
+}
 
 //----------------------------------------------------------------
-size_t ofSerial::readStr(std::string& buffer, size_t length) {
-	std::string str;
-	str.reserve(length + 1);
-	const auto nBytes = readBytes(reinterpret_cast<uint8_t *>(str.data()), length);
-	return nBytes;
+size_t ofSerial::getWriteQueueCapacity() const{
+	return writeQueue ? writeQueue->capacity() : 0;
 }
 
 //----------------------------------------------------------------
-int ofSerial::readByte(){
-	if(!bInited){
-		std::cerr << "readData(): serial not inited" << std::endl;
+void ofSerial::writerThreadLoop(){
+	WriteRequest batch[maxWriteSegments];
+	std::span<const uint8_t> segments[maxWriteSegments];
+
+	while(true){
+		// read before popping, a push after it changes the counter and wait() returns
+		const uint32_t pushes = writeQueuePushes.load(std::memory_order_acquire);
+		size_t count = 0;
+		while(count < maxWriteSegments && writeQueue->tryPop(batch[count])){
+			segments[count] = batch[count].data;
+			count++;
+		}
+		if(count == 0){
+			if(bWriterStop){
+				break;
+			}
+			writeQueuePushes.wait(pushes, std::memory_order_acquire);
+			continue;
+		}
+		writeQueuePops.fetch_add(1, std::memory_order_release);
+		writeQueuePops.notify_all();
+
+		// the bytes written are handed to the requests in order
+		size_t written = writeSegments(segments, count);
+		for(size_t i = 0; i < count; i++){
+			auto & request = batch[i];
+			const size_t requestWritten = std::min(written, request.data.size());
+			written -= requestWritten;
+			completeWrite(request, requestWritten);
+		}
+	}
+}
+
+//----------------------------------------------------------------
+void ofSerial::failQueuedWrites(){
+	WriteRequest request;
+	while(writeQueue->tryPop(request)){
+		completeWrite(request, 0);
+	}
+}
+
+//----------------------------------------------------------------
+void ofSerial::completeWrite(WriteRequest & request, size_t written){
+	const auto status = written == request.data.size() ? ofSerialWriteStatus::Done : ofSerialWriteStatus::Failed;
+	if(request.state){
+		std::lock_guard<std::mutex> lock(request.state->mutex);
+		request.state->bytesWritten.store(written, std::memory_order_release);
+		request.state->status.store(status, std::memory_order_release);
+		request.state->done.notify_all();
+	}
+	if(request.onComplete){
+		request.onComplete(status, written);
+	}
+	request = WriteRequest();
+}
+
+//----------------------------------------------------------------
+void ofSerial::setWriteCoalescing(size_t thresholdBytes, std::chrono::microseconds maxDelay){
+	WriteSideLock lock(*this);
+	flushStaged();
+	txCoalesceThreshold = thresholdBytes;
+	txCoalesceDelay = maxDelay;
+	txStaging = thresholdBytes > 0 ? std::make_unique<uint8_t[]>(thresholdBytes) : nullptr;
+}
+
+//----------------------------------------------------------------
+bool ofSerial::flushWrites(){
+	WriteSideLock lock(*this);
+	return flushStaged();
+}
+
+//----------------------------------------------------------------
+bool ofSerial::flushStaged(){
+	if(txStagedLength == 0){
+		return true;
+	}
+	const size_t staged = txStagedLength;
+	clearStaged();
+	if(!bInited){
+		return false;
+	}
+	return writeGather(txStaging.get(), staged, nullptr, 0) == staged;
+}
+
+//----------------------------------------------------------------
+bool ofSerial::pollWriteTimer(){
+	// a write in progress sends the staged bytes itself, or leaves them for the next try
+	if(!tryLockWriteSide()){
+		return true;
+	}
+	bool bOk = true;
+	if(txStagedLength > 0 && std::chrono::steady_clock::now() >= getWriteDeadline()){
+		bOk = flushStaged();
+	}
+	unlockWriteSide();
+	return bOk;
+}
+
+//----------------------------------------------------------------
+void ofSerial::setWriteStagedCallback(std::function<void(ofSerial & port)> onStaged){
+	WriteSideLock lock(*this);
+	onWriteStaged = std::move(onStaged);
+}
+
+//----------------------------------------------------------------
+size_t ofSerial::writeGather(const uint8_t * head, size_t headLength, const uint8_t * body, size_t bodyLength){
+	const std::span<const uint8_t> segments[2] = {
+		std::span<const uint8_t>(head, headLength),
+		std::span<const uint8_t>(body, bodyLength)
+	};
+	return writeSegments(segments, 2);
+}
+
+//----------------------------------------------------------------
+size_t ofSerial::writeSegments(const std::span<const uint8_t> * segments, size_t count){
+	IoGuard guard(*this);
+	if(!guard){
+		return 0;
+	}
+
+	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
+		struct iovec iov[maxWriteSegments];
+		int iovcnt = 0;
+		size_t length = 0;
+		for(size_t i = 0; i < count && i < maxWriteSegments; i++){
+			if(!segments[i].empty()){
+				iov[iovcnt].iov_base = const_cast<uint8_t *>(segments[i].data());
+				iov[iovcnt].iov_len = segments[i].size();
+				length += segments[i].size();
+				iovcnt++;
+			}
+		}
+
+		size_t written=0;
+		struct iovec * next = iov;
+		const int timeoutMs = int(writeTimeout.count());
+		const auto begin = metrics.now();
+
+		while (written < length) {
+			auto n = writev(fd, next, iovcnt);
+			metrics.addWriteCall();
+			if (n < 0) metrics.addError(errno);
+			if (n < 0 && (errno == EAGAIN || errno == EINTR)) n = 0;
+			if (n < 0) break;
+			if (n > 0) {
+				metrics.addBytesWritten(size_t(n));
+				written += size_t(n);
+				// skip what went out, a partial segment is resumed where it stopped
+				size_t done = size_t(n);
+				while (iovcnt > 0 && done >= next->iov_len) {
+					done -= next->iov_len;
+					next++;
+					iovcnt--;
+				}
+				if (iovcnt > 0) {
+					next->iov_base = static_cast<uint8_t *>(next->iov_base) + done;
+					next->iov_len -= done;
+				}
+			} else {
+				metrics.addWriteStall();
+				struct pollfd pfds[2] = { { fd, POLLOUT, 0 }, { closeWakePipe[0], POLLIN, 0 } };
+				n = ::poll(pfds, 2, timeoutMs);
+				if (n < 0) metrics.addError(errno);
+				if (n < 0 && errno == EINTR) n = 1;
+				if (n <= 0 || pfds[1].revents != 0) break;
+			}
+		}
+		metrics.addWriteLatency(begin);
+		if (ofSerialCapture * tap = capture.load(std::memory_order_acquire)) {
+			tap->append(ofSerialCapture::Write, segments, count, written);
+		}
+		return written;
+	#elif defined(TARGET_WIN32)
+
+		size_t written = 0;
+		const auto begin = metrics.now();
+		for (size_t i = 0; i < count; i++) {
+			const auto & segment = segments[i];
+			if (segment.empty()) {
+				continue;
+			}
+			DWORD segmentWritten = 0;
+			metrics.addWriteCall();
+			if (!WriteFile(hComm, segment.data(), DWORD(segment.size()), &segmentWritten, &osWriter)) {
+				if (GetLastError() != ERROR_IO_PENDING) {
+					std::cerr << "writeData(): couldn't write to port" << std::endl;
+					break;
+				}
+
+				metrics.addWriteStall();
+				DWORD waitRes = WaitForSingleObject(osWriter.hEvent, DWORD(writeTimeout.count()));
+				if (waitRes == WAIT_OBJECT_0) {
+					if (!GetOverlappedResult(hComm, &osWriter, &segmentWritten, FALSE)) {
+						std::cerr << "writeData(): GetOverlappedResult error during write" << std::endl;
+						break;
+					}
+				} else {
+					CancelIo(hComm);
+					std::cerr << "writeData(): WaitForSingleObject error during write" << std::endl;
+					break;
+				}
+			}
+			metrics.addBytesWritten(segmentWritten);
+			written += segmentWritten;
+		}
+		metrics.addWriteLatency(begin);
+		return written;
+
+	#else
+
+		return 0;
+
+	#endif
+}
+
+//----------------------------------------------------------------
+std::string ofSerial::readStringUntil(const char delimiter, const int timeout) {
+	if(!bInited){
+		std::cerr << "readStringUntil(): serial not inited" << std::endl;
+		return {};
+	}
+
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+	size_t scanned = 0;  // pending bytes already known not to hold the delimiter
+	std::string line;
+	while(true){
+		if(takePendingLine(delimiter, scanned, line)){
+			return line;
+		}
+		if(!waitReadable(deadline) || fillPending() == 0){
+			break;
+		}
+	}
+
+	// timed out, hand over what we have like a plain read would
+	std::string partial(reinterpret_cast<const char *>(rxPending.get() + rxPendingBegin), pendingSize());
+	rxPendingBegin = 0;
+	rxPendingEnd = 0;
+	return partial;
+}
+
+//----------------------------------------------------------------
+bool ofSerial::tryReadStringUntil(const char delimiter, std::string & line){
+	if(!bInited){
+		std::cerr << "tryReadStringUntil(): serial not inited" << std::endl;
+		return false;
+	}
+
+	size_t scanned = 0;
+	while(true){
+		if(takePendingLine(delimiter, scanned, line)){
+			return true;
+		}
+		if(fillPending() == 0){
+			return false;
+		}
+	}
+}
+
+//----------------------------------------------------------------
+bool ofSerial::takePendingLine(const char delimiter, size_t & scanned, std::string & line){
+	while(pendingSize() > scanned){
+		const uint8_t * begin = rxPending.get() + rxPendingBegin;
+		const size_t pending = pendingSize();
+		auto found = static_cast<const uint8_t *>(memchr(begin + scanned, static_cast<unsigned char>(delimiter), pending - scanned));
+		if(found == nullptr){
+			scanned = pending;
+			if(bRxDiscarding || pending > rxMaxFrameLength){
+				dropPending();
+				scanned = 0;
+			}
+			return false;
+		}
+		const size_t length = size_t(found - begin);
+		rxPendingBegin += length + 1;
+		scanned = 0;
+		if(bRxDiscarding || length > rxMaxFrameLength){
+			// the end of an oversized line
+			metrics.addBytesOversized(length);
+			bRxDiscarding = false;
+			continue;
+		}
+		line.assign(reinterpret_cast<const char *>(begin), length);
+		return true;
+	}
+	return false;
+}
+
+//----------------------------------------------------------------
+size_t ofSerial::readFrames(const ofSerialScanner & scanner, const FrameCallback & onFrame){
+	if(!bInited){
+		std::cerr << "readFrames(): serial not inited" << std::endl;
+		return 0;
+	}
+
+	size_t nFrames = 0;
+	while(true){
+		const size_t nRead = fillPending();
+		const bool bFull = rxPendingEnd == rxPendingCapacity;
+
+		size_t offsets[64];
+		size_t nOffsets;
+		do {
+			const uint8_t * begin = rxPending.get() + rxPendingBegin;
+			nOffsets = scanner.scan(begin, pendingSize(), offsets);
+			size_t frameBegin = 0;
+			for(size_t i = 0; i < nOffsets; i++){
+				const size_t length = offsets[i] - frameBegin;
+				if(bRxDiscarding || length > rxMaxFrameLength){
+					// the end of an oversized frame
+					metrics.addBytesOversized(length);
+					bRxDiscarding = false;
+				} else {
+					onFrame(begin + frameBegin, length, begin[offsets[i]]);
+					nFrames++;
+				}
+				frameBegin = offsets[i] + 1;
+			}
+			rxPendingBegin += frameBegin;
+		} while(nOffsets == std::size(offsets));
+
+		// no delimiter in sight, stop buffering the frame
+		if(pendingSize() > rxMaxFrameLength || (bRxDiscarding && pendingSize() > 0)){
+			dropPending();
+		}
+
+		// a full buffer means the device may hold more
+		if(nRead == 0 || !bFull){
+			break;
+		}
+	}
+	return nFrames;
+}
+
+//----------------------------------------------------------------
+size_t ofSerial::readFrames(ofSerialFrameDecoder & decoder, const std::function<void(std::span<const uint8_t> frame)> & onFrame){
+	if(!bInited){
+		std::cerr << "readFrames(): serial not inited" << std::endl;
+		return 0;
+	}
+
+	size_t nFrames = 0;
+	while(true){
+		const size_t nRead = fillPending();
+		const bool bFull = rxPendingEnd == rxPendingCapacity;
+		nFrames += decoder.feed(rxPending.get() + rxPendingBegin, pendingSize(), onFrame);
+		rxPendingBegin = 0;
+		rxPendingEnd = 0;
+
+		// a full buffer means the device may hold more
+		if(nRead == 0 || !bFull){
+			break;
+		}
+	}
+	return nFrames;
+}
+
+//----------------------------------------------------------------
+size_t ofSerial::readFrames(ofSerialFrameDecoder & decoder, ofSerialBufferPool & pool, const std::function<void(ofSerialBuffer frame)> & onFrame){
+	size_t nFrames = 0;
+	readFrames(decoder, [&](std::span<const uint8_t> frame){
+		ofSerialBuffer buffer = pool.acquire(frame.size());
+		if(!buffer){
+			return;
+		}
+		if(!frame.empty()){
+			memcpy(buffer.data(), frame.data(), frame.size());
+		}
+		buffer.resize(frame.size());
+		onFrame(std::move(buffer));
+		nFrames++;
+	});
+	return nFrames;
+}
+
+//----------------------------------------------------------------
+void ofSerial::setMaxFrameLength(size_t length){
+	rxMaxFrameLength = std::max<size_t>(length, 1);
+}
+
+//----------------------------------------------------------------
+size_t ofSerial::fillPending(){
+	// move the unread bytes to the front, then grow if there is still no room
+	if(rxPendingBegin > 0){
+		memmove(rxPending.get(), rxPending.get() + rxPendingBegin, pendingSize());
+		rxPendingEnd -= rxPendingBegin;
+		rxPendingBegin = 0;
+	}
+	if(rxPendingEnd == rxPendingCapacity){
+		if(rxPendingCapacity > rxMaxFrameLength){
+			return 0;
+		}
+		const size_t capacity = std::max<size_t>(4096, rxPendingCapacity * 2);
+		auto grown = std::make_unique<uint8_t[]>(capacity);
+		if(rxPendingEnd > 0){
+			memcpy(grown.get(), rxPending.get(), rxPendingEnd);
+		}
+		rxPending = std::move(grown);
+		rxPendingCapacity = capacity;
+	}
+
+	const size_t nRead = readDevice(rxPending.get() + rxPendingEnd, rxPendingCapacity - rxPendingEnd);
+	rxPendingEnd += nRead;
+	return nRead;
+}
+
+//----------------------------------------------------------------
+bool ofSerial::waitReadable(std::chrono::steady_clock::time_point deadline){
+	// the reply we are about to wait for may depend on what is still staged,
+	// unless a write is in progress on another thread, which then sends it
+	if(tryLockWriteSide()){
+		flushStaged();
+		unlockWriteSide();
+	}
+
+	IoGuard guard(*this);
+	if(!guard){
+		return false;
+	}
+
+	auto remainingMs = [&deadline](){
+		const auto remaining = deadline - std::chrono::steady_clock::now();
+		if(remaining <= std::chrono::steady_clock::duration::zero()){
+			return 0;
+		}
+		// round up so that we never wake up just before the deadline
+		return int(std::chrono::ceil<std::chrono::milliseconds>(remaining).count());
+	};
+
+	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
+
+		if(rxRing){
+			while(rxRing->empty()){
+				if(bReaderDone){
+					return false;
+				}
+				// the fence pairs with the one in the reader thread, either it
+				// sees the flag or we see the bytes it published
+				bConsumerWaiting = true;
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if(rxRing->empty() && !bReaderDone){
+					const int timeoutMs = remainingMs();
+					if(timeoutMs == 0){
+						bConsumerWaiting = false;
+						return false;
+					}
+					struct pollfd pfds[2] = { { consumerWakePipe[0], POLLIN, 0 }, { closeWakePipe[0], POLLIN, 0 } };
+					::poll(pfds, 2, timeoutMs);
+					if(pfds[1].revents != 0){
+						bConsumerWaiting = false;
+						return false;
+					}
+					uint8_t drained[64];
+					while(read(consumerWakePipe[0], drained, sizeof(drained)) > 0){}
+				}
+				bConsumerWaiting = false;
+			}
+			return true;
+		}
+
+		while(true){
+			struct pollfd pfds[2] = { { fd, POLLIN, 0 }, { closeWakePipe[0], POLLIN, 0 } };
+			struct pollfd & pfd = pfds[0];
+			const int n = ::poll(pfds, 2, remainingMs());
+			if(n > 0 && pfds[1].revents != 0){
+				return false;
+			}
+			if(n > 0){
+				if((pfd.revents & POLLIN) && profile.frameGapUs > 0){
+					waitFrameGap(deadline);
+				}
+				// a hung up device stays readable, let the read report it
+				return (pfd.revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+			}
+			if(n == 0){
+				// a bulk profile does not report tails shorter than VMIN
+				if(profile.minBytes <= 1){
+					return false;
+				}
+				int queued = 0;
+				metrics.addIoctl();
+				return ioctl(fd, FIONREAD, &queued) == 0 && queued > 0;
+			}
+			metrics.addError(errno);
+			if(errno != EINTR){
+				std::cerr << "waitReadable(): poll error: " << strerror(errno) << std::endl;
+				return false;
+			}
+		}
+
+	#elif defined( TARGET_WIN32 )
+
+		// EV_RXCHAR only reports the bytes received after the wait starts,
+		// the input queue is checked before and after arming it
+		auto queued = [this](){
+			DWORD errors = 0;
+			COMSTAT status = { 0 };
+			return ClearCommError(hComm, &errors, &status) ? status.cbInQue : 0;
+		};
+		while(queued() == 0){
+			const int timeoutMs = remainingMs();
+			if(timeoutMs == 0 || (ioState.load(std::memory_order_acquire) & ioOpen) == 0){
+				return false;
+			}
+			DWORD events = 0;
+			if(WaitCommEvent(hComm, &events, &osWaiter)){
+				continue;
+			}
+			if(GetLastError() != ERROR_IO_PENDING){
+				std::cerr << "waitReadable(): WaitCommEvent failed: " << GetLastError() << std::endl;
+				return false;
+			}
+			// close() completes the wait with SetCommMask()
+			if(queued() > 0 || WaitForSingleObject(osWaiter.hEvent, DWORD(timeoutMs)) != WAIT_OBJECT_0){
+				CancelIoEx(hComm, &osWaiter);
+			}
+			GetOverlappedResult(hComm, &osWaiter, &events, TRUE);
+		}
+		return true;
+
+	#else
+
+		while(available() == 0){
+			if(remainingMs() == 0){
+				return false;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return true;
+
+	#endif
+}
+
+#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
+//----------------------------------------------------------------
+void ofSerial::waitFrameGap(std::chrono::steady_clock::time_point deadline){
+	// the frame is over once the queue stops growing for a whole gap
+	const auto gap = std::chrono::microseconds(profile.frameGapUs);
+	int previous = -1;
+	int queued = 0;
+	while(true){
+		metrics.addIoctl();
+		if(ioctl(fd, FIONREAD, &queued) != 0 || queued == previous){
+			break;
+		}
+		const auto now = std::chrono::steady_clock::now();
+		if(now >= deadline){
+			break;
+		}
+		previous = queued;
+		std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(gap, deadline - now));
+	}
+}
+#endif
+
+//----------------------------------------------------------------
+bool ofSerial::setProfile(const ofSerialProfile & newProfile){
+	if(!bInited){
+		std::cerr << "setProfile(): serial not inited" << std::endl;
+		return false;
+	}
+
+	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
+		struct termios options;
+		if(tcgetattr(fd, &options) != 0){
+			std::cerr << "setProfile(): tcgetattr failed: " << strerror(errno) << std::endl;
+			return false;
+		}
+		options.c_cc[VMIN] = newProfile.minBytes;
+		options.c_cc[VTIME] = newProfile.interByteDeciseconds;
+		if(tcsetattr(fd, TCSANOW, &options) != 0){
+			std::cerr << "setProfile(): tcsetattr failed: " << strerror(errno) << std::endl;
+			return false;
+		}
+		setLowLatency(newProfile.bLowLatency);
+		bBulkReads = newProfile.minBytes > 1;
+	#endif
+
+	profile = newProfile;
+	return true;
+}
+
+#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
+//----------------------------------------------------------------
+void ofSerial::setLowLatency(bool bLowLatency){
+	#ifdef TARGET_LINUX
+		// only real UARTs and some USB adapters know the flag, a pty refuses it
+		struct serial_struct kernel_serial_settings;
+		metrics.addIoctl();
+		if (ioctl(fd, TIOCGSERIAL, &kernel_serial_settings) == 0) {
+			if (bLowLatency) {
+				kernel_serial_settings.flags |= int(ASYNC_LOW_LATENCY);
+			} else {
+				kernel_serial_settings.flags &= ~int(ASYNC_LOW_LATENCY);
+			}
+			metrics.addIoctl();
+			ioctl(fd, TIOCSSERIAL, &kernel_serial_settings);
+		}
+	#else
+		(void)bLowLatency;
+	#endif
+}
+#endif
+
+//----------------------------------------------------------------
+std::vector<uint8_t> ofSerial::readBytes(){
+	std::vector<uint8_t> bytes;
+	readAppend(bytes);
+	return bytes;
+}
+
+//----------------------------------------------------------------
+size_t ofSerial::readAppend(std::vector<uint8_t> & buffer, size_t maxLength){
+	const size_t length = std::min(available(), maxLength);
+	if(length == 0){
+		return 0;
+	}
+	const size_t offset = buffer.size();
+	buffer.resize(offset + length);
+	const size_t nRead = readBytes(buffer.data() + offset, length);
+	buffer.resize(offset + nRead);
+	return nRead;
+}
+
+//----------------------------------------------------------------
+size_t ofSerial::readBytes(uint8_t * buffer, size_t length){
+	if (!bInited){
+		std::cerr << "readData(): serial not inited" << std::endl;
+		return 0;
+	}
+
+	if(pendingSize() > 0){
+		const size_t nRead = std::min(length, pendingSize());
+		memcpy(buffer, rxPending.get() + rxPendingBegin, nRead);
+		rxPendingBegin += nRead;
+		return nRead;
+	}
+
+	return readDevice(buffer, length);
+}
+
+//----------------------------------------------------------------
+ofSerialReadResult ofSerial::readSome(uint8_t * buffer, size_t length, std::chrono::steady_clock::time_point deadline){
+	return readUntilDeadline(buffer, length, deadline, false);
+}
+
+//----------------------------------------------------------------
+ofSerialReadResult ofSerial::readExactly(uint8_t * buffer, size_t length, std::chrono::steady_clock::time_point deadline){
+	return readUntilDeadline(buffer, length, deadline, true);
+}
+
+//----------------------------------------------------------------
+ofSerialReadResult ofSerial::readSome(ofSerialBuffer & buffer, std::chrono::steady_clock::time_point deadline){
+	const auto unused = buffer.unused();
+	if(unused.empty()){
+		std::cerr << "readSome(): the buffer is full or empty" << std::endl;
+		ofSerialReadResult result;
+		result.status = ofSerialReadStatus::Failed;
+		result.error = ENOBUFS;
+		return result;
+	}
+	const ofSerialReadResult result = readUntilDeadline(unused.data(), unused.size(), deadline, false);
+	buffer.commit(result.bytesRead);
+	return result;
+}
+
+//----------------------------------------------------------------
+ofSerialReadResult ofSerial::readUntilDeadline(uint8_t * buffer, size_t length, std::chrono::steady_clock::time_point deadline, bool bAll){
+	ofSerialReadResult result;
+	if(!bInited){
+		std::cerr << "readSome()/readExactly(): serial not inited" << std::endl;
+		result.status = ofSerialReadStatus::Closed;
+		return result;
+	}
+
+	while(result.bytesRead < length){
+		size_t nRead;
+		if(pendingSize() > 0){
+			nRead = std::min(length - result.bytesRead, pendingSize());
+			memcpy(buffer + result.bytesRead, rxPending.get() + rxPendingBegin, nRead);
+			rxPendingBegin += nRead;
+		} else {
+			nRead = readDevice(buffer + result.bytesRead, length - result.bytesRead, &result);
+		}
+		result.bytesRead += nRead;
+		if(result.status != ofSerialReadStatus::Done || (!bAll && result.bytesRead > 0)){
+			break;
+		}
+		if(nRead > 0){
+			// more may be queued already
+			continue;
+		}
+
+		errno = 0;
+		if(!waitReadable(deadline)){
+			if((ioState.load(std::memory_order_acquire) & ioOpen) == 0){
+				result.status = ofSerialReadStatus::Closed;
+			}
+			#ifndef TARGET_WIN32
+				else if(rxRing && bReaderDone){
+					result.status = ofSerialReadStatus::Disconnected;
+				}
+			#endif
+			else if(std::chrono::steady_clock::now() >= deadline){
+				result.status = ofSerialReadStatus::Timeout;
+			} else {
+				// waitReadable() rounds its waits up, only a failed wait returns early
+				result.status = ofSerialReadStatus::Failed;
+				#ifdef TARGET_WIN32
+					result.error = int(GetLastError());
+				#else
+					result.error = errno;
+				#endif
+			}
+			break;
+		}
+	}
+	return result;
+}
+
+//----------------------------------------------------------------
+size_t ofSerial::readDevice(uint8_t * buffer, size_t length, ofSerialReadResult * result){
+	IoGuard guard(*this);
+	if(!guard){
+		if(result){
+			result->status = ofSerialReadStatus::Closed;
+		}
 		return 0;
 	}
 
+	if(rxRing){
+		const size_t nRead = rxRing->read(buffer, length);
+		releaseReaderSpace();
+		return nRead;
+	}
+
+	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
+
+		const auto begin = metrics.now();
+		auto nRead = read(fd, buffer, length);
+		metrics.addRead(nRead > 0 ? size_t(nRead) : 0, begin);
+		if(nRead < 0){
+			metrics.addError(errno);
+			if ( errno == EAGAIN || errno == EINTR )
+				return 0;
+			if(result){
+				// a pty whose master is gone reports EIO
+				result->status = errno == EIO ? ofSerialReadStatus::Disconnected : ofSerialReadStatus::Failed;
+				result->error = errno;
+			}
+			std::cerr << "readData(): couldn't read from port: " << errno << " " << strerror(errno) << std::endl;
+			return 0;
+		}
+		if(nRead == 0 && length > 0 && result){
+			// 0 is also what an empty port gives with VMIN 0, only a hang up tells them apart
+			struct pollfd pfd = { fd, POLLIN, 0 };
+			if(::poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLHUP | POLLERR)) != 0){
+				result->status = ofSerialReadStatus::Disconnected;
+			}
+		}
+		captureBytes(ofSerialCapture::Read, buffer, size_t(nRead));
+		return size_t(nRead);
+
+	#elif defined( TARGET_WIN32 )
+
+		DWORD nRead = 0;
+		const auto begin = metrics.now();
+
+		if (!ReadFile(hComm, buffer, length, &nRead, &osReader)) {
+			if (GetLastError() != ERROR_IO_PENDING) {
+				if (result) {
+					result->status = ofSerialReadStatus::Failed;
+					result->error = int(GetLastError());
+				}
+				std::cerr << "readData(): couldn't read from port" << std::endl;
+				metrics.addRead(0, begin);
+				return 0;
+			} else {
+				WaitForSingleObject(osReader.hEvent, INFINITE);
+				if (!GetOverlappedResult(hComm, &osReader, &nRead, FALSE)) {
+					if (result) {
+						result->status = ofSerialReadStatus::Failed;
+						result->error = int(GetLastError());
+					}
+					nRead = 0;
+				}
+			}
+		}
+
+		metrics.addRead(nRead, begin);
+		return nRead;
+
+	#else
+
+		std::cerr << "Not defined in this platform" << std::endl;
+		return -1;
+
+	#endif
+}
+
+
+//----------------------------------------------------------------
+size_t ofSerial::readStr(std::string& buffer, size_t length) {
+	buffer.resize(length);
+	const auto nBytes = readBytes(reinterpret_cast<uint8_t *>(buffer.data()), length);
+	buffer.resize(nBytes);
+	return nBytes;
+}
+
+//----------------------------------------------------------------
+int ofSerial::readByte(){
+	if(!bInited){
+		std::cerr << "readData(): serial not inited" << std::endl;
+		return OF_SERIAL_ERROR;
+	}
+
+	if(pendingSize() > 0){
+		return rxPending[rxPendingBegin++];
+	}
+
+	IoGuard guard(*this);
+	if(!guard){
+		return OF_SERIAL_NO_DATA;
+	}
+
+	if(rxRing){
+		const int byte = rxRing->readByte();
+		if(byte < 0){
+			return OF_SERIAL_NO_DATA;
+		}
+		releaseReaderSpace();
+		return byte;
+	}
+
 	unsigned char tmpByte = 0;
 
 	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
 
-		int nRead = read(fd, &tmpByte, 1);
+		const auto begin = metrics.now();
+		int nRead = int(read(fd, &tmpByte, 1));
+		metrics.addRead(nRead > 0 ? size_t(nRead) : 0, begin);
 		if(nRead < 0){
+			metrics.addError(errno);
 			if ( errno == EAGAIN ){
 				return OF_SERIAL_NO_DATA;
 			}
 			std::cerr << "readData(): couldn't read from port: " << errno << " " << strerror(errno) << std::endl;
-			return 0;
+			return OF_SERIAL_ERROR;
 		}
 
 		if(nRead == 0){
 			return OF_SERIAL_NO_DATA;
 		}
+		captureBytes(ofSerialCapture::Read, &tmpByte, 1);
 
 	#elif defined( TARGET_WIN32 )
 
-		DWORD nRead;
+		DWORD nRead = 0;
+		const auto begin = metrics.now();
 
 		if (!ReadFile(hComm, &tmpByte, 1, &nRead, &osReader)) {
 			if (GetLastError() != ERROR_IO_PENDING) {
 				std::cerr << "readData(): couldn't read from port" << std::endl;
-				return 0;
+				metrics.addRead(0, begin);
+				return OF_SERIAL_ERROR;
 			} else {
 				WaitForSingleObject(osReader.hEvent, INFINITE);
 				GetOverlappedResult(hComm, &osReader, &nRead, FALSE);
 			}
 		}
+		metrics.addRead(nRead, begin);
 	
 		if(nRead == 0){
-			return 0;
+			return OF_SERIAL_NO_DATA;
 		}
 
 	#else
 
 		std::cerr << "Not defined in this platform" << std::endl;
-		return 0;
+		return OF_SERIAL_ERROR;
 
 	#endif
 
@@ -768,8 +1655,46 @@ void ofSerial::flush(bool flushIn, bool flushOut){
 		std::cerr << "flush(): serial not inited" << std::endl;
 		return;
 	}
+	IoGuard guard(*this);
+	if(!guard){
+		return;
+	}
+
+	if(flushIn){
+		metrics.addBytesDropped(pendingSize());
+		rxPendingBegin = 0;
+		rxPendingEnd = 0;
+		bRxDiscarding = false;
+	}
+	if(flushOut){
+		WriteSideLock lock(*this);
+		metrics.addBytesDropped(txStagedLength);
+		clearStaged();
+	}
+	if(flushIn && rxRing){
+		metrics.addBytesDropped(rxRing->size());
+		rxRing->discard();
+		releaseReaderSpace();
+	}
 
 	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
+		#if OF_SERIAL_METRICS
+			// what the kernel still holds is lost as well
+			int queued = 0;
+			if(flushIn && !rxRing){
+				metrics.addIoctl();
+				if(ioctl(fd, FIONREAD, &queued) == 0 && queued > 0){
+					metrics.addBytesDropped(size_t(queued));
+				}
+			}
+			if(flushOut){
+				metrics.addIoctl();
+				if(ioctl(fd, TIOCOUTQ, &queued) == 0 && queued > 0){
+					metrics.addBytesDropped(size_t(queued));
+				}
+			}
+		#endif
+
 		int flushType = 0;
 		if(flushIn && flushOut) flushType = TCIOFLUSH;
 		else if(flushIn) flushType = TCIFLUSH;
@@ -785,6 +1710,13 @@ void ofSerial::flush(bool flushIn, bool flushOut){
 		else if(flushOut) flushType = PURGE_TXCLEAR;
 		else return;
 
+		#if OF_SERIAL_METRICS
+			COMSTAT stat;
+			DWORD err;
+			if (ClearCommError(hComm, &err, &stat)) {
+				metrics.addBytesDropped((flushIn ? stat.cbInQue : 0) + (flushOut ? stat.cbOutQue : 0));
+			}
+		#endif
 		PurgeComm(hComm, flushType);
 
 	#endif
@@ -796,9 +1728,14 @@ void ofSerial::drain(){
 		return;
 	}
 
+	flushWrites();
+
 	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
 
-		tcdrain(fd);
+		IoGuard guard(*this);
+		if(guard){
+			tcdrain(fd);
+		}
 
 	#endif
 }
@@ -809,12 +1746,24 @@ size_t ofSerial::available(){
 		std::cerr << "available(): serial not inited" << std::endl;
 		return 0;
 	}
+	IoGuard guard(*this);
+	if(!guard){
+		return pendingSize();
+	}
 
-	size_t numBytes = 0;
+	if(rxRing){
+		return pendingSize() + rxRing->size();
+	}
+
+	size_t numBytes = pendingSize();
 
 	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
 
-		ioctl(fd, FIONREAD, &numBytes);
+		int queued = 0;
+		metrics.addIoctl();
+		if(ioctl(fd, FIONREAD, &queued) == 0 && queued > 0){
+			numBytes += size_t(queued);
+		}
 
 	#endif
 
@@ -822,15 +1771,9 @@ size_t ofSerial::available(){
 
 		COMSTAT stat;
 		DWORD err;
-		if(hComm!=INVALID_HANDLE_VALUE){
-			if(!ClearCommError(hComm, &err, &stat)){
-				numBytes = 0;
-			} else {
-				numBytes = stat.cbInQue;
-			}
-		 } else {
-			numBytes = 0;
-		 }
+		if(hComm!=INVALID_HANDLE_VALUE && ClearCommError(hComm, &err, &stat)){
+			numBytes += stat.cbInQue;
+		}
 
 	#endif
 
@@ -840,3 +1783,164 @@ size_t ofSerial::available(){
 bool ofSerial::isInitialized() const{
 	return bInited;
 }
+
+//-------------------------------------------------------------
+bool ofSerial::startReaderThread(size_t ringCapacity){
+	if(!bInited){
+		std::cerr << "startReaderThread(): serial not inited" << std::endl;
+		return false;
+	}
+	if(rxRing){
+		return true;
+	}
+
+	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
+
+		if(pipe(readerWakePipe) != 0){
+			std::cerr << "startReaderThread(): unable to create pipe: " << strerror(errno) << std::endl;
+			return false;
+		}
+		if(pipe(consumerWakePipe) != 0){
+			std::cerr << "startReaderThread(): unable to create pipe: " << strerror(errno) << std::endl;
+			::close(readerWakePipe[0]);
+			::close(readerWakePipe[1]);
+			return false;
+		}
+		for(int pipeFd: {readerWakePipe[0], readerWakePipe[1], consumerWakePipe[0], consumerWakePipe[1]}){
+			fcntl(pipeFd, F_SETFL, O_NONBLOCK);
+		}
+
+		rxRing = std::make_unique<ofSerialRingBuffer>(ringCapacity);
+		bReaderStop = false;
+		bReaderStalled = false;
+		bReaderDone = false;
+		bConsumerWaiting = false;
+		readerThread = std::thread(&ofSerial::readerThreadLoop, this);
+		return true;
+
+	#else
+
+		(void)ringCapacity;
+		std::cerr << "startReaderThread(): not implemented in this platform" << std::endl;
+		return false;
+
+	#endif
+}
+
+//-------------------------------------------------------------
+void ofSerial::stopReaderThread(){
+	if(!rxRing){
+		return;
+	}
+
+	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
+
+		bReaderStop = true;
+		wakeReaderThread();
+		if(readerThread.joinable()){
+			readerThread.join();
+		}
+		for(int * pipeFd: {&readerWakePipe[0], &readerWakePipe[1], &consumerWakePipe[0], &consumerWakePipe[1]}){
+			::close(*pipeFd);
+			*pipeFd = -1;
+		}
+
+	#endif
+
+	rxRing.reset();
+}
+
+//-------------------------------------------------------------
+void ofSerial::releaseReaderSpace(){
+	#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(bReaderStalled.load(std::memory_order_relaxed)){
+			wakeReaderThread();
+		}
+	#endif
+}
+
+#if defined( TARGET_OSX ) || defined( TARGET_LINUX )
+
+//-------------------------------------------------------------
+void ofSerial::wakeReaderThread(){
+	const uint8_t one = 1;
+	auto unused = write(readerWakePipe[1], &one, 1);
+	(void)unused;
+}
+
+//-------------------------------------------------------------
+void ofSerial::readerThreadLoop(){
+	struct pollfd fds[2];
+	fds[0].fd = fd;
+	fds[0].events = POLLIN;
+	fds[1].fd = readerWakePipe[0];
+	fds[1].events = POLLIN;
+	fds[0].revents = 0;
+	fds[1].revents = 0;
+
+	while(!bReaderStop){
+		auto region = rxRing->writableRegion();
+		if(region.empty()){
+			// the ring is full: sleep until the consumer frees some space. The
+			// fence pairs with the one in the consumer, either it sees the flag
+			// or we see the space it released.
+			bReaderStalled = true;
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if(rxRing->freeSpace() == 0 && !bReaderStop){
+				::poll(&fds[1], 1, -1);
+			}
+			bReaderStalled = false;
+		} else {
+			// a bulk profile does not report tails shorter than VMIN, pick them up on timeout
+			const int nReady = ::poll(fds, 2, bBulkReads ? bulkTailTimeoutMs : -1);
+			if(nReady < 0){
+				metrics.addError(errno);
+				if(errno != EINTR){
+					std::cerr << "readerThread(): poll error: " << strerror(errno) << std::endl;
+					break;
+				}
+			}
+			if((fds[0].revents & POLLIN) || nReady == 0){
+				const auto begin = metrics.now();
+				auto n = read(fd, region.data(), region.size());
+				metrics.addRead(n > 0 ? size_t(n) : 0, begin);
+				if(n < 0){
+					metrics.addError(errno);
+				}
+				if(n > 0){
+					captureBytes(ofSerialCapture::Read, region.data(), size_t(n));
+					rxRing->commitWrite(size_t(n));
+					// pairs with the fence in waitReadable()
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					if(bConsumerWaiting.load(std::memory_order_relaxed)){
+						const uint8_t one = 1;
+						auto unused = write(consumerWakePipe[1], &one, 1);
+						(void)unused;
+					}
+				} else if(n < 0 && errno != EAGAIN && errno != EINTR){
+					std::cerr << "readerThread(): couldn't read from port: " << errno << " " << strerror(errno) << std::endl;
+					break;
+				} else if(n == 0 && (fds[0].revents & (POLLHUP | POLLERR))){
+					// a hung up tty stays readable and reads 0 bytes forever
+					break;
+				}
+			} else if(fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)){
+				// the device went away, what is in the ring can still be read
+				break;
+			}
+		}
+
+		if(fds[1].revents & POLLIN){
+			uint8_t drained[64];
+			while(read(readerWakePipe[0], drained, sizeof(drained)) > 0){}
+		}
+	}
+
+	bReaderDone = true;
+	const uint8_t one = 1;
+	auto unused = write(consumerWakePipe[1], &one, 1);
+	(void)unused;
+}
+
+#endif
@@ -23,6 +23,7 @@
 #include <cstdint>
 #include <ctime>
 #include <algorithm>
+#include <array>
 
 #if defined( __WIN32__ ) || defined( _WIN32 )
 	#define TARGET_WIN32
@@ -40,17 +41,38 @@
 	#define MAX_SERIAL_PORTS 256
 #endif
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <string>
 
+#include "ofSerialCapture.h"
+#include "ofSerialMetrics.h"
+#include "ofSerialMpscQueue.h"
+#include "ofSerialRingBuffer.h"
+#include "ofSerialScanner.h"
+
 
 #define OF_SERIAL_PARITY_N	0
 #define OF_SERIAL_PARITY_O	1
 #define OF_SERIAL_PARITY_E	2
 
+#define OF_SERIAL_NO_DATA	-2
+#define OF_SERIAL_ERROR		-1
+
+class ofSerialBuffer;
+class ofSerialBufferPool;
+class ofSerialFrameDecoder;
+
 /// \brief Describes a Serial device, including ID, name and path.
 class ofSerialDeviceInfo{
 	friend class ofSerial;
+	friend class ofSerialDeviceRegistry;
 
 	public:
 		/// \brief Construct an ofSerialDeviceInfo with parameters.
@@ -111,6 +133,152 @@ class ofSerialDeviceInfo{
 		/// \endcond
 };
 
+/// \brief How a port trades read latency for fewer wake ups, see ofSerial::setProfile().
+///
+/// Ports are opened non blocking, so the termios VMIN/VTIME pair only acts
+/// through poll(): the tty reports the port readable once VMIN bytes are
+/// queued when VTIME is 0. Every wait of ofSerial (readStringUntil(), the
+/// reactors, the reader thread) follows the profile.
+///
+/// ~~~~{.cpp}
+/// serial.setup("/dev/ttyUSB0", 3000000, 8, OF_SERIAL_PARITY_N, 1, ofSerialProfile::bulk());
+/// serial.setProfile(ofSerialProfile::frameGap(std::chrono::microseconds(1750))); // Modbus RTU at 19200
+/// ~~~~
+struct ofSerialProfile {
+	enum Kind: uint8_t {
+		LowLatency,  ///< \brief Wake up on every byte, ASYNC_LOW_LATENCY on.
+		Bulk,  ///< \brief Wake up once minBytes are queued, ASYNC_LOW_LATENCY off.
+		FrameGap  ///< \brief Waits end once the line has been quiet for frameGapUs.
+	};
+
+	Kind kind = LowLatency;
+	uint8_t minBytes = 1;  ///< \brief VMIN, the number of queued bytes that makes the port readable.
+	uint8_t interByteDeciseconds = 0;  ///< \brief VTIME, only seen by blocking reads.
+	bool bLowLatency = true;  ///< \brief Ask the driver for ASYNC_LOW_LATENCY (real UARTs and some USB adapters).
+	uint32_t frameGapUs = 0;  ///< \brief Quiet time ending a frame, 0 for none.
+
+	/// \brief The default: every byte wakes the reader up as soon as the driver hands it over.
+	static constexpr ofSerialProfile lowLatency(){
+		return {};
+	}
+
+	/// \brief Batches reads: the port only becomes readable once 'minBytes' are queued.
+	///
+	/// A tail shorter than minBytes is read when a wait times out, or when more
+	/// data arrives. Keep minBytes at 64 or below on Linux: above that the tty
+	/// layer hands each read() over in 64 bytes pieces.
+	static constexpr ofSerialProfile bulk(uint8_t minBytes = 64){
+		return { Bulk, minBytes, 0, false, 0 };
+	}
+
+	/// \brief Waits end once no byte arrived for 'gap' after the first one.
+	///
+	/// Made for protocols delimited by silence, such as Modbus RTU (3.5 characters).
+	/// The tty holds up to 4 KiB, longer frames are cut.
+	static constexpr ofSerialProfile frameGap(std::chrono::microseconds gap){
+		const auto us = gap.count() > 0 ? uint32_t(gap.count()) : 1u;
+		const uint32_t deciseconds = (us + 99999) / 100000;
+		return { FrameGap, 1, uint8_t(deciseconds < 255 ? deciseconds : 255), false, us };
+	}
+
+	/// \returns "low-latency", "bulk" or "frame-gap".
+	const char * getName() const{
+		return kind == Bulk ? "bulk" : kind == FrameGap ? "frame-gap" : "low-latency";
+	}
+};
+
+/// \brief Matches the configurations ofSerial::setup() takes as a type, see ofSerialConfig.
+template<class Config>
+concept ofSerialConfigType = Config::isSerialConfig;
+
+/// \brief Outcome of an asynchronous write, see ofSerial::writeAsync().
+enum class ofSerialWriteStatus {
+	Pending,  ///< \brief Queued or being written.
+	Done,  ///< \brief Every byte was written.
+	Failed,  ///< \brief The port failed or timed out before the end of the buffer.
+	Rejected  ///< \brief The queue was full, or the writer thread is not running.
+};
+
+/// \brief Future-like handle on an asynchronous write.
+///
+/// Handles are cheap to copy, they all refer to the same request. A rejected
+/// request gets an empty handle whose status is ofSerialWriteStatus::Rejected.
+class ofSerialWriteHandle {
+	friend class ofSerial;
+
+	public:
+		/// \returns The current status of the request.
+		ofSerialWriteStatus getStatus() const{
+			return state ? state->status.load(std::memory_order_acquire) : ofSerialWriteStatus::Rejected;
+		}
+
+		/// \returns true once the request is no longer pending.
+		bool isDone() const{
+			return getStatus() != ofSerialWriteStatus::Pending;
+		}
+
+		/// \brief Blocks until the request is complete.
+		/// \returns The final status.
+		ofSerialWriteStatus wait() const{
+			if(state){
+				std::unique_lock<std::mutex> lock(state->mutex);
+				state->done.wait(lock, [this](){ return isDone(); });
+			}
+			return getStatus();
+		}
+
+		/// \brief Blocks until the request is complete or 'timeout' passed.
+		/// \returns true if the request is complete.
+		bool waitFor(std::chrono::milliseconds timeout) const{
+			if(state){
+				std::unique_lock<std::mutex> lock(state->mutex);
+				state->done.wait_for(lock, timeout, [this](){ return isDone(); });
+			}
+			return isDone();
+		}
+
+		/// \returns The number of bytes written, valid once the request is done.
+		size_t getBytesWritten() const{
+			return state ? state->bytesWritten.load(std::memory_order_acquire) : 0;
+		}
+
+	protected:
+		/// \cond INTERNAL
+		struct State {
+			std::mutex mutex;
+			std::condition_variable done;
+			std::atomic<ofSerialWriteStatus> status{ofSerialWriteStatus::Pending};
+			std::atomic<size_t> bytesWritten{0};
+		};
+
+		std::shared_ptr<State> state;
+		/// \endcond
+};
+
+/// \brief Outcome of ofSerial::readSome() and ofSerial::readExactly().
+enum class ofSerialReadStatus {
+	Done,  ///< \brief readSome() got at least one byte, readExactly() all of them.
+	Timeout,  ///< \brief The deadline passed first.
+	Closed,  ///< \brief The port is not opened, or close() was called while waiting.
+	Disconnected,  ///< \brief The device hung up, e.g. an unplugged USB adapter.
+	Failed  ///< \brief The device or the wait reported an error, see ofSerialReadResult::error.
+};
+
+/// \brief What a blocking read did.
+///
+/// Whatever the status, the first bytesRead bytes of the caller buffer hold
+/// what was read, e.g. the head of a frame that timed out.
+struct ofSerialReadResult {
+	ofSerialReadStatus status = ofSerialReadStatus::Done;
+	size_t bytesRead = 0;
+	int error = 0;  ///< \brief errno, or GetLastError() on Windows, when the status is Failed.
+
+	/// \returns true if the status is Done.
+	explicit operator bool() const{
+		return status == ofSerialReadStatus::Done;
+	}
+};
+
 /// \brief ofSerial provides a cross platform system for interfacing with the
 /// serial port. You can choose the port and baud rate, and then read and send
 /// data. Please note that the port must be set manually in the code, so you
@@ -128,6 +296,32 @@ class ofSerialDeviceInfo{
 /// // Open the first device and talk to it at 57600 baud
 /// serial.setup(0, 57600);
 /// ~~~~
+///
+/// \section Threads
+///
+/// On OSX and Linux a port has a read side and a write side, each used by
+/// one thread at a time, and the two run concurrently without any lock:
+/// - read side: available(), readBytes(), readByte(), readStringUntil(),
+///   readFrames(), flush(true, false)...
+/// - write side: writeBytes(), writeSome(), flushWrites(), pollWriteTimer(),
+///   drain(), flush(false, true), setWriteCoalescing().
+///
+/// The only place where they meet is the flush of coalesced bytes before a
+/// read blocks: the read side sends them only if no write is in progress,
+/// otherwise the writer does. To write from several threads, start the
+/// writer thread: writeAsync() and writeBytes() then push on a lock-free
+/// multi-producer queue.
+///
+/// close() may be called from any thread while I/O is in flight. It marks
+/// the port closed, wakes the calls waiting on it, which return as if the
+/// device had nothing more, and waits for them to leave before closing the
+/// file descriptor, so that a call never reaches another file that reused
+/// its number. getEpoch() changes at each close(), it tells whether a
+/// descriptor from getFileDescriptor() still refers to the same opening.
+///
+/// setup(), setProfile(), startReaderThread(), startWriterThread() and the
+/// other settings must not run concurrently with I/O. On Windows the port
+/// must be used from one thread at a time.
 class ofSerial {
 
 public:
@@ -149,6 +343,13 @@ public:
 	/// devicePath, deviceName, deviceID set.
 	std::vector <ofSerialDeviceInfo> getDeviceList();
 
+	/// \brief Same list as getDeviceList() without the copy.
+	///
+	/// On OSX and Linux it comes from ofSerialDeviceRegistry and is only
+	/// copied when a device came or went. The reference stays valid until
+	/// the next call on this ofSerial.
+	const std::vector <ofSerialDeviceInfo> & getDevices();
+
 	/// \}
 	/// \name Serial Connection
 	/// \{
@@ -166,9 +367,14 @@ public:
 	/// ofSerial mySerial;
 	/// mySerial.setup("COM4", 57600);
 	/// ~~~~
-	bool setup(const std::string_view portName, size_t baudrate = 9600, size_t data = 8, size_t parity = OF_SERIAL_PARITY_N, size_t stop = 1);
-	bool setup(const std::string portName, size_t baudrate = 9600, size_t data = 8, size_t parity = OF_SERIAL_PARITY_N, size_t stop = 1){
-		return setup(std::string_view(portName), baudrate, data, parity, stop);
+	///
+	/// Any rate isBaudSupported() accepts can be used, Linux and Windows take
+	/// arbitrary rates such as 2000000 or 12000000. setup() fails rather than
+	/// falling back to another rate, and warns if the driver applied a rate
+	/// more than 2% away from the requested one, see getBaudRate().
+	bool setup(const std::string_view portName, size_t baudrate = 9600, size_t data = 8, size_t parity = OF_SERIAL_PARITY_N, size_t stop = 1, const ofSerialProfile & profile = ofSerialProfile::lowLatency());
+	bool setup(const std::string portName, size_t baudrate = 9600, size_t data = 8, size_t parity = OF_SERIAL_PARITY_N, size_t stop = 1, const ofSerialProfile & profile = ofSerialProfile::lowLatency()){
+		return setup(std::string_view(portName), baudrate, data, parity, stop, profile);
 	}
 
 	/// \brief Opens the serial port based on the order in which is listed and
@@ -179,17 +385,117 @@ public:
 	/// ofSerial mySerial;
 	/// mySerial.setup(0, 9600);
 	/// ~~~~
-	bool setup(size_t deviceNumber = 0, size_t baudrate = 9600, size_t data = 8, size_t parity = OF_SERIAL_PARITY_N, size_t stop = 1){
+	bool setup(size_t deviceNumber = 0, size_t baudrate = 9600, size_t data = 8, size_t parity = OF_SERIAL_PARITY_N, size_t stop = 1, const ofSerialProfile & profile = ofSerialProfile::lowLatency()){
 		buildDeviceList();
 		if(deviceNumber < (int)devices.size()){
-			return setup(devices[deviceNumber].devicePath, baudrate, data, parity, stop);
+			return setup(devices[deviceNumber].devicePath, baudrate, data, parity, stop, profile);
 		} else {
 			return false;
 		}
 	}
 
+	/// \brief Opens the serial port with a configuration checked at compile time.
+	///
+	/// ~~~~{.cpp}
+	/// using Sensor = ofSerialConfig<115200, 8, OF_SERIAL_PARITY_E>;
+	/// mySerial.setup("/dev/ttyUSB0", Sensor{});
+	/// ~~~~
+	///
+	/// The frame is validated at compile time, see ofSerialConfig, so the
+	/// port is configured with a single tcsetattr() and no runtime validation.
+	template<ofSerialConfigType Config>
+	bool setup(const std::string_view portName, Config = {}){
+		#ifndef TARGET_WIN32
+			return setupTermios(portName, &Config::apply, Config::speed, Config::baud, Config::profile);
+		#else
+			return setup(portName, Config::baud, Config::data, Config::parity, Config::stop, Config::profile);
+		#endif
+	}
+
 	bool isInitialized() const;
 
+	/// \brief Number of times the port was closed, see the Threads section.
+	uint32_t getEpoch() const{
+		return uint32_t(ioState.load(std::memory_order_acquire) >> ioEpochShift);
+	}
+
+	/// \returns true if setup() accepts this frame: 5 to 8 data bits, a known parity, 1 or 2 stop bits.
+	static constexpr bool isFrameLegal(size_t data, size_t parity, size_t stop){
+		return data >= 5 && data <= 8
+			&& (parity == OF_SERIAL_PARITY_N || parity == OF_SERIAL_PARITY_E || parity == OF_SERIAL_PARITY_O)
+			&& (stop == 1 || stop == 2);
+	}
+
+	/// \brief Rates with a termios constant (Bxxx) on Linux.
+	///
+	/// Other POSIX systems have the most common of them, Linux and Windows also
+	/// set rates that are not in the table.
+	static constexpr std::array<size_t, 30> standardBauds = {
+		50, 75, 110, 134, 150, 200, 300, 600, 1200, 1800, 2400, 4800, 9600,
+		19200, 38400, 57600, 115200, 230400, 460800, 500000, 576000, 921600,
+		1000000, 1152000, 1500000, 2000000, 2500000, 3000000, 3500000, 4000000
+	};
+
+	/// \returns true if 'baud' is one of standardBauds.
+	static constexpr bool isStandardBaud(size_t baud){
+		return std::find(standardBauds.begin(), standardBauds.end(), baud) != standardBauds.end();
+	}
+
+	/// \brief Tells if setup() can ask the driver for a rate on this platform.
+	///
+	/// Standard rates always can, other ones need termios2 and BOTHER on Linux,
+	/// IOSSIOSPEED on OSX, or Windows. The device may still refuse a rate, or
+	/// apply an approximation, see getBaudRate().
+	static bool isBaudSupported(size_t baud);
+
+	/// \returns The rate reported by the driver after setup(), 0 if unknown or not opened.
+	size_t getBaudRate() const{
+		return bInited ? achievedBaud : 0;
+	}
+
+	/// \brief Switches the I/O profile of an opened port, nothing is lost.
+	///
+	/// On Windows the profile is only recorded.
+	/// \returns false if the port is not opened or the tty refused the settings.
+	bool setProfile(const ofSerialProfile & profile);
+
+	const ofSerialProfile & getProfile() const{
+		return profile;
+	}
+
+	/// \brief Counters and latency histograms of this port since setup() or resetMetrics().
+	///
+	/// Safe to call from any thread while the port is used. All zeros when
+	/// the library is built with OF_SERIAL_METRICS=0.
+	ofSerialMetricsSnapshot getMetrics() const{
+		return metrics.snapshot();
+	}
+
+	void resetMetrics(){
+		metrics.reset();
+	}
+
+	/// \brief Appends every byte read from or written to the device to 'capture'.
+	///
+	/// The bytes are recorded where they cross the device, by the reader and
+	/// writer threads when they run. The capture must stay opened until it
+	/// is detached with setCapture(nullptr). Not supported on Windows.
+	void setCapture(ofSerialCapture * capture){
+		this->capture.store(capture, std::memory_order_release);
+	}
+
+#ifndef TARGET_WIN32
+	/// \brief Gets the file descriptor of the opened port.
+	///
+	/// This is meant for event loops such as ofSerialReactor which need to
+	/// wait on many ports at once. Do not close it yourself, use close().
+	///
+	/// \returns the file descriptor, or -1 when the port is not opened.
+	int getFileDescriptor() const{
+		return bInited ? fd : -1;
+	}
+#endif
+
 	/// \brief Closes the connection to the serial device.
 	void close();
 
@@ -203,7 +509,7 @@ public:
 	///
 	/// ~~~~{.cpp}
 	/// if(device.available() > 8) {
-	///	 device.readData(buffer, 8);
+	///	 device.readBytes(buffer, 8);
 	/// }
 	/// ~~~~
 	///
@@ -211,51 +517,28 @@ public:
 	/// is going to be.
 	size_t available();
 
-	/// \brief Reads 'length' bytes from the connected serial device.
+	/// \brief Reads at most 'length' bytes from the connected serial device,
+	/// without waiting.
 	///
-	/// In some cases it may read less than 'length' bytes, so for reliable
-	/// reading of >1 bytes of data the return value must be checked against the
-	/// number of bytes requested, and if fewer bytes than requested were read
-	/// then the call must be tried again.
-	///
-	/// This function should only be called when Serial.available() is reporting
-	/// >0 bytes available.
-	///
-	/// An example of how to reliably read 8 bytes:
+	/// It may read less than 'length' bytes, and returns 0 when nothing is
+	/// queued or on error. To wait for the data, use readSome() or
+	/// readExactly() rather than a loop on available():
 	/// ~~~~{.cpp}
 	/// // we want to read 8 bytes
-	/// int bytesRequired = 8;
-	/// unsigned char bytes[bytesRequired];
-	/// int bytesRemaining = bytesRequired;
-	/// // loop until we've read everything
-	/// while ( bytesRemaining > 0 ){
-	///	 // check for data
-	///	 if ( serial.available() > 0 ){
-	///		 // try to read - note offset into the bytes[] array, this is so
-	///		 // that we don't overwrite the bytes we already have
-	///		 int bytesArrayOffset = bytesRequired - bytesRemaining;
-	///		 int result = serial.readData( &bytes[bytesArrayOffset], bytesRemaining );
-	///
-	///		 // check for error code
-	///		 if ( result == OF_SERIAL_ERROR ){
-	///			 // something bad happened
-	///			 ofLog( OF_LOG_ERROR, "unrecoverable error reading from serial" );
-	///			 break;
-	///		 } else if ( result == OF_SERIAL_NO_DATA ){
-	///			 // nothing was read, try again
-	///		 } else {
-	///			 // we read some data!
-	///			 bytesRemaining -= result;
-	///		 }
-	///	 }
+	/// uint8_t bytes[8];
+	/// auto result = serial.readExactly(bytes, sizeof(bytes), std::chrono::steady_clock::now() + std::chrono::seconds(1));
+	/// if ( result.status == ofSerialReadStatus::Timeout ){
+	///	 // only result.bytesRead bytes came in time
+	/// } else if ( !result ){
+	///	 // closed, unplugged or failed
 	/// }
 	/// ~~~~
-	/// \returns The number of byte readed. If there is no data it will return
-	/// `OF_SERIAL_NO_DATA`, and on error it returns `OF_SERIAL_ERROR`
+	/// \returns The number of bytes read.
 	///
-	/// Single byte
+	/// readByte() returns the single byte as integer. If there is no data it
+	/// returns `OF_SERIAL_NO_DATA`:
 	/// ~~~~{.cpp}
-	/// int myByte = mySerial.readData();
+	/// int myByte = mySerial.readByte();
 	///
 	/// if ( myByte == OF_SERIAL_NO_DATA ){
 	///	 printf("no data was read");
@@ -264,19 +547,164 @@ public:
 	/// } else {
 	///	 printf("myByte is %d", myByte);
 	/// }
-	/// \returns The single byte as integer. If there is no data it will return
-	/// `OF_SERIAL_NO_DATA`, and on error it returns `OF_SERIAL_ERROR`
 	/// ~~~~
 	///
 	/// Be aware that the type of your buffer can only be unsigned char. If you're
 	/// trying to receieve ints or signed chars over a serial connection you'll
 	/// need to do some bit manipulation to correctly interpret that values.
+	///
+	/// readStringUntil() returns the bytes received before 'delimiter', which is
+	/// dropped. It sleeps in poll() until data arrives, reads in bulk and keeps
+	/// whatever followed the delimiter for the next read call. If 'timeout'
+	/// milliseconds (wall time) pass first, the bytes received so far are
+	/// returned.
 	std::string readStringUntil(const char delimiter, const int timeout = 1000);
+
+	/// \brief Non blocking readStringUntil(), for event loops.
+	///
+	/// Reads what is queued and, if a delimiter was received, moves the bytes
+	/// before it to 'line'. Otherwise nothing is consumed.
+	/// \returns true if 'line' was filled.
+	bool tryReadStringUntil(const char delimiter, std::string & line);
 	size_t readBytes(uint8_t* buffer, size_t length);
+
+	/// \brief Reads at most 'length' bytes into 'buffer', replacing its content.
+	///
+	/// The capacity of 'buffer' is reused across calls.
+	/// \returns The number of bytes read.
 	size_t readStr(std::string& buffer, size_t length);
 	int readByte();
+
+	/// \brief Returns everything available in a new vector.
+	///
+	/// This allocates on every call, prefer readAppend() with a vector kept
+	/// across calls on hot paths.
 	std::vector<uint8_t> readBytes();
 
+	/// \brief Reads at most buffer.size() bytes into a caller owned buffer.
+	///
+	/// ~~~~{.cpp}
+	/// std::array<uint8_t, 256> buffer;
+	/// size_t n = serial.readInto(buffer);
+	/// ~~~~
+	/// \returns The number of bytes read, 0 when there is no data.
+	size_t readInto(std::span<uint8_t> buffer){
+		return readBytes(buffer.data(), buffer.size());
+	}
+
+	/// \brief Waits for data, then reads at most 'length' bytes.
+	///
+	/// The thread sleeps in poll() (an overlapped WaitCommEvent() on Windows)
+	/// and wakes up as soon as a byte arrives, the deadline passes or close()
+	/// is called from another thread, there is no sleep to tune:
+	/// ~~~~{.cpp}
+	/// std::array<uint8_t, 256> buffer;
+	/// while(running){
+	///	 auto result = serial.readSome(buffer, std::chrono::milliseconds(500));
+	///	 if(result){
+	///		 parse(buffer.data(), result.bytesRead);
+	///	 } else if(result.status != ofSerialReadStatus::Timeout){
+	///		 break;
+	///	 }
+	/// }
+	/// ~~~~
+	/// \returns Done with at least one byte, or why nothing was read.
+	ofSerialReadResult readSome(uint8_t * buffer, size_t length, std::chrono::steady_clock::time_point deadline);
+	ofSerialReadResult readSome(std::span<uint8_t> buffer, std::chrono::steady_clock::time_point deadline){
+		return readSome(buffer.data(), buffer.size(), deadline);
+	}
+	ofSerialReadResult readSome(std::span<uint8_t> buffer, std::chrono::milliseconds timeout){
+		return readSome(buffer.data(), buffer.size(), std::chrono::steady_clock::now() + timeout);
+	}
+
+	/// \brief readSome() into the free space of a pooled buffer, see ofSerialBufferPool.
+	///
+	/// The bytes are appended after buffer.size(), straight from the device
+	/// (or the reader thread ring), and the buffer is then shared with any
+	/// number of consumers without a copy.
+	ofSerialReadResult readSome(ofSerialBuffer & buffer, std::chrono::steady_clock::time_point deadline);
+
+	/// \brief Waits until 'length' bytes are read, or the deadline.
+	///
+	/// Sleeps like readSome() between the chunks. On any other status than
+	/// Done, bytesRead tells how much of 'buffer' was filled.
+	ofSerialReadResult readExactly(uint8_t * buffer, size_t length, std::chrono::steady_clock::time_point deadline);
+	ofSerialReadResult readExactly(std::span<uint8_t> buffer, std::chrono::steady_clock::time_point deadline){
+		return readExactly(buffer.data(), buffer.size(), deadline);
+	}
+	ofSerialReadResult readExactly(std::span<uint8_t> buffer, std::chrono::milliseconds timeout){
+		return readExactly(buffer.data(), buffer.size(), std::chrono::steady_clock::now() + timeout);
+	}
+
+	/// \brief Appends the available bytes to the end of 'buffer'.
+	///
+	/// The vector only grows when its capacity is exceeded, so reusing the same
+	/// buffer (cleared or not) makes steady state reads allocation free.
+	/// ~~~~{.cpp}
+	/// std::vector<uint8_t> rx;
+	/// rx.reserve(4096);
+	/// while(running){
+	///	 rx.clear();
+	///	 serial.readAppend(rx);
+	/// }
+	/// ~~~~
+	/// \param maxLength Maximum number of bytes to append.
+	/// \returns The number of bytes appended.
+	size_t readAppend(std::vector<uint8_t> & buffer, size_t maxLength = SIZE_MAX);
+
+	/// \}
+	/// \name Read Frames
+	/// \{
+
+	/// \brief Called with a frame and the delimiter that ended it.
+	///
+	/// The frame points into an internal buffer, it is only valid during the
+	/// call. Consecutive delimiters (e.g. "\r\n") give empty frames.
+	using FrameCallback = std::function<void(const uint8_t * frame, size_t length, uint8_t delimiter)>;
+
+	/// \brief Reads what is available and splits it into frames.
+	///
+	/// Every delimiter is found in one vectorized pass over the received data,
+	/// see ofSerialScanner. An incomplete frame at the end is kept for the
+	/// next call. This does not block, and onFrame must not read the port.
+	///
+	/// ~~~~{.cpp}
+	/// ofSerialScanner slip({0xC0});
+	/// serial.readFrames(slip, [](const uint8_t * frame, size_t length, uint8_t){
+	///	 if(length > 0) handle(frame, length);
+	/// });
+	/// ~~~~
+	/// \returns The number of frames passed to onFrame.
+	size_t readFrames(const ofSerialScanner & scanner, const FrameCallback & onFrame);
+
+	/// \brief Sets the longest line or frame readStringUntil(), tryReadStringUntil()
+	/// and readFrames(scanner) wait the delimiter of.
+	///
+	/// The bytes of a longer one are dropped up to and including its
+	/// delimiter, and counted in getMetrics().bytesOversized, so that a device
+	/// that never sends the delimiter cannot grow the read-ahead buffer
+	/// without bound. 64 KiB by default. The frame decoders have their own
+	/// limit, see ofSerialFrameDecoder.
+	void setMaxFrameLength(size_t length);
+	size_t getMaxFrameLength() const{
+		return rxMaxFrameLength;
+	}
+
+	/// \brief Reads what is available and feeds it to a frame decoder.
+	///
+	/// The received bytes are handed to the decoder where they were read, see
+	/// ofSerialCobsDecoder, ofSerialSlipDecoder and ofSerialLengthPrefixDecoder.
+	/// \returns The number of frames passed to onFrame.
+	size_t readFrames(ofSerialFrameDecoder & decoder, const std::function<void(std::span<const uint8_t> frame)> & onFrame);
+
+	/// \brief readFrames() handing each frame over in a buffer of 'pool'.
+	///
+	/// The decoded frame is copied once out of the decoder, the consumers then
+	/// share the buffer instead of copying it again. A frame no free buffer can
+	/// hold is dropped, pool.getNumFailed() counts them.
+	/// \returns The number of frames passed to onFrame.
+	size_t readFrames(ofSerialFrameDecoder & decoder, ofSerialBufferPool & pool, const std::function<void(ofSerialBuffer frame)> & onFrame);
+
 	/// \}
 	/// \name writeData Data
 	/// \{
@@ -300,13 +728,135 @@ public:
 	size_t writeBytes(const char* buffer, size_t length){return writeBytes(reinterpret_cast<const uint8_t *>(buffer), length);}
 	size_t writeBytes(const uint8_t * buffer, size_t length);
 
+#ifndef TARGET_WIN32
+	/// \brief Writes what the device accepts right now, without waiting.
+	///
+	/// This is meant for event loops, it bypasses write coalescing and the
+	/// writer thread.
+	/// \param status If not null, receives Done once every byte was written,
+	/// Pending if the output buffer was full and Failed if the port failed
+	/// or is closed.
+	/// \returns The number of bytes written, 0 if the output buffer is full.
+	size_t writeSome(const uint8_t * buffer, size_t length, ofSerialWriteStatus * status = nullptr);
+#endif
+
+	/// \}
+	/// \name Asynchronous Write
+	/// \{
+
+	/// \brief Called on the writer thread once a request is complete.
+	using WriteCallback = std::function<void(ofSerialWriteStatus status, size_t bytesWritten)>;
+
+	/// \brief Starts a thread writing the queued requests.
+	///
+	/// writeAsync() then returns at once, even when the tty output buffer is
+	/// full. The writer thread sends up to 16 queued requests with a single
+	/// writev(). While it runs, writeBytes() queues its buffer and waits for
+	/// it, so that sync and async writes keep their order.
+	///
+	/// ~~~~{.cpp}
+	/// serial.startWriterThread(64);
+	/// auto handle = serial.writeAsync(std::move(frame), [](ofSerialWriteStatus status, size_t written){
+	///	 // runs on the writer thread
+	/// });
+	/// if(handle.getStatus() == ofSerialWriteStatus::Rejected){
+	///	 // the queue is full, try again later
+	/// }
+	/// ~~~~
+	/// \param maxQueuedWrites Number of requests the queue holds before rejecting new ones.
+	bool startWriterThread(size_t maxQueuedWrites = 64);
+
+	/// \brief Writes the queued requests, then stops the writer thread.
+	void stopWriterThread();
+
+	/// \returns true if the writer thread runs.
+	bool isWriterThreadRunning() const{
+		return bWriterRunning;
+	}
+
+	/// \brief Queues a buffer the request takes ownership of.
+	/// \returns A handle on the request, rejected if the queue is full.
+	ofSerialWriteHandle writeAsync(std::vector<uint8_t> && data, WriteCallback onComplete = nullptr);
+
+	/// \brief Queues a buffer owned by the caller, without copying it.
+	///
+	/// The caller must keep 'data' alive and unchanged until the request is
+	/// done, i.e. until the handle says so or the callback was called.
+	ofSerialWriteHandle writeAsyncBorrowed(std::span<const uint8_t> data, WriteCallback onComplete = nullptr);
+
+	/// \returns The number of queued requests, this is the backpressure signal.
+	size_t getWriteQueueLength() const;
+
+	/// \returns The number of requests the queue can hold.
+	size_t getWriteQueueCapacity() const;
+
+	/// \brief Sets how long a write waits for the device to accept data, 10 seconds by default.
+	void setWriteTimeout(std::chrono::milliseconds timeout){
+		writeTimeout = timeout;
+	}
+
+	/// \}
+	/// \name Write Coalescing
+	/// \{
+
+	/// \brief Gathers small writes and sends them together.
+	///
+	/// Each writeBytes() normally costs a write() syscall and, on USB adapters,
+	/// a mostly empty packet. With coalescing enabled, writes are staged until
+	/// 'thresholdBytes' are pending, the staged bytes then leave with the next
+	/// write in a single writev(). The staged bytes are also sent:
+	/// - by flushWrites(), close() and drain(),
+	/// - before a read blocks waiting for data (readStringUntil()...),
+	/// - once 'maxDelay' has passed since the first staged byte. This is checked
+	///   by the next write, by pollWriteTimer() and by ofSerialReactor, which
+	///   arms a timer for it.
+	///
+	/// ~~~~{.cpp}
+	/// serial.setWriteCoalescing(256, std::chrono::microseconds(200));
+	/// for(auto & command: commands){
+	///	 serial.writeBytes(command);
+	/// }
+	/// serial.flushWrites();
+	/// ~~~~
+	///
+	/// While coalescing, writeBytes() returns the number of bytes accepted,
+	/// write errors are reported by the call that sends them.
+	/// \param thresholdBytes Bytes to gather before sending, 0 disables coalescing.
+	/// \param maxDelay Maximum time a byte stays staged.
+	void setWriteCoalescing(size_t thresholdBytes, std::chrono::microseconds maxDelay = std::chrono::microseconds(500));
+
+	/// \brief Sends the staged bytes now.
+	/// \returns false if they could not all be written.
+	bool flushWrites();
+
+	/// \brief Sends the staged bytes if they are older than the coalescing delay.
+	///
+	/// It never waits for a write in progress on another thread: the bytes are
+	/// then left staged, getWriteDeadline() tells to try again.
+	/// \returns false if the staged bytes could not all be written.
+	bool pollWriteTimer();
+
+	/// \returns When the staged bytes must be sent, time_point::max() if nothing is staged.
+	///
+	/// It can be called from any thread.
+	std::chrono::steady_clock::time_point getWriteDeadline() const{
+		return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(txDeadline.load(std::memory_order_acquire)));
+	}
+
+	/// \brief Called when a write is staged while nothing was, so that a timer can be armed for getWriteDeadline().
+	///
+	/// It runs on the writing thread, which owns the write side, and must not
+	/// block nor write to the port. ofSerialReactor sets it on the ports it
+	/// serves, a port belongs to one reactor at a time.
+	void setWriteStagedCallback(std::function<void(ofSerial & port)> onStaged);
+
 	/// \}
 	/// \name Clear Data
 	/// \{
 
 	/// \brief Clears data from one or both of the serial buffers.
 	///
-	/// Any data in the cleared buffers is discarded.
+	/// Any data in the cleared buffers is discarded, staged writes included.
 	/// \param flushIn If true then it clears the incoming data buffer
 	/// \param flushOut If true then it clears the outgoing data buffer.
 	void flush(bool flushIn = true, bool flushOut = true);
@@ -317,45 +867,158 @@ public:
 	void drain();
 
 	/// \}
+	/// \name Background Reader
+	/// \{
 
-	bool isBuadLegal(const int baud) const {
-		return (std::find(supportedBauds.begin(), supportedBauds.end(), baud)
-				!= supportedBauds.end());
+	/// \brief Starts a thread draining the port into a lock-free ring.
+	///
+	/// The thread reads the device in large chunks as soon as data arrives,
+	/// so a slow consumer no longer lets the kernel tty buffer overflow.
+	/// While it runs available(), readBytes() and readByte() are served from
+	/// the ring without any syscall. Only one thread may consume the port.
+	///
+	/// ~~~~{.cpp}
+	/// serial.setup("/dev/ttyUSB0", 921600);
+	/// serial.startReaderThread(1 << 20);
+	/// while(serial.available() > 0){
+	///	 int myByte = serial.readByte();
+	/// }
+	/// ~~~~
+	///
+	/// \param ringCapacity Size of the ring in bytes, rounded up to a power of two.
+	/// \returns false if the port is not opened or the platform is not supported.
+	bool startReaderThread(size_t ringCapacity = 1 << 16);
+
+	/// \brief Stops the reader thread, data still in the ring is lost.
+	void stopReaderThread();
+
+	/// \returns true if the reader thread feeds the reads.
+	bool isReaderThreadRunning() const{
+		return rxRing != nullptr;
 	}
 
-	void addLegalBaud(const int baud){
-		supportedBauds.push_back(baud);
+	/// \}
+
+	[[deprecated("use isBaudSupported()")]]
+	bool isBuadLegal(const int baud) const {
+		return baud > 0 && isBaudSupported(size_t(baud));
 	}
 protected:
 	/// \brief Enumerate all devices attached to a serial port.
 	///
 	/// This method tries to collect basic information about all devices
-	/// attached to a serial port.
+	/// attached to a serial port. On OSX and Linux the list is taken from
+	/// ofSerialDeviceRegistry::getDefault() instead of listing /dev.
 	/// \see ofSerial::listDevices()
 	/// \see enumerateWin32Ports()
 	void buildDeviceList();
 
 	std::string deviceType;  ///\< \brief Name of the device on the other end of the serial connection.
 	std::vector <ofSerialDeviceInfo> devices;  ///\< This vector stores information about all serial devices found.
+	uint64_t devicesGeneration = 0;  ///< \brief Registry generation 'devices' was copied from.
+
+	size_t achievedBaud = 0;  ///< \brief Rate read back from the driver by setup().
+	ofSerialProfile profile;  ///< \brief Applied by setup() and setProfile().
+	ofSerialMetrics metrics;  ///< \brief See getMetrics().
+	std::atomic<ofSerialCapture *> capture{nullptr};  ///< \brief See setCapture().
+
+	/// \brief Records bytes in the capture, if one is attached.
+	void captureBytes(ofSerialCapture::Direction direction, const uint8_t * data, size_t length){
+		if(ofSerialCapture * tap = capture.load(std::memory_order_acquire)){
+			tap->append(direction, data, length);
+		}
+	}
 
-	std::vector <int> supportedBauds = {
-		300, 
-		1200, 
-		2400, 
-		4800,
-		9600,
-		14400, 
-		19200,
-		28800, 
-		38400,
-		57600,
-		115200,
-		230400,
-		12000000
-	};
-	
 	bool bHaveEnumeratedDevices;  ///\< \brief Indicate having enumerated devices (serial ports) available.
-	bool bInited = false;;  ///\< \brief Indicate the successful initialization of the serial connection.
+	std::atomic<bool> bInited{false};  ///\< \brief Indicate the successful initialization of the serial connection.
+
+	/// \cond INTERNAL
+	static constexpr uint64_t ioOpen = 1;  ///< \brief Set while I/O may start.
+	static constexpr uint64_t ioUser = 2;  ///< \brief One I/O call in flight, bits 1 to 31.
+	static constexpr uint64_t ioUserMask = 0xFFFFFFFE;
+	static constexpr unsigned ioEpochShift = 32;  ///< \brief The epoch is in the upper half.
+
+	/// \brief Holds the file descriptor open for the duration of an I/O call.
+	///
+	/// Entering fails once close() started, close() then waits for the calls
+	/// that entered to leave before closing the descriptor.
+	class IoGuard {
+		public:
+			explicit IoGuard(ofSerial & port)
+			:port(port){
+				uint64_t state = port.ioState.load(std::memory_order_acquire);
+				while((state & ioOpen) != 0){
+					if(port.ioState.compare_exchange_weak(state, state + ioUser, std::memory_order_acquire)){
+						bEntered = true;
+						break;
+					}
+				}
+			}
+
+			~IoGuard(){
+				if(bEntered){
+					const uint64_t state = port.ioState.fetch_sub(ioUser, std::memory_order_acq_rel) - ioUser;
+					if((state & (ioOpen | ioUserMask)) == 0){
+						port.ioState.notify_all();
+					}
+				}
+			}
+
+			IoGuard(const IoGuard &) = delete;
+			IoGuard & operator=(const IoGuard &) = delete;
+
+			explicit operator bool() const{
+				return bEntered;
+			}
+
+		protected:
+			ofSerial & port;
+			bool bEntered = false;
+	};
+
+	std::atomic<uint64_t> ioState{0};  ///< \brief Open bit, in flight I/O calls and epoch, see IoGuard.
+
+	/// \brief Marks the port opened, once the descriptor is configured.
+	bool publishOpened();
+
+	/// \brief Sends the staged bytes, the caller owns the write side.
+	bool flushStaged();
+
+	/// \brief Owns the write side for the duration of a write, see the Threads section.
+	///
+	/// Only the read side flushing staged bytes competes for it, with tryLockWriteSide().
+	class WriteSideLock {
+		public:
+			explicit WriteSideLock(ofSerial & port)
+			:port(port){
+				while(port.bWriting.exchange(true, std::memory_order_acquire)){
+					port.bWriting.wait(true, std::memory_order_relaxed);
+				}
+			}
+
+			~WriteSideLock(){
+				port.unlockWriteSide();
+			}
+
+			WriteSideLock(const WriteSideLock &) = delete;
+			WriteSideLock & operator=(const WriteSideLock &) = delete;
+
+		protected:
+			ofSerial & port;
+	};
+
+	/// \returns true if the write side was free and is now owned by the caller.
+	bool tryLockWriteSide(){
+		return !bWriting.exchange(true, std::memory_order_acquire);
+	}
+
+	void unlockWriteSide(){
+		bWriting.store(false, std::memory_order_release);
+		bWriting.notify_one();
+	}
+
+	std::atomic<bool> bWriting{false};  ///< \brief Set while a thread owns the write side.
+	/// \endcond
 
 #ifdef TARGET_WIN32
 
@@ -385,14 +1048,155 @@ protected:
 	HANDLE hComm = INVALID_HANDLE_VALUE; ///\< This is the handler for the serial port on Microsoft Windows.
 	OVERLAPPED osWriter = { 0 }; ///\< This is the handler for the serial writer OVERLAPPED on Microsoft Windows.
 	OVERLAPPED osReader = { 0 }; ///\< This is the handler for the serial reader OVERLAPPED on Microsoft Windows.
+	OVERLAPPED osWaiter = { 0 }; ///\< This is the handler of the WaitCommEvent() OVERLAPPED waitReadable() sleeps on, on Microsoft Windows.
 	int nPorts;  ///\< \brief Number of serial devices (ports) on Microsoft Windows.
 	bool bPortsEnumerated;  ///\< \brief Indicate that all serial ports (on Microsoft Windows) have been enumerated.
 
 #else
 	int fd; ///< \brief File descriptor for the serial port.
+	int closeWakePipe[2] = {-1, -1};  ///< \brief Becomes readable when close() starts, watched by every wait on the port.
 	struct termios oldoptions;  ///< \brief This is the set of (current) terminal attributes to be reused when changing a subset of options.
+
+	/// \brief Body of the reader thread started by startReaderThread().
+	void readerThreadLoop();
+
+	/// \brief Wakes the reader thread up when it waits for the ring or has to stop.
+	void wakeReaderThread();
+
+	std::thread readerThread;  ///< \brief Thread feeding rxRing.
+	std::atomic<bool> bReaderStop{false};  ///< \brief Asks the reader thread to return.
+	std::atomic<bool> bReaderStalled{false};  ///< \brief Set by the reader thread while the ring is full.
+	std::atomic<bool> bReaderDone{false};  ///< \brief Set by the reader thread when it returns.
+	std::atomic<bool> bConsumerWaiting{false};  ///< \brief Set by the consumer while it waits for the ring.
+	int readerWakePipe[2] = {-1, -1};  ///< \brief Self-pipe interrupting the reader thread poll().
+	int consumerWakePipe[2] = {-1, -1};  ///< \brief Pipe the reader thread pokes when a waiting consumer has data.
+	std::atomic<bool> bBulkReads{false};  ///< \brief The profile sets VMIN above 1, the reader thread polls with a timeout.
+	static constexpr int bulkTailTimeoutMs = 10;  ///< \brief Delay after which the reader thread reads a tail shorter than VMIN.
+#endif
+
+	/// \brief Called by the consumer after taking bytes out of rxRing, wakes the reader thread if the ring was full.
+	void releaseReaderSpace();
+
+	/// \brief Reads from the reader thread ring or the device, bypassing rxPending.
+	///
+	/// If 'result' is given, a hang up, an error or a closed port updates its status.
+	size_t readDevice(uint8_t * buffer, size_t length, ofSerialReadResult * result = nullptr);
+
+	/// \brief Body of readSome() and readExactly(), reads until 'bAll' or one chunk is in.
+	ofSerialReadResult readUntilDeadline(uint8_t * buffer, size_t length, std::chrono::steady_clock::time_point deadline, bool bAll);
+
+	/// \brief Blocks until the device (or the ring) can be read or the deadline passes.
+	///
+	/// rxPending is not looked at, callers check it first.
+	/// \returns false on timeout, or when the device went away.
+	bool waitReadable(std::chrono::steady_clock::time_point deadline);
+
+#ifndef TARGET_WIN32
+	/// \brief Sleeps until the queued bytes stop growing for profile.frameGapUs, or the deadline.
+	void waitFrameGap(std::chrono::steady_clock::time_point deadline);
+
+	/// \brief Sets or clears ASYNC_LOW_LATENCY when the driver supports it.
+	void setLowLatency(bool bLowLatency);
+
+	/// \brief Opens the device and saves its attributes in oldoptions.
+	bool openPort(const std::string_view portName);
+
+	/// \brief Sets the speed in 'options' and applies them, closes the port if the tty refused them.
+	bool applyTermios(struct termios options, speed_t speed);
+
+	/// \brief setup() of an ofSerialConfig: one open(), one tcgetattr(), one tcsetattr(), then reads the rate back.
+	bool setupTermios(const std::string_view portName, struct termios (*makeTermios)(struct termios), speed_t speed, size_t baud, const ofSerialProfile & profile);
 #endif
 
+	/// \brief Writes two buffers with a single writev(), either may be empty.
+	size_t writeGather(const uint8_t * head, size_t headLength, const uint8_t * body, size_t bodyLength);
+
+	/// \brief Maximum number of buffers passed to a single writev().
+	static constexpr size_t maxWriteSegments = 16;
+
+	/// \brief Writes buffers with a single writev(), empty ones are skipped.
+	/// \returns The number of bytes written.
+	size_t writeSegments(const std::span<const uint8_t> * segments, size_t count);
+
+	/// \cond INTERNAL
+	struct WriteRequest {
+		std::vector<uint8_t> owned;
+		std::span<const uint8_t> data;
+		std::shared_ptr<ofSerialWriteHandle::State> state;
+		WriteCallback onComplete;
+	};
+	/// \endcond
+
+	/// \brief Pushes a request on the write queue.
+	/// \param bWaitForSpace Blocks while the queue is full instead of rejecting.
+	ofSerialWriteHandle enqueueWrite(WriteRequest && request, bool bWaitForSpace);
+
+	/// \brief Body of the writer thread started by startWriterThread().
+	void writerThreadLoop();
+
+	/// \brief Completes the requests left in the queue once the writer thread returned.
+	void failQueuedWrites();
+
+	/// \brief Sets the status of a request and calls its callback.
+	void completeWrite(WriteRequest & request, size_t written);
+
+	std::unique_ptr<ofSerialMpscQueue<WriteRequest>> writeQueue;  ///< \brief Requests pushed by any thread, popped by the writer thread.
+	std::atomic<uint32_t> writeQueuePushes{0};  ///< \brief Bumped after each push, the writer thread waits on it when the queue is empty.
+	std::atomic<uint32_t> writeQueuePops{0};  ///< \brief Bumped after each batch popped, producers wait on it when the queue is full.
+	std::atomic<uint32_t> writeProducers{0};  ///< \brief Threads in enqueueWrite(), stopWriterThread() waits for them.
+	std::thread writerThread;
+	std::atomic<bool> bWriterStop{false};  ///< \brief Asks the writer thread to return once the queue is empty.
+	std::atomic<bool> bWriterRunning{false};
+	std::chrono::milliseconds writeTimeout{10000};  ///< \brief How long a write waits for the device.
+
+	std::unique_ptr<uint8_t[]> txStaging;  ///< \brief Small writes waiting to be coalesced.
+	size_t txStagedLength = 0;  ///< \brief Number of bytes in txStaging.
+	size_t txCoalesceThreshold = 0;  ///< \brief Size of txStaging, 0 when coalescing is off.
+	std::chrono::microseconds txCoalesceDelay{0};  ///< \brief Maximum time a byte stays in txStaging.
+	std::chrono::steady_clock::time_point txFirstStagedTime;  ///< \brief When the oldest staged byte was written.
+	std::atomic<std::chrono::steady_clock::rep> txDeadline{std::chrono::steady_clock::time_point::max().time_since_epoch().count()};  ///< \brief getWriteDeadline(), published for the other threads.
+	std::function<void(ofSerial & port)> onWriteStaged;  ///< \brief See setWriteStagedCallback(), guarded by the write side.
+
+	/// \brief Empties txStaging, the caller owns the write side.
+	void clearStaged(){
+		txStagedLength = 0;
+		txDeadline.store(std::chrono::steady_clock::time_point::max().time_since_epoch().count(), std::memory_order_release);
+	}
+
+	/// \brief Moves the bytes before 'delimiter' from rxPending to 'line'.
+	/// \param scanned Bytes of rxPending already known not to hold the delimiter, updated.
+	/// \returns true if the delimiter was found.
+	bool takePendingLine(const char delimiter, size_t & scanned, std::string & line);
+
+	/// \brief Reads what the device has at the end of rxPending, growing it if full.
+	///
+	/// rxPending does not grow past the first size above rxMaxFrameLength,
+	/// the callers drop longer lines and frames with dropPending().
+	/// \returns The number of bytes appended.
+	size_t fillPending();
+
+	/// \brief Drops the pending bytes of an oversized line or frame, and the rest of it up to its delimiter.
+	void dropPending(){
+		metrics.addBytesOversized(pendingSize());
+		rxPendingBegin = 0;
+		rxPendingEnd = 0;
+		bRxDiscarding = true;
+	}
+
+	/// \returns The number of bytes read ahead and not consumed yet.
+	size_t pendingSize() const{
+		return rxPendingEnd - rxPendingBegin;
+	}
+
+	std::unique_ptr<uint8_t[]> rxPending;  ///< \brief Bytes read ahead of the caller, e.g. following a readStringUntil() delimiter.
+	size_t rxPendingCapacity = 0;  ///< \brief Size of rxPending.
+	size_t rxPendingBegin = 0;  ///< \brief Offset of the first unread byte in rxPending.
+	size_t rxPendingEnd = 0;  ///< \brief Offset past the last unread byte in rxPending.
+	size_t rxMaxFrameLength = 65536;  ///< \brief See setMaxFrameLength().
+	bool bRxDiscarding = false;  ///< \brief Skipping an oversized line or frame until its delimiter.
+
+	std::unique_ptr<ofSerialRingBuffer> rxRing;  ///< \brief Ring filled by the reader thread, null when it is not running.
+
 };
 
 //----------------------------------------------------------------------
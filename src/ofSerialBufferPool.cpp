@@ -0,0 +1,327 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialBufferPool.h"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <thread>
+
+namespace {
+
+/// \brief Spin lock of a thread cache entry, only contended while another thread reclaims its buffers.
+struct CacheLock {
+	std::atomic<bool> bLocked{false};
+
+	void lock(){
+		while(bLocked.exchange(true, std::memory_order_acquire)){
+			std::this_thread::yield();
+		}
+	}
+
+	void unlock(){
+		bLocked.store(false, std::memory_order_release);
+	}
+};
+
+/// \brief Free buffers of one pool kept by a thread.
+struct CacheEntry {
+	uint64_t poolId = 0;
+	std::weak_ptr<ofSerialBufferPool::Core> core;
+	CacheLock mutex;  ///< \brief Guards lists and counts.
+	std::array<ofSerialBufferHeader *, ofSerialBufferPool::maxClasses> lists{};
+	std::array<uint32_t, ofSerialBufferPool::maxClasses> counts{};
+	CacheEntry * prev = nullptr;  ///< \brief Links in the caches of the pool, guarded by Core::cachesMutex.
+	CacheEntry * next = nullptr;
+};
+
+}
+
+struct ofSerialBufferPool::Core: public std::enable_shared_from_this<ofSerialBufferPool::Core> {
+	struct SizeClass {
+		size_t bufferSize = 0;
+		size_t count = 0;
+		uint32_t cacheSize = 0;  ///< \brief Most buffers of the class a thread may keep.
+		std::unique_ptr<uint8_t[]> slab;
+		std::mutex mutex;
+		ofSerialBufferHeader * freeList = nullptr;  ///< \brief Guarded by 'mutex'.
+	};
+
+	uint64_t id = 0;  ///< \brief Unique over the process, a thread cache entry is matched by id, never by address.
+	std::array<SizeClass, maxClasses> classes;
+	size_t numClasses = 0;
+	size_t memorySize = 0;
+	std::atomic<size_t> numInUse{0};
+	std::atomic<size_t> numFailed{0};
+	std::mutex cachesMutex;
+	CacheEntry * caches = nullptr;  ///< \brief The thread caches holding buffers of the pool, guarded by 'cachesMutex'.
+
+	/// \brief Moves up to 'max' buffers of class 'k' from the shared list to 'list'.
+	uint32_t take(size_t k, ofSerialBufferHeader *& list, uint32_t max){
+		SizeClass & sizeClass = classes[k];
+		std::lock_guard<std::mutex> lock(sizeClass.mutex);
+		uint32_t n = 0;
+		while(n < max && sizeClass.freeList){
+			ofSerialBufferHeader * header = sizeClass.freeList;
+			sizeClass.freeList = header->next;
+			header->next = list;
+			list = header;
+			n++;
+		}
+		return n;
+	}
+
+	/// \brief Moves up to 'max' buffers of 'list' to the shared list of class 'k'.
+	uint32_t give(size_t k, ofSerialBufferHeader *& list, uint32_t max){
+		SizeClass & sizeClass = classes[k];
+		std::lock_guard<std::mutex> lock(sizeClass.mutex);
+		uint32_t n = 0;
+		while(n < max && list){
+			ofSerialBufferHeader * header = list;
+			list = header->next;
+			header->next = sizeClass.freeList;
+			sizeClass.freeList = header;
+			n++;
+		}
+		return n;
+	}
+
+	void addCache(CacheEntry & entry){
+		std::lock_guard<std::mutex> lock(cachesMutex);
+		entry.prev = nullptr;
+		entry.next = caches;
+		if(caches){
+			caches->prev = &entry;
+		}
+		caches = &entry;
+	}
+
+	/// \brief Returns every buffer of 'entry' to the shared lists and forgets it.
+	void removeCache(CacheEntry & entry){
+		std::lock_guard<std::mutex> lock(cachesMutex);
+		entry.mutex.lock();
+		for(size_t k = 0; k < numClasses; k++){
+			give(k, entry.lists[k], UINT32_MAX);
+			entry.counts[k] = 0;
+		}
+		entry.mutex.unlock();
+		(entry.prev ? entry.prev->next : caches) = entry.next;
+		if(entry.next){
+			entry.next->prev = entry.prev;
+		}
+		entry.prev = entry.next = nullptr;
+	}
+
+	/// \brief Moves the buffers of class 'k' cached by other threads than 'self' to the shared list.
+	///
+	/// Called when the shared list is empty: the threads releasing buffers
+	/// are often not the ones acquiring them, and may stay idle for long.
+	/// \returns The number of buffers moved.
+	uint32_t reclaim(size_t k, CacheEntry * self){
+		std::lock_guard<std::mutex> lock(cachesMutex);
+		uint32_t n = 0;
+		for(CacheEntry * entry = caches; entry; entry = entry->next){
+			if(entry == self){
+				continue;
+			}
+			entry->mutex.lock();
+			const uint32_t moved = give(k, entry->lists[k], UINT32_MAX);
+			entry->counts[k] -= moved;
+			n += moved;
+			entry->mutex.unlock();
+		}
+		return n;
+	}
+};
+
+namespace {
+
+std::atomic<uint64_t> nextPoolId{1};
+
+/// \brief Free buffers kept by a thread, for the last few pools it used.
+struct ThreadCache {
+	std::array<CacheEntry, 4> entries;
+
+	~ThreadCache(){
+		for(auto & entry: entries){
+			if(auto core = entry.core.lock()){
+				core->removeCache(entry);
+			}
+		}
+	}
+
+	/// \returns The entry of 'core', or nullptr if every entry serves another living pool.
+	CacheEntry * find(ofSerialBufferPool::Core & core){
+		for(auto & entry: entries){
+			if(entry.poolId == core.id){
+				return &entry;
+			}
+		}
+		for(auto & entry: entries){
+			// the buffers of a destroyed pool went away with its slabs
+			if(entry.poolId == 0 || entry.core.expired()){
+				entry.poolId = core.id;
+				entry.core = core.weak_from_this();
+				entry.lists.fill(nullptr);
+				entry.counts.fill(0);
+				core.addCache(entry);
+				return &entry;
+			}
+		}
+		return nullptr;
+	}
+};
+
+thread_local ThreadCache threadCache;
+
+}
+
+//----------------------------------------------------------------
+ofSerialBufferPool::ofSerialBufferPool(size_t bufferSize, size_t count)
+:ofSerialBufferPool({ { bufferSize, count } }){
+}
+
+//----------------------------------------------------------------
+ofSerialBufferPool::ofSerialBufferPool(std::initializer_list<ofSerialBufferClass> classes)
+:core(std::make_shared<Core>()){
+	core->id = nextPoolId.fetch_add(1, std::memory_order_relaxed);
+	if(classes.size() > maxClasses){
+		std::cerr << "ofSerialBufferPool: " << classes.size() << " size classes, only the first " << maxClasses << " are used" << std::endl;
+	}
+
+	std::array<ofSerialBufferClass, maxClasses> sorted;
+	const size_t numClasses = std::min(classes.size(), maxClasses);
+	std::copy_n(classes.begin(), numClasses, sorted.begin());
+	std::sort(sorted.begin(), sorted.begin() + ptrdiff_t(numClasses), [](const ofSerialBufferClass & a, const ofSerialBufferClass & b){
+		return a.bufferSize < b.bufferSize;
+	});
+
+	for(size_t i = 0; i < numClasses; i++){
+		if(sorted[i].count == 0 || sorted[i].bufferSize == 0 || sorted[i].bufferSize > UINT32_MAX){
+			continue;
+		}
+		// every buffer starts on a cache line, right after its header
+		const size_t capacity = (sorted[i].bufferSize + alignof(ofSerialBufferHeader) - 1) & ~(alignof(ofSerialBufferHeader) - 1);
+		const size_t stride = sizeof(ofSerialBufferHeader) + capacity;
+		const size_t k = core->numClasses++;
+		Core::SizeClass & sizeClass = core->classes[k];
+		sizeClass.bufferSize = capacity;
+		sizeClass.count = sorted[i].count;
+		// a thread keeps a small share of the class, the others can always reclaim it
+		sizeClass.cacheSize = uint32_t(std::min(threadCacheSize, sizeClass.count / cacheShare));
+		sizeClass.slab = std::make_unique<uint8_t[]>(stride * sizeClass.count + alignof(ofSerialBufferHeader));
+		core->memorySize += stride * sizeClass.count;
+
+		uint8_t * first = sizeClass.slab.get() + (alignof(ofSerialBufferHeader) - reinterpret_cast<uintptr_t>(sizeClass.slab.get()) % alignof(ofSerialBufferHeader)) % alignof(ofSerialBufferHeader);
+		for(size_t n = sizeClass.count; n-- > 0;){
+			auto header = new (first + n * stride) ofSerialBufferHeader();
+			header->capacity = uint32_t(capacity);
+			header->sizeClass = uint32_t(k);
+			header->core = core.get();
+			header->next = sizeClass.freeList;
+			sizeClass.freeList = header;
+		}
+	}
+}
+
+//----------------------------------------------------------------
+ofSerialBufferPool::~ofSerialBufferPool(){
+	const size_t numInUse = getNumInUse();
+	if(numInUse > 0){
+		std::cerr << "ofSerialBufferPool: destroyed while " << numInUse << " buffers are in use" << std::endl;
+	}
+}
+
+//----------------------------------------------------------------
+ofSerialBuffer ofSerialBufferPool::acquire(size_t size){
+	Core & c = *core;
+	CacheEntry * entry = threadCache.find(c);
+	for(size_t k = 0; k < c.numClasses; k++){
+		if(c.classes[k].bufferSize < size){
+			continue;
+		}
+		ofSerialBufferHeader * header = nullptr;
+		const uint32_t cacheSize = c.classes[k].cacheSize;
+		if(entry && cacheSize > 1){
+			entry->mutex.lock();
+			if(entry->counts[k] == 0){
+				entry->counts[k] = c.take(k, entry->lists[k], cacheSize / 2);
+			}
+			if(entry->counts[k] > 0){
+				header = entry->lists[k];
+				entry->lists[k] = header->next;
+				entry->counts[k]--;
+			}
+			entry->mutex.unlock();
+		} else {
+			c.take(k, header, 1);
+		}
+		if(!header && c.reclaim(k, entry) > 0){
+			c.take(k, header, 1);
+		}
+		if(header){
+			header->next = nullptr;
+			header->size = 0;
+			header->refs.store(1, std::memory_order_relaxed);
+			c.numInUse.fetch_add(1, std::memory_order_relaxed);
+			return ofSerialBuffer(header);
+		}
+	}
+	c.numFailed.fetch_add(1, std::memory_order_relaxed);
+	return ofSerialBuffer();
+}
+
+//----------------------------------------------------------------
+void ofSerialBufferPool::release(ofSerialBufferHeader * header){
+	Core & c = *static_cast<Core *>(header->core);
+	const size_t k = header->sizeClass;
+	const uint32_t cacheSize = c.classes[k].cacheSize;
+	c.numInUse.fetch_sub(1, std::memory_order_relaxed);
+	CacheEntry * entry = cacheSize > 1 ? threadCache.find(c) : nullptr;
+	if(!entry){
+		header->next = nullptr;
+		c.give(k, header, 1);
+		return;
+	}
+	entry->mutex.lock();
+	if(entry->counts[k] >= cacheSize){
+		entry->counts[k] -= c.give(k, entry->lists[k], cacheSize / 2);
+	}
+	header->next = entry->lists[k];
+	entry->lists[k] = header;
+	entry->counts[k]++;
+	entry->mutex.unlock();
+}
+
+//----------------------------------------------------------------
+size_t ofSerialBufferPool::getMaxBufferSize() const{
+	return core->numClasses > 0 ? core->classes[core->numClasses - 1].bufferSize : 0;
+}
+
+//----------------------------------------------------------------
+size_t ofSerialBufferPool::getNumBuffers() const{
+	size_t n = 0;
+	for(size_t k = 0; k < core->numClasses; k++){
+		n += core->classes[k].count;
+	}
+	return n;
+}
+
+//----------------------------------------------------------------
+size_t ofSerialBufferPool::getNumInUse() const{
+	return core->numInUse.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------
+size_t ofSerialBufferPool::getNumFailed() const{
+	return core->numFailed.load(std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------
+size_t ofSerialBufferPool::getMemorySize() const{
+	return core->memorySize;
+}
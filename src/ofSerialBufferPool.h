@@ -0,0 +1,238 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <span>
+
+class ofSerialBufferPool;
+
+/// \brief Buffer header, followed by the bytes of the buffer in the slab.
+struct alignas(64) ofSerialBufferHeader {
+	std::atomic<uint32_t> refs{0};
+	uint32_t size = 0;
+	uint32_t capacity = 0;
+	uint32_t sizeClass = 0;
+	void * core = nullptr;  ///< \brief The pool the buffer goes back to.
+	ofSerialBufferHeader * next = nullptr;  ///< \brief Link in a free list.
+
+	uint8_t * data(){
+		return reinterpret_cast<uint8_t *>(this + 1);
+	}
+};
+
+/// \brief Reference counted handle on a buffer of an ofSerialBufferPool.
+///
+/// Copying a handle shares the buffer, it costs an atomic increment and no
+/// byte is copied; the buffer goes back to the pool when its last handle is
+/// destroyed or reset, from whatever thread. Fill the buffer first, then hand
+/// out copies: the bytes are not protected once several threads hold them.
+///
+/// ~~~~{.cpp}
+/// ofSerialBuffer frame = pool.acquire(256);
+/// auto result = serial.readSome(frame, deadline);
+/// logger.push(frame);  // the three queues share the same bytes
+/// parser.push(frame);
+/// forwarder.push(std::move(frame));
+/// ~~~~
+class ofSerialBuffer {
+	friend class ofSerialBufferPool;
+
+	public:
+		ofSerialBuffer() = default;
+
+		ofSerialBuffer(const ofSerialBuffer & other)
+		:header(other.header){
+			if(header){
+				header->refs.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		ofSerialBuffer(ofSerialBuffer && other) noexcept
+		:header(other.header){
+			other.header = nullptr;
+		}
+
+		ofSerialBuffer & operator=(const ofSerialBuffer & other){
+			if(other.header){
+				other.header->refs.fetch_add(1, std::memory_order_relaxed);
+			}
+			reset();
+			header = other.header;
+			return *this;
+		}
+
+		ofSerialBuffer & operator=(ofSerialBuffer && other) noexcept{
+			if(this != &other){
+				reset();
+				header = other.header;
+				other.header = nullptr;
+			}
+			return *this;
+		}
+
+		~ofSerialBuffer(){
+			reset();
+		}
+
+		/// \brief Drops this reference, the last one returns the buffer to its pool.
+		void reset();
+
+		/// \returns false for an empty handle, e.g. when the pool was exhausted.
+		explicit operator bool() const{
+			return header != nullptr;
+		}
+
+		uint8_t * data(){
+			return header ? header->data() : nullptr;
+		}
+
+		const uint8_t * data() const{
+			return header ? header->data() : nullptr;
+		}
+
+		/// \returns The number of bytes in use, from data().
+		size_t size() const{
+			return header ? header->size : 0;
+		}
+
+		/// \returns The number of bytes the buffer can hold, at least what was asked for.
+		size_t capacity() const{
+			return header ? header->capacity : 0;
+		}
+
+		/// \brief Sets the number of bytes in use, at most capacity().
+		void resize(size_t size){
+			if(header){
+				header->size = uint32_t(size < header->capacity ? size : header->capacity);
+			}
+		}
+
+		/// \returns The bytes in use.
+		std::span<const uint8_t> span() const{
+			return { data(), size() };
+		}
+
+		/// \returns The free space after the bytes in use, see commit().
+		std::span<uint8_t> unused(){
+			return header ? std::span<uint8_t>(header->data() + header->size, header->capacity - header->size) : std::span<uint8_t>();
+		}
+
+		/// \brief Adds 'length' bytes written in unused() to the bytes in use.
+		void commit(size_t length){
+			resize(size() + length);
+		}
+
+		/// \returns The number of handles sharing the buffer, only a hint while other threads hold it.
+		uint32_t useCount() const{
+			return header ? header->refs.load(std::memory_order_relaxed) : 0;
+		}
+
+	protected:
+		/// \cond INTERNAL
+		explicit ofSerialBuffer(ofSerialBufferHeader * header)
+		:header(header){
+		}
+
+		ofSerialBufferHeader * header = nullptr;
+		/// \endcond
+};
+
+/// \brief A size class of an ofSerialBufferPool: 'count' buffers of 'bufferSize' bytes.
+struct ofSerialBufferClass {
+	size_t bufferSize;
+	size_t count;
+};
+
+/// \brief Preallocated pool of reference counted buffers.
+///
+/// Every buffer is carved at construction out of one slab per size class,
+/// the pool never allocates afterwards, so the memory used under load is
+/// bounded by getMemorySize(). acquire() returns a buffer of the smallest
+/// class that fits, or of a larger one when that class is exhausted, and an
+/// empty handle when nothing is left.
+///
+/// Each thread keeps a few free buffers per class, at most threadCacheSize
+/// and a 1/cacheShare of the class: acquiring and releasing on the same
+/// thread only take the uncontended lock of its cache, the shared free lists
+/// are locked to move half a cache at a time. A buffer released on a
+/// consumer thread is cached there; when the shared list of a class runs
+/// out, acquire() reclaims the buffers of that class cached by the other
+/// threads, so a pool is only exhausted when every buffer is held.
+///
+/// ~~~~{.cpp}
+/// ofSerialBufferPool pool({ {64, 1024}, {512, 256}, {4096, 32} });
+/// serial.readFrames(decoder, pool, [&](ofSerialBuffer frame){
+///	 for(auto & consumer: consumers){
+///		 consumer.push(frame);
+///	 }
+/// });
+/// ~~~~
+///
+/// The pool must outlive its buffers. ofSerial::readSome() and readFrames()
+/// fill pooled buffers directly, see bench/buffer_pool_bench.cpp for the
+/// fan-out to several consumer threads.
+class ofSerialBufferPool {
+
+public:
+	static constexpr size_t maxClasses = 8;
+	static constexpr size_t threadCacheSize = 32;
+	static constexpr size_t cacheShare = 16;
+
+	/// \brief A pool of 'count' buffers of 'bufferSize' bytes.
+	ofSerialBufferPool(size_t bufferSize, size_t count);
+
+	/// \brief A pool of up to maxClasses size classes, in any order.
+	explicit ofSerialBufferPool(std::initializer_list<ofSerialBufferClass> classes);
+
+	~ofSerialBufferPool();
+
+	ofSerialBufferPool(const ofSerialBufferPool &) = delete;
+	ofSerialBufferPool & operator=(const ofSerialBufferPool &) = delete;
+
+	/// \brief Takes a free buffer of at least 'size' bytes, its size() is 0.
+	/// \returns An empty handle if no buffer that large is free.
+	ofSerialBuffer acquire(size_t size);
+
+	/// \returns The capacity of the largest size class.
+	size_t getMaxBufferSize() const;
+
+	/// \returns The number of buffers of every class.
+	size_t getNumBuffers() const;
+
+	/// \returns The number of buffers held by handles.
+	size_t getNumInUse() const;
+
+	/// \returns The number of acquire() calls that found no buffer.
+	size_t getNumFailed() const;
+
+	/// \returns The bytes reserved by the slabs.
+	size_t getMemorySize() const;
+
+	/// \cond INTERNAL
+	/// \brief Slabs and shared free lists, the thread caches only hold it weakly.
+	struct Core;
+
+	/// \brief Returns a buffer whose last handle went away, called by ofSerialBuffer::reset().
+	static void release(ofSerialBufferHeader * header);
+	/// \endcond
+
+protected:
+	/// \cond INTERNAL
+	std::shared_ptr<Core> core;
+	/// \endcond
+};
+
+//----------------------------------------------------------------
+inline void ofSerialBuffer::reset(){
+	if(header && header->refs.fetch_sub(1, std::memory_order_acq_rel) == 1){
+		ofSerialBufferPool::release(header);
+	}
+	header = nullptr;
+}
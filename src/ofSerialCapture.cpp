@@ -0,0 +1,355 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialCapture.h"
+#include "ofSerial.h"
+#include "ofSerialFraming.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#ifndef TARGET_WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+//----------------------------------------------------------------
+ofSerialCapture::~ofSerialCapture(){
+	close();
+}
+
+//----------------------------------------------------------------
+bool ofSerialCapture::open(const std::string & path, size_t newCapacity){
+	close();
+
+	#ifndef TARGET_WIN32
+		newCapacity = std::max(newCapacity, ofSerialCaptureFormat::headerSize + ofSerialCaptureFormat::recordHeaderSize);
+		fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if(fd == -1){
+			std::cerr << "ofSerialCapture: can't create " << path << ": " << strerror(errno) << std::endl;
+			return false;
+		}
+		// sparse: blocks are only allocated as records land on them
+		if(ftruncate(fd, off_t(newCapacity)) != 0){
+			std::cerr << "ofSerialCapture: can't size " << path << ": " << strerror(errno) << std::endl;
+			::close(fd);
+			fd = -1;
+			return false;
+		}
+		void * mapping = mmap(nullptr, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if(mapping == MAP_FAILED){
+			std::cerr << "ofSerialCapture: can't map " << path << ": " << strerror(errno) << std::endl;
+			::close(fd);
+			fd = -1;
+			return false;
+		}
+
+		base = static_cast<uint8_t *>(mapping);
+		capacity = newCapacity;
+		start = std::chrono::steady_clock::now();
+		memcpy(base, ofSerialCaptureFormat::magic, sizeof(ofSerialCaptureFormat::magic));
+		const uint32_t header[2] = { ofSerialCaptureFormat::version, uint32_t(ofSerialCaptureFormat::headerSize) };
+		memcpy(base + 8, header, sizeof(header));
+		used = ofSerialCaptureFormat::headerSize;
+		numRecords = 0;
+		droppedBytes = 0;
+		return true;
+	#else
+		std::cerr << "ofSerialCapture: not supported on this platform, can't capture to " << path << std::endl;
+		(void)newCapacity;
+		return false;
+	#endif
+}
+
+//----------------------------------------------------------------
+void ofSerialCapture::close(){
+	#ifndef TARGET_WIN32
+		if(base == nullptr){
+			return;
+		}
+		const size_t size = getSize();
+		munmap(base, capacity);
+		base = nullptr;
+		if(ftruncate(fd, off_t(size)) != 0){
+			std::cerr << "ofSerialCapture: can't truncate the capture: " << strerror(errno) << std::endl;
+		}
+		::close(fd);
+		fd = -1;
+	#endif
+}
+
+//----------------------------------------------------------------
+uint8_t * ofSerialCapture::reserve(size_t length){
+	if(base == nullptr || length == 0){
+		return nullptr;
+	}
+	const size_t recordSize = ofSerialCaptureFormat::getRecordSize(length);
+	const size_t offset = used.fetch_add(recordSize, std::memory_order_relaxed);
+	// leaves room for the zero length that ends the file
+	if(offset + recordSize + sizeof(uint32_t) > capacity){
+		droppedBytes.fetch_add(length, std::memory_order_relaxed);
+		return nullptr;
+	}
+	return base + offset;
+}
+
+//----------------------------------------------------------------
+void ofSerialCapture::commit(uint8_t * record, Direction direction, size_t length){
+	const uint64_t timestampNs = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+	record[4] = direction;
+	memcpy(record + 8, &timestampNs, sizeof(timestampNs));
+	// the length goes last, a reader never sees a record half written
+	__atomic_store_n(reinterpret_cast<uint32_t *>(record), uint32_t(length), __ATOMIC_RELEASE);
+	numRecords.fetch_add(1, std::memory_order_relaxed);
+}
+
+//----------------------------------------------------------------
+bool ofSerialCapture::append(Direction direction, const uint8_t * data, size_t length){
+	uint8_t * record = reserve(length);
+	if(record == nullptr){
+		return false;
+	}
+	memcpy(record + ofSerialCaptureFormat::recordHeaderSize, data, length);
+	commit(record, direction, length);
+	return true;
+}
+
+//----------------------------------------------------------------
+bool ofSerialCapture::append(Direction direction, const std::span<const uint8_t> * segments, size_t count, size_t length){
+	uint8_t * record = reserve(length);
+	if(record == nullptr){
+		return false;
+	}
+	uint8_t * payload = record + ofSerialCaptureFormat::recordHeaderSize;
+	size_t copied = 0;
+	for(size_t i = 0; i < count && copied < length; i++){
+		const size_t n = std::min(segments[i].size(), length - copied);
+		if(n == 0){
+			continue;
+		}
+		memcpy(payload + copied, segments[i].data(), n);
+		copied += n;
+	}
+	commit(record, direction, copied);
+	return true;
+}
+
+//----------------------------------------------------------------
+ofSerialReplay::~ofSerialReplay(){
+	close();
+}
+
+//----------------------------------------------------------------
+bool ofSerialReplay::open(const std::string & path){
+	close();
+
+	#ifndef TARGET_WIN32
+		fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if(fd == -1){
+			std::cerr << "ofSerialReplay: can't open " << path << ": " << strerror(errno) << std::endl;
+			return false;
+		}
+		struct stat info;
+		if(fstat(fd, &info) != 0 || size_t(info.st_size) < ofSerialCaptureFormat::headerSize){
+			std::cerr << "ofSerialReplay: " << path << " is not a capture" << std::endl;
+			::close(fd);
+			fd = -1;
+			return false;
+		}
+		fileSize = size_t(info.st_size);
+		void * mapping = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+		if(mapping == MAP_FAILED){
+			std::cerr << "ofSerialReplay: can't map " << path << ": " << strerror(errno) << std::endl;
+			::close(fd);
+			fd = -1;
+			return false;
+		}
+		base = static_cast<uint8_t *>(mapping);
+		if(memcmp(base, ofSerialCaptureFormat::magic, sizeof(ofSerialCaptureFormat::magic)) != 0){
+			std::cerr << "ofSerialReplay: " << path << " is not a capture" << std::endl;
+			close();
+			return false;
+		}
+
+		// index the received records, a truncated last record ends the capture
+		size_t offset = ofSerialCaptureFormat::headerSize;
+		while(offset + ofSerialCaptureFormat::recordHeaderSize <= fileSize){
+			uint32_t length;
+			uint64_t timestampNs;
+			memcpy(&length, base + offset, sizeof(length));
+			memcpy(&timestampNs, base + offset + 8, sizeof(timestampNs));
+			if(length == 0 || offset + ofSerialCaptureFormat::recordHeaderSize + length > fileSize){
+				break;
+			}
+			if(base[offset + 4] == ofSerialCaptureFormat::Read){
+				totalBytes += length;
+				chunks.push_back({ offset + ofSerialCaptureFormat::recordHeaderSize, length, timestampNs, totalBytes });
+			}
+			offset += ofSerialCaptureFormat::getRecordSize(length);
+		}
+		// records are reserved in order but may be committed out of order
+		std::stable_sort(chunks.begin(), chunks.end(), [](const Chunk & a, const Chunk & b){
+			return a.timestampNs < b.timestampNs;
+		});
+		totalBytes = 0;
+		for(auto & chunk: chunks){
+			totalBytes += chunk.length;
+			chunk.endBytes = totalBytes;
+		}
+		rewind();
+		return true;
+	#else
+		std::cerr << "ofSerialReplay: not supported on this platform, can't open " << path << std::endl;
+		return false;
+	#endif
+}
+
+//----------------------------------------------------------------
+void ofSerialReplay::close(){
+	#ifndef TARGET_WIN32
+		if(base != nullptr){
+			munmap(base, fileSize);
+			base = nullptr;
+		}
+		if(fd != -1){
+			::close(fd);
+			fd = -1;
+		}
+	#endif
+	chunks.clear();
+	fileSize = 0;
+	totalBytes = 0;
+	consumed = 0;
+	chunkIndex = 0;
+}
+
+//----------------------------------------------------------------
+void ofSerialReplay::rewind(){
+	consumed = 0;
+	chunkIndex = 0;
+	clockStart = std::chrono::steady_clock::now();
+	// the silence before the first record is skipped
+	clockStartNs = chunks.empty() ? 0 : chunks.front().timestampNs;
+}
+
+//----------------------------------------------------------------
+void ofSerialReplay::setSpeed(double newSpeed){
+	uint64_t now = getCaptureTimeNs();
+	if(now == UINT64_MAX){
+		// coming from no waiting at all: carry on from the next record
+		now = chunkIndex < chunks.size() ? chunks[chunkIndex].timestampNs : 0;
+	}
+	speed = std::max(newSpeed, 0.0);
+	clockStart = std::chrono::steady_clock::now();
+	clockStartNs = now;
+}
+
+//----------------------------------------------------------------
+uint64_t ofSerialReplay::getCaptureTimeNs() const{
+	if(speed <= 0){
+		return UINT64_MAX;
+	}
+	const double elapsedNs = double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - clockStart).count());
+	return clockStartNs + uint64_t(elapsedNs * speed);
+}
+
+//----------------------------------------------------------------
+size_t ofSerialReplay::getDueBytes() const{
+	if(speed <= 0){
+		return totalBytes;
+	}
+	const uint64_t now = getCaptureTimeNs();
+	auto last = std::upper_bound(chunks.begin() + long(chunkIndex), chunks.end(), now, [](uint64_t time, const Chunk & chunk){
+		return time < chunk.timestampNs;
+	});
+	if(last == chunks.begin()){
+		return 0;
+	}
+	return std::prev(last)->endBytes;
+}
+
+//----------------------------------------------------------------
+size_t ofSerialReplay::available(){
+	const size_t due = getDueBytes();
+	return due > consumed ? due - consumed : 0;
+}
+
+//----------------------------------------------------------------
+size_t ofSerialReplay::consume(uint8_t * buffer, size_t length, const std::function<void(const uint8_t *, size_t)> * onData){
+	const size_t due = getDueBytes();
+	size_t done = 0;
+	while(done < length && consumed < due){
+		const Chunk & chunk = chunks[chunkIndex];
+		const size_t chunkBegin = chunk.endBytes - chunk.length;
+		const size_t n = std::min({ length - done, chunk.endBytes - consumed, due - consumed });
+		const uint8_t * data = base + chunk.offset + (consumed - chunkBegin);
+		if(onData != nullptr){
+			(*onData)(data, n);
+		} else {
+			memcpy(buffer + done, data, n);
+		}
+		done += n;
+		consumed += n;
+		if(consumed == chunk.endBytes){
+			chunkIndex++;
+		}
+	}
+	return done;
+}
+
+//----------------------------------------------------------------
+size_t ofSerialReplay::readBytes(uint8_t * buffer, size_t length){
+	return consume(buffer, length, nullptr);
+}
+
+//----------------------------------------------------------------
+int ofSerialReplay::readByte(){
+	uint8_t byte;
+	return consume(&byte, 1, nullptr) == 1 ? byte : OF_SERIAL_NO_DATA;
+}
+
+//----------------------------------------------------------------
+size_t ofSerialReplay::readFrames(ofSerialFrameDecoder & decoder, const std::function<void(std::span<const uint8_t> frame)> & onFrame){
+	size_t numFrames = 0;
+	const std::function<void(const uint8_t *, size_t)> feed = [&](const uint8_t * data, size_t length){
+		numFrames += decoder.feed(data, length, onFrame);
+	};
+	consume(nullptr, SIZE_MAX, &feed);
+	return numFrames;
+}
+
+//----------------------------------------------------------------
+bool ofSerialReplay::waitReadable(std::chrono::milliseconds timeout){
+	if(available() > 0){
+		return true;
+	}
+	if(chunkIndex >= chunks.size() || speed <= 0){
+		return false;
+	}
+	const double waitNs = double(chunks[chunkIndex].timestampNs - std::min(chunks[chunkIndex].timestampNs, getCaptureTimeNs())) / speed;
+	const auto wait = std::min(std::chrono::nanoseconds(uint64_t(waitNs) + 1), std::chrono::duration_cast<std::chrono::nanoseconds>(timeout));
+	std::this_thread::sleep_for(wait);
+	return available() > 0;
+}
+
+//----------------------------------------------------------------
+void ofSerialReplay::forEachWrite(const std::function<void(uint64_t timestampNs, std::span<const uint8_t> data)> & onWrite) const{
+	size_t offset = ofSerialCaptureFormat::headerSize;
+	while(base != nullptr && offset + ofSerialCaptureFormat::recordHeaderSize <= fileSize){
+		uint32_t length;
+		uint64_t timestampNs;
+		memcpy(&length, base + offset, sizeof(length));
+		memcpy(&timestampNs, base + offset + 8, sizeof(timestampNs));
+		if(length == 0 || offset + ofSerialCaptureFormat::recordHeaderSize + length > fileSize){
+			return;
+		}
+		if(base[offset + 4] == ofSerialCaptureFormat::Write){
+			onWrite(timestampNs, std::span<const uint8_t>(base + offset + ofSerialCaptureFormat::recordHeaderSize, length));
+		}
+		offset += ofSerialCaptureFormat::getRecordSize(length);
+	}
+}
@@ -0,0 +1,234 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+class ofSerialFrameDecoder;
+
+/// \brief Layout of a capture file, shared by ofSerialCapture and ofSerialReplay.
+///
+/// A 32 bytes header followed by records, each one 8 bytes aligned:
+/// length (4 bytes, the payload size, written last), direction (1 byte),
+/// 3 bytes of padding, the timestamp in nanoseconds since the capture
+/// was opened (8 bytes) and the payload. A length of 0 ends the file.
+struct ofSerialCaptureFormat {
+	static constexpr char magic[8] = { 'O', 'F', 'S', 'C', 'A', 'P', '1', '\0' };
+	static constexpr uint32_t version = 1;
+	static constexpr size_t headerSize = 32;
+	static constexpr size_t recordHeaderSize = 16;
+
+	enum Direction : uint8_t {
+		Read = 0,  ///< \brief Bytes received from the device.
+		Write = 1  ///< \brief Bytes sent to the device.
+	};
+
+	/// \returns the space taken by a record carrying 'length' bytes.
+	static constexpr size_t getRecordSize(size_t length){
+		return (recordHeaderSize + length + 7) & ~size_t(7);
+	}
+};
+
+/// \brief Appends the traffic of a port to a memory mapped file.
+///
+/// The file is sized to its capacity when opened and mapped, appending is
+/// an atomic reservation and a memcpy: the I/O threads never wait for the
+/// disk, the kernel writes the pages back on its own. When the capacity is
+/// reached records are dropped and counted instead. close() cuts the file
+/// to what was written.
+///
+/// ~~~~{.cpp}
+/// ofSerialCapture capture;
+/// capture.open("field.ofcap");
+/// serial.setCapture(&capture);
+/// // ... later, replay it with ofSerialReplay
+/// ~~~~
+///
+/// Several threads may append at once (the reader and the writer thread of
+/// a port, or several ports).
+class ofSerialCapture {
+
+public:
+	using Direction = ofSerialCaptureFormat::Direction;
+	static constexpr Direction Read = ofSerialCaptureFormat::Read;
+	static constexpr Direction Write = ofSerialCaptureFormat::Write;
+
+	static constexpr size_t defaultCapacity = size_t(256) << 20;
+
+	ofSerialCapture() = default;
+	~ofSerialCapture();
+
+	ofSerialCapture(const ofSerialCapture &) = delete;
+	ofSerialCapture & operator=(const ofSerialCapture &) = delete;
+
+	/// \brief Creates (or replaces) 'path' and maps 'capacity' bytes of it.
+	bool open(const std::string & path, size_t capacity = defaultCapacity);
+
+	/// \brief Unmaps the file and truncates it to the records written.
+	///
+	/// Nothing may append while it runs, detach the ports first.
+	void close();
+
+	bool isOpen() const{
+		return base != nullptr;
+	}
+
+	/// \brief Appends one record, does nothing for empty payloads.
+	/// \returns false if the capture is not opened or full.
+	bool append(Direction direction, const uint8_t * data, size_t length);
+
+	/// \brief Appends the first 'length' bytes of several buffers as one record.
+	bool append(Direction direction, const std::span<const uint8_t> * segments, size_t count, size_t length);
+
+	/// \returns the bytes used in the file, header included.
+	size_t getSize() const{
+		return std::min(used.load(std::memory_order_relaxed), capacity);
+	}
+
+	uint64_t getNumRecords() const{
+		return numRecords.load(std::memory_order_relaxed);
+	}
+
+	/// \returns the payload bytes that did not fit.
+	uint64_t getDroppedBytes() const{
+		return droppedBytes.load(std::memory_order_relaxed);
+	}
+
+protected:
+	/// \cond INTERNAL
+	uint8_t * reserve(size_t length);
+	void commit(uint8_t * record, Direction direction, size_t length);
+
+	int fd = -1;
+	uint8_t * base = nullptr;
+	size_t capacity = 0;
+	std::chrono::steady_clock::time_point start;
+	std::atomic<size_t> used{0};
+	std::atomic<uint64_t> numRecords{0};
+	std::atomic<uint64_t> droppedBytes{0};
+	/// \endcond
+};
+
+/// \brief Plays a capture back with the reading API of ofSerial.
+///
+/// The received bytes become available as they did on the wire: at the
+/// recorded pace, N times faster, or all at once. Code written against
+/// ofSerial (readBytes(), available(), readFrames()...) can be run on it to
+/// reproduce a field issue or benchmark a decoder on real traffic. Writes
+/// are accepted and dropped, the recorded ones can be walked with
+/// forEachWrite() to compare them.
+///
+/// ~~~~{.cpp}
+/// ofSerialReplay replay;
+/// replay.open("field.ofcap");
+/// replay.setSpeed(0); // as fast as possible
+/// while(!replay.isFinished()){
+///	 replay.readFrames(decoder, onFrame);
+/// }
+/// ~~~~
+class ofSerialReplay {
+
+public:
+	ofSerialReplay() = default;
+	~ofSerialReplay();
+
+	ofSerialReplay(const ofSerialReplay &) = delete;
+	ofSerialReplay & operator=(const ofSerialReplay &) = delete;
+
+	/// \brief Maps a capture file and starts the clock.
+	bool open(const std::string & path);
+
+	void close();
+
+	bool isInitialized() const{
+		return base != nullptr;
+	}
+
+	/// \brief Sets the playback speed, the clock restarts from the current position.
+	/// \param speed 1 for the recorded pace, 10 for ten times faster, 0 for no waiting at all.
+	void setSpeed(double speed);
+
+	double getSpeed() const{
+		return speed;
+	}
+
+	/// \brief Goes back to the first record and restarts the clock.
+	void rewind();
+
+	/// \returns true once every received byte was read.
+	bool isFinished() const{
+		return consumed == totalBytes;
+	}
+
+	/// \returns the received bytes due by now and not read yet.
+	size_t available();
+
+	size_t readBytes(uint8_t * buffer, size_t length);
+	size_t readInto(std::span<uint8_t> buffer){
+		return readBytes(buffer.data(), buffer.size());
+	}
+
+	/// \returns the next byte, or OF_SERIAL_NO_DATA (-2) if none is due.
+	int readByte();
+
+	/// \brief Feeds what is due to a decoder, straight from the mapping.
+	/// \returns The number of frames passed to onFrame.
+	size_t readFrames(ofSerialFrameDecoder & decoder, const std::function<void(std::span<const uint8_t> frame)> & onFrame);
+
+	/// \brief Sleeps until the next received bytes are due, or 'timeout'.
+	/// \returns true if bytes are available.
+	bool waitReadable(std::chrono::milliseconds timeout);
+
+	size_t writeBytes(const uint8_t *, size_t length){
+		return length;
+	}
+	size_t writeBytes(const char *, size_t length){
+		return length;
+	}
+
+	/// \brief Calls 'onWrite' with every recorded write, with its timestamp in nanoseconds.
+	void forEachWrite(const std::function<void(uint64_t timestampNs, std::span<const uint8_t> data)> & onWrite) const;
+
+	/// \returns the number of received bytes in the capture.
+	size_t getTotalBytes() const{
+		return totalBytes;
+	}
+
+protected:
+	/// \cond INTERNAL
+	struct Chunk {
+		size_t offset;  ///< \brief Of the payload in the file.
+		size_t length;
+		uint64_t timestampNs;
+		size_t endBytes;  ///< \brief Received bytes up to the end of this chunk.
+	};
+
+	/// \returns the capture time the clock has reached.
+	uint64_t getCaptureTimeNs() const;
+	/// \returns the received bytes due at this time.
+	size_t getDueBytes() const;
+	/// \brief Copies up to 'length' due bytes, or hands them to 'onData' when 'buffer' is null.
+	size_t consume(uint8_t * buffer, size_t length, const std::function<void(const uint8_t *, size_t)> * onData);
+
+	int fd = -1;
+	uint8_t * base = nullptr;
+	size_t fileSize = 0;
+	std::vector<Chunk> chunks;  ///< \brief The received records, in order.
+	size_t totalBytes = 0;
+	size_t consumed = 0;  ///< \brief Received bytes read so far.
+	size_t chunkIndex = 0;  ///< \brief Chunk holding the next byte to read.
+	double speed = 1;
+	std::chrono::steady_clock::time_point clockStart;
+	uint64_t clockStartNs = 0;  ///< \brief Capture time matching clockStart.
+	/// \endcond
+};
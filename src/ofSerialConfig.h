@@ -0,0 +1,164 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include "ofSerial.h"
+
+#ifndef TARGET_WIN32
+
+/// \brief Turns 'options' into a raw port with the given frame format and profile.
+///
+/// Only the flags ofSerial cares about are touched, the rest of 'options'
+/// is kept, and the speed is left to cfsetispeed()/cfsetospeed(). Being
+/// constexpr, it serves ofSerial::setup() at runtime and ofSerialConfig at
+/// compile time.
+constexpr struct termios ofSerialMakeTermios(struct termios options, size_t data, size_t parity, size_t stop, uint8_t minBytes, uint8_t interByteDeciseconds){
+	options.c_cflag &= ~tcflag_t(CSIZE | PARENB | PARODD | CSTOPB); // Clear all bits that set the data size and the framing
+	options.c_cflag |= data == 5 ? CS5 : data == 6 ? CS6 : data == 7 ? CS7 : CS8;
+	if(parity != OF_SERIAL_PARITY_N){
+		options.c_cflag |= PARENB; // Enable parity bit
+		if(parity == OF_SERIAL_PARITY_O){
+			options.c_cflag |= PARODD; // Odd parity
+		}
+	}
+	if(stop == 2){
+		options.c_cflag |= CSTOPB; // Two stop bits used in communication
+	}
+
+	#if defined( TARGET_LINUX )
+		options.c_cflag &= ~tcflag_t(CRTSCTS); // Disable RTS/CTS hardware flow control (most common)
+	#endif
+
+	options.c_cflag |= CREAD | CLOCAL; // Turn on READ & ignore ctrl lines (CLOCAL = 1)
+
+	#if defined( TARGET_LINUX )
+		options.c_lflag &= ~tcflag_t(ICANON | ECHO); // Disable canonical mode and echo
+		options.c_lflag &= ~tcflag_t(ISIG); // Disable interpretation of INTR, QUIT and SUSP
+		options.c_iflag &= ~tcflag_t(IXON | IXOFF | IXANY); // Turn off s/w flow ctrl
+	#endif
+
+	options.c_lflag &= ~tcflag_t(ECHOE | ECHONL); // Disable erasure and new-line echo
+	options.c_iflag &= ~tcflag_t(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL); // Disable any special handling of received bytes
+	options.c_oflag &= ~tcflag_t(OPOST | ONLCR); // Prevent special interpretation of output bytes (e.g. newline chars)
+
+	#if defined( TARGET_OSX )
+		options.c_oflag &= ~tcflag_t(OXTABS | ONOEOT); // Prevent conversion of tabs to spaces and removal of C-d chars
+	#endif
+
+	// the port is non blocking, VMIN/VTIME shape the poll() wake ups, see ofSerialProfile
+	options.c_cc[VTIME] = interByteDeciseconds;
+	options.c_cc[VMIN] = minBytes;
+	return options;
+}
+
+/// \brief The termios constant (Bxxx) of a rate, if the platform has one.
+/// \returns false if there is none.
+constexpr bool ofSerialFindSpeed(size_t baud, speed_t & speed){
+	struct BaudSpeed {
+		size_t baud;
+		speed_t speed;
+	};
+	constexpr BaudSpeed baudSpeeds[] = {
+		{ 50, B50 }, { 75, B75 }, { 110, B110 }, { 134, B134 }, { 150, B150 },
+		{ 200, B200 }, { 300, B300 }, { 600, B600 }, { 1200, B1200 },
+		{ 1800, B1800 }, { 2400, B2400 }, { 4800, B4800 }, { 9600, B9600 },
+		{ 19200, B19200 }, { 38400, B38400 }, { 57600, B57600 },
+		{ 115200, B115200 }, { 230400, B230400 },
+	#ifdef B460800
+		{ 460800, B460800 },
+	#endif
+	#ifdef B500000
+		{ 500000, B500000 },
+	#endif
+	#ifdef B576000
+		{ 576000, B576000 },
+	#endif
+	#ifdef B921600
+		{ 921600, B921600 },
+	#endif
+	#ifdef B1000000
+		{ 1000000, B1000000 },
+	#endif
+	#ifdef B1152000
+		{ 1152000, B1152000 },
+	#endif
+	#ifdef B1500000
+		{ 1500000, B1500000 },
+	#endif
+	#ifdef B2000000
+		{ 2000000, B2000000 },
+	#endif
+	#ifdef B2500000
+		{ 2500000, B2500000 },
+	#endif
+	#ifdef B3000000
+		{ 3000000, B3000000 },
+	#endif
+	#ifdef B3500000
+		{ 3500000, B3500000 },
+	#endif
+	#ifdef B4000000
+		{ 4000000, B4000000 },
+	#endif
+	};
+	for(auto & entry: baudSpeeds){
+		if(entry.baud == baud){
+			speed = entry.speed;
+			return true;
+		}
+	}
+	return false;
+}
+
+#endif // TARGET_WIN32
+
+/// \brief A port configuration checked and built at compile time.
+///
+/// Illegal combinations do not compile. ofSerial::setup(portName, config)
+/// computes the termios flags with apply() on top of the attributes the
+/// port had, sets the speed and applies them with a single tcsetattr().
+///
+/// ~~~~{.cpp}
+/// using Sensor = ofSerialConfig<115200, 8, OF_SERIAL_PARITY_E, 1, ofSerialProfile::bulk(32)>;
+/// for(auto & port: ports){
+///	 port.serial.setup(port.path, Sensor{});
+/// }
+/// ~~~~
+///
+/// Rates without a termios constant are refused here, ofSerial::setup()
+/// with a runtime rate handles them with an extra ioctl.
+template<size_t Baud, size_t Data = 8, size_t Parity = OF_SERIAL_PARITY_N, size_t Stop = 1, ofSerialProfile Profile = ofSerialProfile::lowLatency()>
+struct ofSerialConfig {
+	static_assert(Data >= 5 && Data <= 8, "ofSerialConfig: data bits must be 5, 6, 7 or 8");
+	static_assert(Parity == OF_SERIAL_PARITY_N || Parity == OF_SERIAL_PARITY_O || Parity == OF_SERIAL_PARITY_E, "ofSerialConfig: parity must be OF_SERIAL_PARITY_N, _O or _E");
+	static_assert(Stop == 1 || Stop == 2, "ofSerialConfig: stop bits must be 1 or 2");
+	static_assert(Profile.minBytes >= 1, "ofSerialConfig: the profile must wait for at least one byte");
+
+	static constexpr bool isSerialConfig = true;
+	static constexpr size_t baud = Baud;
+	static constexpr size_t data = Data;
+	static constexpr size_t parity = Parity;
+	static constexpr size_t stop = Stop;
+	static constexpr ofSerialProfile profile = Profile;
+
+#ifndef TARGET_WIN32
+	static constexpr speed_t getSpeed(){
+		speed_t speed = 0;
+		ofSerialFindSpeed(Baud, speed);
+		return speed;
+	}
+
+	static_assert([]{ speed_t speed = 0; return ofSerialFindSpeed(Baud, speed); }(), "ofSerialConfig: this rate has no termios constant on this platform");
+
+	static constexpr speed_t speed = getSpeed();
+
+	/// \brief Applies the configuration to 'options', at compile time when 'options' is a constant.
+	static constexpr struct termios apply(struct termios options){
+		return ofSerialMakeTermios(options, Data, Parity, Stop, Profile.minBytes, Profile.interByteDeciseconds);
+	}
+#else
+	static_assert(Baud > 0 && Baud <= UINT32_MAX, "ofSerialConfig: the rate does not fit a DCB");
+#endif
+};
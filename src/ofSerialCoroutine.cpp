@@ -0,0 +1,284 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialCoroutine.h"
+
+#ifdef TARGET_LINUX
+
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+//----------------------------------------------------------------
+void ofSerialSchedulerTaskDone(ofSerialScheduler * scheduler, std::coroutine_handle<> handle){
+	scheduler->taskDone(handle);
+}
+
+//----------------------------------------------------------------
+ofSerialScheduler::ofSerialScheduler(){
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if(epollFd == -1){
+		std::cerr << "ofSerialScheduler(): epoll_create1 failed: " << strerror(errno) << std::endl;
+		return;
+	}
+	if(timerWheel.getFileDescriptor() != -1){
+		struct epoll_event ev = {};
+		ev.events = EPOLLIN;
+		ev.data.fd = timerWheel.getFileDescriptor();
+		epoll_ctl(epollFd, EPOLL_CTL_ADD, timerWheel.getFileDescriptor(), &ev);
+	}
+}
+
+//----------------------------------------------------------------
+ofSerialScheduler::~ofSerialScheduler(){
+	// the frames unlink their timers from the wheel, which is still there
+	for(void * frame: tasks){
+		std::coroutine_handle<>::from_address(frame).destroy();
+	}
+	tasks.clear();
+	if(epollFd != -1){
+		::close(epollFd);
+	}
+}
+
+//----------------------------------------------------------------
+bool ofSerialScheduler::isValid() const{
+	return epollFd != -1;
+}
+
+//----------------------------------------------------------------
+void ofSerialScheduler::spawn(ofSerialTask<void> && task){
+	auto handle = task.release();
+	handle.promise().scheduler = this;
+	tasks.insert(handle.address());
+	handle.resume();
+}
+
+//----------------------------------------------------------------
+void ofSerialScheduler::taskDone(std::coroutine_handle<> handle){
+	// called from the final suspend point, the frame can go
+	tasks.erase(handle.address());
+	handle.destroy();
+}
+
+//----------------------------------------------------------------
+ofSerialScheduler::Watch * ofSerialScheduler::getWatch(int fd){
+	auto found = watches.find(fd);
+	if(found != watches.end()){
+		return found->second.get();
+	}
+
+	// edge triggered: waiters always drain the port to EAGAIN before suspending
+	struct epoll_event ev = {};
+	ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+	ev.data.fd = fd;
+	if(epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0){
+		std::cerr << "ofSerialScheduler: epoll_ctl failed: " << strerror(errno) << std::endl;
+		return nullptr;
+	}
+	auto watch = std::make_unique<Watch>();
+	watch->fd = fd;
+	return watches.emplace(fd, std::move(watch)).first->second.get();
+}
+
+//----------------------------------------------------------------
+bool ofSerialScheduler::waitReadable(int fd, Waiter * waiter){
+	Watch * watch = getWatch(fd);
+	if(watch == nullptr){
+		return false;
+	}
+	watch->reader = waiter;
+	return true;
+}
+
+//----------------------------------------------------------------
+bool ofSerialScheduler::waitWritable(int fd, Waiter * waiter){
+	Watch * watch = getWatch(fd);
+	if(watch == nullptr){
+		return false;
+	}
+	watch->writer = waiter;
+	return true;
+}
+
+//----------------------------------------------------------------
+void ofSerialScheduler::cancelWait(int fd, Waiter * waiter){
+	auto found = watches.find(fd);
+	if(found == watches.end()){
+		return;
+	}
+	if(found->second->reader == waiter){
+		found->second->reader = nullptr;
+	}
+	if(found->second->writer == waiter){
+		found->second->writer = nullptr;
+	}
+}
+
+//----------------------------------------------------------------
+bool ofSerialScheduler::isHungUp(int fd) const{
+	auto found = watches.find(fd);
+	return found != watches.end() && found->second->bHungUp;
+}
+
+//----------------------------------------------------------------
+void ofSerialScheduler::forget(int fd){
+	if(watches.erase(fd) > 0){
+		epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+	}
+}
+
+//----------------------------------------------------------------
+int ofSerialScheduler::poll(int timeoutMs){
+	if(!isValid()){
+		return -1;
+	}
+
+	constexpr int maxEvents = 64;
+	struct epoll_event events[maxEvents];
+	const int nEvents = epoll_wait(epollFd, events, maxEvents, timeoutMs);
+	if(nEvents < 0){
+		if(errno == EINTR){
+			return 0;
+		}
+		std::cerr << "poll(): epoll_wait failed: " << strerror(errno) << std::endl;
+		return -1;
+	}
+
+	int resumed = 0;
+	for(int i = 0; i < nEvents; i++){
+		if(events[i].data.fd == timerWheel.getFileDescriptor()){
+			resumed += int(timerWheel.advance());
+			continue;
+		}
+		// looked up again for every event, a resumed coroutine may have forgotten the port
+		auto found = watches.find(events[i].data.fd);
+		if(found == watches.end()){
+			continue;
+		}
+		Watch * watch = found->second.get();
+		const uint32_t flags = events[i].events;
+		const bool hangup = (flags & (EPOLLHUP | EPOLLRDHUP | EPOLLERR)) != 0;
+		if(hangup){
+			watch->bHungUp = true;
+		}
+
+		const int fd = watch->fd;
+		if((flags & EPOLLIN || hangup) && watch->reader != nullptr){
+			Waiter * reader = watch->reader;
+			watch->reader = nullptr;
+			reader->onReady();
+			resumed++;
+		}
+		found = watches.find(fd);
+		if(found == watches.end()){
+			continue;
+		}
+		watch = found->second.get();
+		if((flags & EPOLLOUT || hangup) && watch->writer != nullptr){
+			Waiter * writer = watch->writer;
+			watch->writer = nullptr;
+			writer->onReady();
+			resumed++;
+		}
+	}
+	return resumed;
+}
+
+//----------------------------------------------------------------
+void ofSerialScheduler::run(){
+	bRunning = true;
+	while(bRunning && !tasks.empty()){
+		if(poll(-1) < 0){
+			break;
+		}
+	}
+	bRunning = false;
+}
+
+//----------------------------------------------------------------
+void ofSerialScheduler::stop(){
+	bRunning = false;
+}
+
+//----------------------------------------------------------------
+ofSerialCoroutinePort::ofSerialCoroutinePort(ofSerialScheduler & scheduler, ofSerial & port)
+:scheduler(scheduler)
+,port(port)
+,fd(port.getFileDescriptor()){
+	if(fd == -1){
+		std::cerr << "ofSerialCoroutinePort(): serial not inited" << std::endl;
+	}
+}
+
+//----------------------------------------------------------------
+ofSerialCoroutinePort::~ofSerialCoroutinePort(){
+	if(fd != -1){
+		scheduler.forget(fd);
+	}
+}
+
+//----------------------------------------------------------------
+void ofSerialCoroutinePort::Operation::wait(){
+	const bool bWaiting = bWrite ? owner.scheduler.waitWritable(owner.fd, this) : owner.scheduler.waitReadable(owner.fd, this);
+	if(!bWaiting){
+		// nothing will ever wake us up, give back what we have
+		timer.cancel();
+		awaiting.resume();
+	}
+}
+
+//----------------------------------------------------------------
+void ofSerialCoroutinePort::Operation::onTimeout(){
+	bTimedOut = true;
+	owner.scheduler.cancelWait(owner.fd, this);
+	awaiting.resume();
+}
+
+//----------------------------------------------------------------
+bool ofSerialCoroutinePort::ReadExactly::attempt(){
+	while(done < buffer.size()){
+		const size_t nRead = owner.port.readBytes(buffer.data() + done, buffer.size() - done);
+		if(nRead == 0){
+			return owner.fd == -1 || owner.scheduler.isHungUp(owner.fd);
+		}
+		done += nRead;
+	}
+	return true;
+}
+
+//----------------------------------------------------------------
+bool ofSerialCoroutinePort::ReadExactlyVector::attempt(){
+	while(bytes.size() < length){
+		if(owner.port.readAppend(bytes, length - bytes.size()) == 0){
+			return owner.fd == -1 || owner.scheduler.isHungUp(owner.fd);
+		}
+	}
+	return true;
+}
+
+//----------------------------------------------------------------
+bool ofSerialCoroutinePort::ReadUntil::attempt(){
+	if(owner.port.tryReadStringUntil(delimiter, line)){
+		bFound = true;
+		return true;
+	}
+	return owner.fd == -1 || owner.scheduler.isHungUp(owner.fd);
+}
+
+//----------------------------------------------------------------
+bool ofSerialCoroutinePort::Write::attempt(){
+	while(done < buffer.size()){
+		const size_t nWritten = owner.port.writeSome(buffer.data() + done, buffer.size() - done);
+		if(nWritten == 0){
+			return owner.fd == -1 || owner.scheduler.isHungUp(owner.fd);
+		}
+		done += nWritten;
+	}
+	return true;
+}
+
+#endif // TARGET_LINUX
@@ -0,0 +1,463 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include "ofSerial.h"
+#include "ofSerialTimerWheel.h"
+
+#ifdef TARGET_LINUX
+
+#include <coroutine>
+#include <cstdlib>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+class ofSerialScheduler;
+
+/// \cond INTERNAL
+/// \brief State shared by the promises of every ofSerialTask.
+struct ofSerialTaskPromiseBase {
+	std::coroutine_handle<> continuation;  ///< \brief Coroutine awaiting this task.
+	ofSerialScheduler * scheduler = nullptr;  ///< \brief Set for tasks started by ofSerialScheduler::spawn().
+
+	std::suspend_always initial_suspend() noexcept{
+		return {};
+	}
+
+	// the library is built with -fno-exceptions
+	void unhandled_exception() noexcept{
+		std::abort();
+	}
+};
+
+void ofSerialSchedulerTaskDone(ofSerialScheduler * scheduler, std::coroutine_handle<> handle);
+/// \endcond
+
+/// \brief Coroutine type of the serial conversations.
+///
+/// A task starts when it is awaited, or when it is handed to
+/// ofSerialScheduler::spawn(). It resumes the coroutine awaiting it once it
+/// returns.
+///
+/// ~~~~{.cpp}
+/// ofSerialTask<std::optional<std::string>> query(ofSerialCoroutinePort & port, std::string command){
+///	 co_await port.write(command);
+///	 co_return co_await port.readUntil('\n');
+/// }
+/// ~~~~
+template<typename T = void>
+class ofSerialTask {
+
+public:
+	/// \cond INTERNAL
+	struct promise_type;
+	using Handle = std::coroutine_handle<promise_type>;
+
+	struct FinalAwaiter {
+		bool await_ready() noexcept{
+			return false;
+		}
+		std::coroutine_handle<> await_suspend(Handle handle) noexcept{
+			auto & promise = handle.promise();
+			if(promise.scheduler != nullptr){
+				ofSerialSchedulerTaskDone(promise.scheduler, handle);
+				return std::noop_coroutine();
+			}
+			return promise.continuation ? promise.continuation : std::noop_coroutine();
+		}
+		void await_resume() noexcept{
+		}
+	};
+
+	struct promise_type: ofSerialTaskPromiseBase {
+		std::optional<T> value;
+
+		ofSerialTask get_return_object(){
+			return ofSerialTask(Handle::from_promise(*this));
+		}
+		FinalAwaiter final_suspend() noexcept{
+			return {};
+		}
+		template<typename U>
+		void return_value(U && result){
+			value.emplace(std::forward<U>(result));
+		}
+	};
+	/// \endcond
+
+	ofSerialTask(ofSerialTask && other) noexcept: handle(other.handle){
+		other.handle = nullptr;
+	}
+	ofSerialTask(const ofSerialTask &) = delete;
+	ofSerialTask & operator=(const ofSerialTask &) = delete;
+
+	~ofSerialTask(){
+		if(handle){
+			handle.destroy();
+		}
+	}
+
+	/// \cond INTERNAL
+	bool await_ready() const noexcept{
+		return false;
+	}
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept{
+		handle.promise().continuation = awaiting;
+		return handle;
+	}
+	T await_resume(){
+		return std::move(*handle.promise().value);
+	}
+
+	/// \brief Gives the coroutine frame away, used by ofSerialScheduler::spawn().
+	Handle release(){
+		Handle released = handle;
+		handle = nullptr;
+		return released;
+	}
+	/// \endcond
+
+protected:
+	explicit ofSerialTask(Handle handle): handle(handle){
+	}
+
+	Handle handle;
+};
+
+/// \brief ofSerialTask returning nothing, the kind ofSerialScheduler::spawn() takes.
+template<>
+class ofSerialTask<void> {
+
+public:
+	/// \cond INTERNAL
+	struct promise_type;
+	using Handle = std::coroutine_handle<promise_type>;
+
+	struct FinalAwaiter {
+		bool await_ready() noexcept{
+			return false;
+		}
+		std::coroutine_handle<> await_suspend(Handle handle) noexcept{
+			auto & promise = handle.promise();
+			if(promise.scheduler != nullptr){
+				ofSerialSchedulerTaskDone(promise.scheduler, handle);
+				return std::noop_coroutine();
+			}
+			return promise.continuation ? promise.continuation : std::noop_coroutine();
+		}
+		void await_resume() noexcept{
+		}
+	};
+
+	struct promise_type: ofSerialTaskPromiseBase {
+		ofSerialTask get_return_object(){
+			return ofSerialTask(Handle::from_promise(*this));
+		}
+		FinalAwaiter final_suspend() noexcept{
+			return {};
+		}
+		void return_void(){
+		}
+	};
+	/// \endcond
+
+	ofSerialTask(ofSerialTask && other) noexcept: handle(other.handle){
+		other.handle = nullptr;
+	}
+	ofSerialTask(const ofSerialTask &) = delete;
+	ofSerialTask & operator=(const ofSerialTask &) = delete;
+
+	~ofSerialTask(){
+		if(handle){
+			handle.destroy();
+		}
+	}
+
+	/// \cond INTERNAL
+	bool await_ready() const noexcept{
+		return false;
+	}
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept{
+		handle.promise().continuation = awaiting;
+		return handle;
+	}
+	void await_resume(){
+	}
+
+	Handle release(){
+		Handle released = handle;
+		handle = nullptr;
+		return released;
+	}
+	/// \endcond
+
+protected:
+	explicit ofSerialTask(Handle handle): handle(handle){
+	}
+
+	Handle handle;
+};
+
+/// \brief Runs serial coroutines from a single thread with epoll.
+///
+/// Each suspended read or write registers its port with epoll and the
+/// coroutine is resumed when the port is ready, so one thread can hold
+/// thousands of conversations written as sequential code.
+///
+/// ~~~~{.cpp}
+/// ofSerialScheduler scheduler;
+/// ofSerialCoroutinePort port(scheduler, serial);
+/// scheduler.spawn(conversation(port));
+/// scheduler.run(); // returns when every spawned task is done
+/// ~~~~
+///
+/// Reads and writes given a timeout arm a timer on the scheduler's
+/// ofSerialTimerWheel, whose timerfd is watched with the ports.
+///
+/// Destroying the scheduler destroys the tasks that did not return, with the
+/// locals of their suspended coroutines.
+class ofSerialScheduler {
+
+public:
+	/// \cond INTERNAL
+	/// \brief Something suspended until a file descriptor is ready.
+	struct Waiter {
+		/// \brief Called when the file descriptor is ready, or hung up.
+		virtual void onReady() = 0;
+	protected:
+		~Waiter() = default;
+	};
+	/// \endcond
+
+	ofSerialScheduler();
+	~ofSerialScheduler();
+
+	ofSerialScheduler(const ofSerialScheduler &) = delete;
+	ofSerialScheduler & operator=(const ofSerialScheduler &) = delete;
+
+	/// \returns true if the epoll instance was created.
+	bool isValid() const;
+
+	/// \brief Starts a task, the scheduler owns it until it returns.
+	void spawn(ofSerialTask<void> && task);
+
+	/// \returns The number of spawned tasks that did not return yet.
+	size_t getNumTasks() const{
+		return tasks.size();
+	}
+
+	/// \brief Waits for events and resumes the coroutines once.
+	/// \param timeoutMs Maximum time to wait, -1 waits forever.
+	/// \returns the number of resumed waiters, or -1 on error.
+	int poll(int timeoutMs = -1);
+
+	/// \brief Resumes coroutines until every task returned or stop() is called.
+	void run();
+
+	/// \brief Makes run() return after the current iteration.
+	void stop();
+
+	/// \brief The wheel advanced by poll(), its timers run on the scheduler thread.
+	ofSerialTimerWheel & getTimerWheel(){
+		return timerWheel;
+	}
+
+	/// \cond INTERNAL
+	/// \returns false if the file descriptor can't be watched, the waiter won't be called.
+	bool waitReadable(int fd, Waiter * waiter);
+	bool waitWritable(int fd, Waiter * waiter);
+	void cancelWait(int fd, Waiter * waiter);
+	bool isHungUp(int fd) const;
+	void forget(int fd);
+	void taskDone(std::coroutine_handle<> handle);
+	/// \endcond
+
+protected:
+	/// \cond INTERNAL
+	struct Watch {
+		int fd;
+		Waiter * reader = nullptr;
+		Waiter * writer = nullptr;
+		bool bHungUp = false;
+	};
+
+	Watch * getWatch(int fd);
+
+	int epollFd = -1;
+	ofSerialTimerWheel timerWheel;
+	std::unordered_set<void *> tasks;  ///< \brief Frame addresses of the spawned tasks that did not return, owned by the scheduler.
+	bool bRunning = false;
+	std::unordered_map<int, std::unique_ptr<Watch>> watches;
+	/// \endcond
+};
+
+/// \brief An ofSerial port used from coroutines run by an ofSerialScheduler.
+///
+/// The awaitables read and write without blocking and suspend the coroutine
+/// while the port is not ready. Reads return early (short, or empty) if the
+/// device goes away, or once the optional timeout passed. Only one coroutine
+/// may read and one may write at a time, the reader and writer threads of
+/// ofSerial must not be running.
+///
+/// ~~~~{.cpp}
+/// ofSerialTask<> conversation(ofSerialCoroutinePort & port){
+///	 co_await port.write(std::string_view("VERSION?\n"));
+///	 std::optional<std::string> version = co_await port.readUntil('\n');
+///	 std::vector<uint8_t> header = co_await port.readExactly(16, std::chrono::milliseconds(100));
+///	 if(header.size() < 16){
+///		 // timed out, or the device went away
+///	 }
+/// }
+/// ~~~~
+class ofSerialCoroutinePort {
+
+public:
+	ofSerialCoroutinePort(ofSerialScheduler & scheduler, ofSerial & port);
+	~ofSerialCoroutinePort();
+
+	ofSerialCoroutinePort(const ofSerialCoroutinePort &) = delete;
+	ofSerialCoroutinePort & operator=(const ofSerialCoroutinePort &) = delete;
+
+	ofSerial & getPort(){
+		return port;
+	}
+
+	/// \cond INTERNAL
+	/// \brief Base of the awaitables: try the operation, suspend until the port is ready, try again.
+	struct Operation: ofSerialScheduler::Waiter {
+		Operation(ofSerialCoroutinePort & owner, bool bWrite, std::chrono::milliseconds timeout): owner(owner), bWrite(bWrite), timeout(timeout){
+		}
+		bool await_ready(){
+			return attempt();
+		}
+		void await_suspend(std::coroutine_handle<> handle){
+			awaiting = handle;
+			if(timeout.count() > 0){
+				timer.setCallback([this](){
+					onTimeout();
+				});
+				owner.scheduler.getTimerWheel().armAfter(timer, timeout);
+			}
+			wait();
+		}
+		void onReady() override{
+			if(attempt()){
+				timer.cancel();
+				awaiting.resume();
+			} else {
+				wait();
+			}
+		}
+		/// \returns true if the operation gave up because its timeout passed.
+		bool isTimedOut() const{
+			return bTimedOut;
+		}
+	protected:
+		~Operation() = default;
+		/// \returns true once the operation is complete, or the port hung up.
+		virtual bool attempt() = 0;
+		void wait();
+		void onTimeout();
+
+		ofSerialCoroutinePort & owner;
+		bool bWrite;
+		bool bTimedOut = false;
+		std::chrono::milliseconds timeout;  ///< \brief 0 waits as long as it takes.
+		ofSerialTimer timer;
+		std::coroutine_handle<> awaiting;
+	};
+
+	struct ReadExactly final: Operation {
+		ReadExactly(ofSerialCoroutinePort & owner, std::span<uint8_t> buffer, std::chrono::milliseconds timeout): Operation(owner, false, timeout), buffer(buffer){
+		}
+		size_t await_resume(){
+			return done;
+		}
+	protected:
+		bool attempt() override;
+		std::span<uint8_t> buffer;
+		size_t done = 0;
+	};
+
+	struct ReadExactlyVector final: Operation {
+		ReadExactlyVector(ofSerialCoroutinePort & owner, size_t length, std::chrono::milliseconds timeout): Operation(owner, false, timeout), length(length){
+			bytes.reserve(length);
+		}
+		std::vector<uint8_t> await_resume(){
+			return std::move(bytes);
+		}
+	protected:
+		bool attempt() override;
+		size_t length;
+		std::vector<uint8_t> bytes;
+	};
+
+	struct ReadUntil final: Operation {
+		ReadUntil(ofSerialCoroutinePort & owner, char delimiter, std::chrono::milliseconds timeout): Operation(owner, false, timeout), delimiter(delimiter){
+		}
+		std::optional<std::string> await_resume(){
+			if(!bFound){
+				return std::nullopt;
+			}
+			return std::move(line);
+		}
+	protected:
+		bool attempt() override;
+		char delimiter;
+		bool bFound = false;
+		std::string line;
+	};
+
+	struct Write final: Operation {
+		Write(ofSerialCoroutinePort & owner, std::span<const uint8_t> buffer, std::chrono::milliseconds timeout): Operation(owner, true, timeout), buffer(buffer){
+		}
+		size_t await_resume(){
+			return done;
+		}
+	protected:
+		bool attempt() override;
+		std::span<const uint8_t> buffer;
+		size_t done = 0;
+	};
+	/// \endcond
+
+	/// \brief Reads exactly buffer.size() bytes.
+	/// \param timeout Time allowed once the read has to wait, 0 waits as long as it takes.
+	/// \returns (co_await) The number of bytes read, less if the device went away or the timeout passed.
+	ReadExactly readExactly(std::span<uint8_t> buffer, std::chrono::milliseconds timeout = std::chrono::milliseconds(0)){
+		return ReadExactly(*this, buffer, timeout);
+	}
+
+	/// \brief Reads exactly 'length' bytes into a new vector.
+	ReadExactlyVector readExactly(size_t length, std::chrono::milliseconds timeout = std::chrono::milliseconds(0)){
+		return ReadExactlyVector(*this, length, timeout);
+	}
+
+	/// \brief Reads up to 'delimiter', which is dropped.
+	/// \returns (co_await) The line, which may be empty, or std::nullopt if the device went away or the timeout passed first.
+	ReadUntil readUntil(char delimiter, std::chrono::milliseconds timeout = std::chrono::milliseconds(0)){
+		return ReadUntil(*this, delimiter, timeout);
+	}
+
+	/// \brief Writes the whole buffer, the buffer must outlive the co_await.
+	/// \returns (co_await) The number of bytes written, less if the device went away or the timeout passed.
+	Write write(std::span<const uint8_t> buffer, std::chrono::milliseconds timeout = std::chrono::milliseconds(0)){
+		return Write(*this, buffer, timeout);
+	}
+
+	Write write(std::string_view buffer, std::chrono::milliseconds timeout = std::chrono::milliseconds(0)){
+		return Write(*this, std::span<const uint8_t>(reinterpret_cast<const uint8_t *>(buffer.data()), buffer.size()), timeout);
+	}
+
+protected:
+	/// \cond INTERNAL
+	ofSerialScheduler & scheduler;
+	ofSerial & port;
+	int fd;
+	/// \endcond
+};
+
+#endif // TARGET_LINUX
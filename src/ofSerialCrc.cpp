@@ -0,0 +1,260 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialCrc.h"
+
+#include <array>
+
+#if ( defined( __x86_64__ ) || defined( __i386__ ) ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+	#define OF_SERIAL_CRC_X86
+	#include <immintrin.h>
+#endif
+
+// Slicing-by-8: tables[k][b] is the CRC of byte b followed by k zero bytes,
+// so the CRC of 8 bytes is the xor of 8 lookups instead of 8 dependent steps.
+template<typename T>
+using Tables = std::array<std::array<T, 256>, 8>;
+
+//----------------------------------------------------------------
+template<typename T>
+static constexpr Tables<T> makeReflectedTables(T poly){
+	Tables<T> tables = {};
+	for(uint32_t b = 0; b < 256; b++){
+		T crc = T(b);
+		for(int bit = 0; bit < 8; bit++){
+			crc = (crc & 1) ? T((crc >> 1) ^ poly) : T(crc >> 1);
+		}
+		tables[0][b] = crc;
+	}
+	for(size_t k = 1; k < 8; k++){
+		for(size_t b = 0; b < 256; b++){
+			const T previous = tables[k - 1][b];
+			tables[k][b] = T((previous >> 8) ^ tables[0][previous & 0xFF]);
+		}
+	}
+	return tables;
+}
+
+//----------------------------------------------------------------
+static constexpr Tables<uint16_t> makeCcittTables(uint16_t poly){
+	Tables<uint16_t> tables = {};
+	for(uint32_t b = 0; b < 256; b++){
+		uint16_t crc = uint16_t(b << 8);
+		for(int bit = 0; bit < 8; bit++){
+			crc = (crc & 0x8000) ? uint16_t((crc << 1) ^ poly) : uint16_t(crc << 1);
+		}
+		tables[0][b] = crc;
+	}
+	for(size_t k = 1; k < 8; k++){
+		for(size_t b = 0; b < 256; b++){
+			const uint16_t previous = tables[k - 1][b];
+			tables[k][b] = uint16_t((previous << 8) ^ tables[0][previous >> 8]);
+		}
+	}
+	return tables;
+}
+
+static constexpr Tables<uint16_t> modbusTables = makeReflectedTables<uint16_t>(0xA001);
+static constexpr Tables<uint16_t> ccittTables = makeCcittTables(0x1021);
+static constexpr Tables<uint32_t> crc32Tables = makeReflectedTables<uint32_t>(0xEDB88320);
+
+static_assert(modbusTables[0][1] == 0xC0C1 && ccittTables[0][1] == 0x1021 && crc32Tables[0][1] == 0x77073096);
+
+//----------------------------------------------------------------
+static inline uint32_t loadLE32(const uint8_t * p){
+	return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+//----------------------------------------------------------------
+static inline uint32_t loadBE32(const uint8_t * p){
+	return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+//----------------------------------------------------------------
+template<typename T>
+static T updateReflected(const Tables<T> & t, T crc, const uint8_t * data, size_t length){
+	while(length >= 8){
+		const uint32_t one = loadLE32(data) ^ crc;
+		const uint32_t two = loadLE32(data + 4);
+		crc = T(t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24]
+			^ t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24]);
+		data += 8;
+		length -= 8;
+	}
+	while(length-- > 0){
+		crc = T((crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF]);
+	}
+	return crc;
+}
+
+//----------------------------------------------------------------
+uint16_t ofSerialCrc16Modbus::updateRegister(uint16_t crc, const uint8_t * data, size_t length){
+	return updateReflected(modbusTables, crc, data, length);
+}
+
+//----------------------------------------------------------------
+bool ofSerialCrc16Modbus::check(std::span<const uint8_t> frame){
+	if(frame.size() < 2){
+		return false;
+	}
+	const uint16_t crc = updateRegister(initial, frame.data(), frame.size() - 2);
+	return frame[frame.size() - 2] == uint8_t(crc) && frame[frame.size() - 1] == uint8_t(crc >> 8);
+}
+
+//----------------------------------------------------------------
+uint16_t ofSerialCrc16Ccitt::updateRegister(uint16_t crc, const uint8_t * data, size_t length){
+	const Tables<uint16_t> & t = ccittTables;
+	while(length >= 8){
+		const uint32_t one = loadBE32(data) ^ (uint32_t(crc) << 16);
+		const uint32_t two = loadBE32(data + 4);
+		crc = uint16_t(t[7][one >> 24] ^ t[6][(one >> 16) & 0xFF] ^ t[5][(one >> 8) & 0xFF] ^ t[4][one & 0xFF]
+			^ t[3][two >> 24] ^ t[2][(two >> 16) & 0xFF] ^ t[1][(two >> 8) & 0xFF] ^ t[0][two & 0xFF]);
+		data += 8;
+		length -= 8;
+	}
+	while(length-- > 0){
+		crc = uint16_t((crc << 8) ^ t[0][(crc >> 8) ^ *data++]);
+	}
+	return crc;
+}
+
+//----------------------------------------------------------------
+bool ofSerialCrc16Ccitt::check(std::span<const uint8_t> frame, uint16_t initialValue){
+	if(frame.size() < 2){
+		return false;
+	}
+	const uint16_t crc = updateRegister(initialValue, frame.data(), frame.size() - 2);
+	return frame[frame.size() - 2] == uint8_t(crc >> 8) && frame[frame.size() - 1] == uint8_t(crc);
+}
+
+//----------------------------------------------------------------
+uint32_t ofSerialCrc32::updateRegisterPortable(uint32_t reg, const uint8_t * data, size_t length){
+	return updateReflected(crc32Tables, reg, data, length);
+}
+
+#ifdef OF_SERIAL_CRC_X86
+
+// Folding constants for the reflected CRC-32 polynomial, x^n mod P for the
+// distances folded below, see Intel's "Fast CRC Computation for Generic
+// Polynomials Using PCLMULQDQ Instruction".
+alignas(16) static const uint64_t fold4[2] = { 0x0154442bd4, 0x01c6e41596 };  // 512 bits
+alignas(16) static const uint64_t fold1[2] = { 0x01751997d0, 0x00ccaa009e };  // 128 bits
+alignas(16) static const uint64_t fold64[2] = { 0x0163cd6124, 0 };  // 128 to 64 bits
+alignas(16) static const uint64_t barrett[2] = { 0x01db710641, 0x01f7011641 };  // P and its quotient
+
+//----------------------------------------------------------------
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t updatePclmul(uint32_t reg, const uint8_t * data, size_t length){
+	// the short and unaligned ends go through the tables
+	if(length < 64){
+		return updateReflected(crc32Tables, reg, data, length);
+	}
+	const size_t tail = length & 15;
+	length -= tail;
+
+	// four lanes of 128 bits, each folded 512 bits forward per iteration
+	__m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+	__m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16));
+	__m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 32));
+	__m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 48));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(int(reg)));
+	__m128i k = _mm_load_si128(reinterpret_cast<const __m128i *>(fold4));
+	data += 64;
+	length -= 64;
+
+	while(length >= 64){
+		const __m128i x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+		const __m128i x6 = _mm_clmulepi64_si128(x2, k, 0x00);
+		const __m128i x7 = _mm_clmulepi64_si128(x3, k, 0x00);
+		const __m128i x8 = _mm_clmulepi64_si128(x4, k, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, k, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, k, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, k, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i *>(data)));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 16)));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 32)));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + 48)));
+		data += 64;
+		length -= 64;
+	}
+
+	// fold the four lanes into one, then the remaining 128 bit blocks
+	k = _mm_load_si128(reinterpret_cast<const __m128i *>(fold1));
+	const __m128i * lanes[3] = { &x2, &x3, &x4 };
+	for(const __m128i * lane: lanes){
+		const __m128i low = _mm_clmulepi64_si128(x1, k, 0x00);
+		x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k, 0x11), *lane), low);
+	}
+	while(length >= 16){
+		const __m128i low = _mm_clmulepi64_si128(x1, k, 0x00);
+		x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k, 0x11), _mm_loadu_si128(reinterpret_cast<const __m128i *>(data))), low);
+		data += 16;
+		length -= 16;
+	}
+
+	// 128 to 64 bits
+	const __m128i mask32 = _mm_setr_epi32(-1, 0, -1, 0);
+	x2 = _mm_clmulepi64_si128(x1, k, 0x10);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+	k = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(fold64));
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, mask32), k, 0x00), x2);
+
+	// Barrett reduction to 32 bits
+	k = _mm_load_si128(reinterpret_cast<const __m128i *>(barrett));
+	x2 = _mm_and_si128(x1, mask32);
+	x2 = _mm_clmulepi64_si128(x2, k, 0x10);
+	x2 = _mm_and_si128(x2, mask32);
+	x2 = _mm_clmulepi64_si128(x2, k, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+	reg = uint32_t(_mm_extract_epi32(x1, 1));
+
+	return updateReflected(crc32Tables, reg, data, tail);
+}
+
+#endif // OF_SERIAL_CRC_X86
+
+//----------------------------------------------------------------
+struct KernelChoice {
+	uint32_t (*kernel)(uint32_t reg, const uint8_t * data, size_t length);
+	const char * name;
+};
+
+static const KernelChoice & getKernel(){
+	static const KernelChoice choice = [](){
+		#ifdef OF_SERIAL_CRC_X86
+			__builtin_cpu_init();
+			if(__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1")){
+				return KernelChoice{ updatePclmul, "pclmul" };
+			}
+		#endif
+		return KernelChoice{ ofSerialCrc32::updateRegisterPortable, "slicing-by-8" };
+	}();
+	return choice;
+}
+
+//----------------------------------------------------------------
+uint32_t ofSerialCrc32::updateRegister(uint32_t reg, const uint8_t * data, size_t length){
+	return getKernel().kernel(reg, data, length);
+}
+
+//----------------------------------------------------------------
+bool ofSerialCrc32::check(std::span<const uint8_t> frame){
+	if(frame.size() < 4){
+		return false;
+	}
+	const uint32_t crc = ~updateRegister(initial, frame.data(), frame.size() - 4);
+	for(size_t i = 0; i < 4; i++){
+		if(frame[frame.size() - 4 + i] != uint8_t(crc >> (8 * i))){
+			return false;
+		}
+	}
+	return true;
+}
+
+//----------------------------------------------------------------
+const char * ofSerialCrc32::getKernelName(){
+	return getKernel().name;
+}
@@ -0,0 +1,184 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/// \name Checksums
+///
+/// The CRCs serial devices append to their frames. Each class accumulates
+/// over as many update() calls as needed, so a frame can be checked while it
+/// arrives in chunks:
+///
+/// ~~~~{.cpp}
+/// ofSerialCrc16Modbus crc;
+/// crc.update(header);
+/// crc.update(payload);
+/// if(crc.get() != expected) ...
+///
+/// serial.readFrames(decoder, [](std::span<const uint8_t> frame){
+///	 if(ofSerialCrc16Modbus::check(frame)) ... // the frame ends with its CRC
+/// });
+/// ~~~~
+///
+/// The portable kernels read 8 bytes per step through 8 tables built at
+/// compile time (slicing-by-8). CRC-32 is folded with carry-less multiplies
+/// (PCLMULQDQ) on x86 CPUs that have them, picked once at runtime like
+/// ofSerialScanner. See bench/crc_bench.cpp.
+/// \{
+
+/// \brief CRC-16/MODBUS: polynomial 0x8005 reflected, initial value 0xFFFF.
+///
+/// Sent low byte first at the end of Modbus RTU frames.
+class ofSerialCrc16Modbus {
+
+public:
+	static constexpr uint16_t initial = 0xFFFF;
+
+	void update(const uint8_t * data, size_t length){
+		crc = updateRegister(crc, data, length);
+	}
+
+	void update(std::span<const uint8_t> data){
+		update(data.data(), data.size());
+	}
+
+	void reset(){
+		crc = initial;
+	}
+
+	/// \returns The CRC of everything passed to update() since the last reset().
+	uint16_t get() const{
+		return crc;
+	}
+
+	/// \brief Writes the CRC in wire order (low byte first), 2 bytes.
+	void write(uint8_t * out) const{
+		out[0] = uint8_t(crc);
+		out[1] = uint8_t(crc >> 8);
+	}
+
+	static uint16_t compute(std::span<const uint8_t> data){
+		return updateRegister(initial, data.data(), data.size());
+	}
+
+	/// \returns true if 'frame' ends with the CRC of what precedes it.
+	static bool check(std::span<const uint8_t> frame);
+
+	/// \brief Runs 'data' through the CRC register.
+	static uint16_t updateRegister(uint16_t crc, const uint8_t * data, size_t length);
+
+protected:
+	/// \cond INTERNAL
+	uint16_t crc = initial;
+	/// \endcond
+};
+
+/// \brief CRC-16/CCITT-FALSE: polynomial 0x1021, not reflected, initial value 0xFFFF.
+///
+/// Sent high byte first. Pass 0 as initial value for CRC-16/XMODEM.
+class ofSerialCrc16Ccitt {
+
+public:
+	static constexpr uint16_t initial = 0xFFFF;
+
+	explicit ofSerialCrc16Ccitt(uint16_t initialValue = initial)
+	:start(initialValue)
+	,crc(initialValue){
+	}
+
+	void update(const uint8_t * data, size_t length){
+		crc = updateRegister(crc, data, length);
+	}
+
+	void update(std::span<const uint8_t> data){
+		update(data.data(), data.size());
+	}
+
+	void reset(){
+		crc = start;
+	}
+
+	uint16_t get() const{
+		return crc;
+	}
+
+	/// \brief Writes the CRC in wire order (high byte first), 2 bytes.
+	void write(uint8_t * out) const{
+		out[0] = uint8_t(crc >> 8);
+		out[1] = uint8_t(crc);
+	}
+
+	static uint16_t compute(std::span<const uint8_t> data, uint16_t initialValue = initial){
+		return updateRegister(initialValue, data.data(), data.size());
+	}
+
+	static bool check(std::span<const uint8_t> frame, uint16_t initialValue = initial);
+
+	static uint16_t updateRegister(uint16_t crc, const uint8_t * data, size_t length);
+
+protected:
+	/// \cond INTERNAL
+	uint16_t start;
+	uint16_t crc;
+	/// \endcond
+};
+
+/// \brief CRC-32 (IEEE 802.3, zlib): polynomial 0x04C11DB7 reflected, initial value and final xor 0xFFFFFFFF.
+///
+/// Sent low byte first.
+class ofSerialCrc32 {
+
+public:
+	static constexpr uint32_t initial = 0xFFFFFFFF;
+
+	void update(const uint8_t * data, size_t length){
+		reg = updateRegister(reg, data, length);
+	}
+
+	void update(std::span<const uint8_t> data){
+		update(data.data(), data.size());
+	}
+
+	void reset(){
+		reg = initial;
+	}
+
+	uint32_t get() const{
+		return ~reg;
+	}
+
+	/// \brief Writes the CRC in wire order (low byte first), 4 bytes.
+	void write(uint8_t * out) const{
+		const uint32_t crc = get();
+		for(size_t i = 0; i < 4; i++){
+			out[i] = uint8_t(crc >> (8 * i));
+		}
+	}
+
+	static uint32_t compute(std::span<const uint8_t> data){
+		return ~updateRegister(initial, data.data(), data.size());
+	}
+
+	static bool check(std::span<const uint8_t> frame);
+
+	/// \brief Runs 'data' through the register (the CRC before the final xor), with the best kernel.
+	static uint32_t updateRegister(uint32_t reg, const uint8_t * data, size_t length);
+
+	/// \brief Same as updateRegister() with the slicing-by-8 kernel, for tests and benchmarks.
+	static uint32_t updateRegisterPortable(uint32_t reg, const uint8_t * data, size_t length);
+
+	/// \returns The name of the kernel updateRegister() uses: "pclmul" or "slicing-by-8".
+	static const char * getKernelName();
+
+protected:
+	/// \cond INTERNAL
+	uint32_t reg = initial;
+	/// \endcond
+};
+
+/// \}
@@ -0,0 +1,321 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialDeviceRegistry.h"
+
+#ifndef TARGET_WIN32
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+#ifdef TARGET_LINUX
+	#include <sys/inotify.h>
+#endif
+
+//----------------------------------------------------------------
+#if defined( TARGET_OSX )
+static bool isDeviceArduino(const ofSerialDeviceInfo & A){
+	return (A.getDeviceName().find("usbserial") != std::string::npos
+			|| A.getDeviceName().find("usbmodem") != std::string::npos);
+}
+#endif
+
+//----------------------------------------------------------------
+ofSerialDeviceRegistry & ofSerialDeviceRegistry::getDefault(){
+	static ofSerialDeviceRegistry registry;
+	return registry;
+}
+
+//----------------------------------------------------------------
+ofSerialDeviceRegistry::ofSerialDeviceRegistry(std::string_view directory)
+:directory(directory){
+	#ifdef TARGET_LINUX
+		// watch before listing so nothing created in between is missed
+		inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if(inotifyFd != -1 && inotify_add_watch(inotifyFd, this->directory.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO) == -1){
+			std::cerr << "ofSerialDeviceRegistry(): can't watch " << directory << ": " << strerror(errno) << std::endl;
+			::close(inotifyFd);
+			inotifyFd = -1;
+		}
+	#endif
+
+	if(inotifyFd == -1){
+		hasDirectoryChanged();
+	}
+	rescan(false);
+	generation = 1;
+
+	if(pipe(stopPipe) != 0){
+		std::cerr << "ofSerialDeviceRegistry(): pipe failed, the list won't be updated: " << strerror(errno) << std::endl;
+		stopPipe[0] = stopPipe[1] = -1;
+		return;
+	}
+	fcntl(stopPipe[0], F_SETFD, FD_CLOEXEC);
+	fcntl(stopPipe[1], F_SETFD, FD_CLOEXEC);
+	watcher = std::thread(&ofSerialDeviceRegistry::watch, this);
+}
+
+//----------------------------------------------------------------
+ofSerialDeviceRegistry::~ofSerialDeviceRegistry(){
+	if(watcher.joinable()){
+		const char stop = 0;
+		auto unused = write(stopPipe[1], &stop, 1);
+		(void)unused;
+		watcher.join();
+	}
+	for(int fd: { stopPipe[0], stopPipe[1], inotifyFd }){
+		if(fd != -1){
+			::close(fd);
+		}
+	}
+}
+
+//----------------------------------------------------------------
+bool ofSerialDeviceRegistry::isSerialDevice(std::string_view name){
+	#if defined( TARGET_OSX )
+		static constexpr std::string_view prefixes[] = { "cu.", "tty." };
+	#else
+		static constexpr std::string_view prefixes[] = { "ttyACM", "ttyS", "ttyUSB", "rfc" };
+	#endif
+
+	for(auto prefix: prefixes){
+		if(name.size() > prefix.size() && name.substr(0, prefix.size()) == prefix){
+			return true;
+		}
+	}
+	return false;
+}
+
+//----------------------------------------------------------------
+void ofSerialDeviceRegistry::rescan(bool bNotify){
+	std::vector<ofSerialDeviceInfo> found;
+	DIR * dir = opendir(directory.c_str());
+	if(dir == nullptr){
+		std::cerr << "ofSerialDeviceRegistry: error listing devices in " << directory << std::endl;
+	} else {
+		while(struct dirent * entry = readdir(dir)){
+			const std::string_view name(entry->d_name);
+			if(isSerialDevice(name)){
+				found.push_back(ofSerialDeviceInfo(directory + "/" + entry->d_name, entry->d_name, int(found.size())));
+			}
+		}
+		closedir(dir);
+	}
+
+	#if defined( TARGET_OSX )
+		//here we sort the device to have the aruino ones first.
+		std::partition(found.begin(), found.end(), isDeviceArduino);
+		int k = 0;
+		for(auto & device: found){
+			device.deviceID = k++;
+		}
+	#endif
+
+	if(bNotify){
+		auto contains = [](const std::vector<ofSerialDeviceInfo> & list, const ofSerialDeviceInfo & device){
+			return std::any_of(list.begin(), list.end(), [&](const ofSerialDeviceInfo & other){
+				return other.devicePath == device.devicePath;
+			});
+		};
+		for(auto & device: devices){
+			if(!contains(found, device)){
+				pending.push_back({ ofSerialDeviceEvent::Removed, device });
+			}
+		}
+		for(auto & device: found){
+			if(!contains(devices, device)){
+				pending.push_back({ ofSerialDeviceEvent::Added, device });
+			}
+		}
+	}
+	devices.swap(found);
+}
+
+//----------------------------------------------------------------
+void ofSerialDeviceRegistry::addDevice(std::string_view name){
+	const std::string path = directory + "/" + std::string(name);
+	for(auto & device: devices){
+		if(device.devicePath == path){
+			return;
+		}
+	}
+	devices.push_back(ofSerialDeviceInfo(path, std::string(name), int(devices.size())));
+	pending.push_back({ ofSerialDeviceEvent::Added, devices.back() });
+}
+
+//----------------------------------------------------------------
+void ofSerialDeviceRegistry::removeDevice(std::string_view name){
+	for(size_t i = 0; i < devices.size(); i++){
+		if(devices[i].deviceName != name){
+			continue;
+		}
+		pending.push_back({ ofSerialDeviceEvent::Removed, devices[i] });
+		devices.erase(devices.begin() + long(i));
+		for(; i < devices.size(); i++){
+			devices[i].deviceID = int(i);
+		}
+		return;
+	}
+}
+
+//----------------------------------------------------------------
+void ofSerialDeviceRegistry::readEvents(){
+	#ifdef TARGET_LINUX
+		alignas(struct inotify_event) char buffer[4096];
+		while(true){
+			const auto n = read(inotifyFd, buffer, sizeof(buffer));
+			if(n <= 0){
+				if(n < 0 && errno == EINTR){
+					continue;
+				}
+				return;
+			}
+			for(char * p = buffer; p < buffer + n; ){
+				const auto * event = reinterpret_cast<const struct inotify_event *>(p);
+				p += sizeof(struct inotify_event) + event->len;
+				if(event->mask & IN_Q_OVERFLOW){
+					// events were lost, only a full listing can tell what changed
+					rescan(true);
+					continue;
+				}
+				if(event->len == 0){
+					continue;
+				}
+				const std::string_view name(event->name);
+				if(!isSerialDevice(name)){
+					continue;
+				}
+				if(event->mask & (IN_CREATE | IN_MOVED_TO)){
+					addDevice(name);
+				} else if(event->mask & (IN_DELETE | IN_MOVED_FROM)){
+					removeDevice(name);
+				}
+			}
+		}
+	#endif
+}
+
+//----------------------------------------------------------------
+bool ofSerialDeviceRegistry::hasDirectoryChanged(){
+	struct stat info;
+	if(stat(directory.c_str(), &info) != 0){
+		return false;
+	}
+	// the modification time has a one second resolution on some file
+	// systems, keep rescanning while it is that recent
+	const bool bChanged = info.st_mtime != lastModified || time(nullptr) - info.st_mtime <= 1;
+	lastModified = info.st_mtime;
+	return bChanged;
+}
+
+//----------------------------------------------------------------
+bool ofSerialDeviceRegistry::update(){
+	std::lock_guard<std::mutex> dispatchLock(dispatchMutex);
+	pending.clear();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if(inotifyFd != -1){
+			readEvents();
+		} else if(hasDirectoryChanged()){
+			rescan(true);
+		}
+		if(!pending.empty()){
+			generation++;
+		}
+	}
+
+	for(auto & change: pending){
+		const ofSerialDeviceEvent event{ change.type, change.device };
+		for(auto & subscription: subscriptions){
+			subscription.callback(event);
+		}
+	}
+	return !pending.empty();
+}
+
+//----------------------------------------------------------------
+void ofSerialDeviceRegistry::watch(){
+	while(true){
+		struct pollfd fds[2] = { { stopPipe[0], POLLIN, 0 }, { inotifyFd, POLLIN, 0 } };
+		const bool bWatching = inotifyFd != -1;
+		const int nReady = ::poll(fds, bWatching ? 2 : 1, bWatching ? -1 : rescanIntervalMs);
+		if(nReady < 0 && errno != EINTR){
+			std::cerr << "ofSerialDeviceRegistry: poll error: " << strerror(errno) << std::endl;
+			return;
+		}
+		if(fds[0].revents != 0){
+			return;
+		}
+		update();
+	}
+}
+
+//----------------------------------------------------------------
+uint64_t ofSerialDeviceRegistry::getGeneration() const{
+	std::lock_guard<std::mutex> lock(mutex);
+	return generation;
+}
+
+//----------------------------------------------------------------
+size_t ofSerialDeviceRegistry::getNumDevices() const{
+	std::lock_guard<std::mutex> lock(mutex);
+	return devices.size();
+}
+
+//----------------------------------------------------------------
+bool ofSerialDeviceRegistry::getDevice(size_t index, ofSerialDeviceInfo & device) const{
+	std::lock_guard<std::mutex> lock(mutex);
+	if(index >= devices.size()){
+		return false;
+	}
+	device = devices[index];
+	return true;
+}
+
+//----------------------------------------------------------------
+int ofSerialDeviceRegistry::findDevice(std::string_view nameOrPath) const{
+	std::lock_guard<std::mutex> lock(mutex);
+	for(size_t i = 0; i < devices.size(); i++){
+		if(devices[i].deviceName == nameOrPath || devices[i].devicePath == nameOrPath){
+			return int(i);
+		}
+	}
+	return -1;
+}
+
+//----------------------------------------------------------------
+bool ofSerialDeviceRegistry::copyDevices(std::vector<ofSerialDeviceInfo> & copy, uint64_t & copyGeneration) const{
+	std::lock_guard<std::mutex> lock(mutex);
+	if(copyGeneration == generation){
+		return false;
+	}
+	copy = devices;
+	copyGeneration = generation;
+	return true;
+}
+
+//----------------------------------------------------------------
+ofSerialDeviceRegistry::SubscriptionId ofSerialDeviceRegistry::subscribe(Callback callback){
+	std::lock_guard<std::mutex> lock(dispatchMutex);
+	const SubscriptionId id = nextSubscriptionId++;
+	subscriptions.push_back({ id, std::move(callback) });
+	return id;
+}
+
+//----------------------------------------------------------------
+void ofSerialDeviceRegistry::unsubscribe(SubscriptionId id){
+	std::lock_guard<std::mutex> lock(dispatchMutex);
+	subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(), [id](const Subscription & subscription){
+		return subscription.id == id;
+	}), subscriptions.end());
+}
+
+#endif // TARGET_WIN32
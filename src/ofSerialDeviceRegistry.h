@@ -0,0 +1,145 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include "ofSerial.h"
+
+#ifndef TARGET_WIN32
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/// \brief A serial device that appeared or went away, see ofSerialDeviceRegistry::subscribe().
+struct ofSerialDeviceEvent {
+	enum Type {
+		Added,
+		Removed
+	};
+
+	Type type;
+	const ofSerialDeviceInfo & device;  ///< \brief Only valid during the callback.
+};
+
+/// \brief Keeps the list of serial devices up to date without rescanning /dev.
+///
+/// The directory is listed once, then a watcher thread applies the changes
+/// as they happen: inotify on Linux, a check of the directory modification
+/// time every rescanIntervalMs elsewhere. Queries only read the cached list
+/// under a mutex, they neither touch the file system nor allocate.
+///
+/// ~~~~{.cpp}
+/// auto & registry = ofSerialDeviceRegistry::getDefault();
+/// auto id = registry.subscribe([](const ofSerialDeviceEvent & event){
+///	 if(event.type == ofSerialDeviceEvent::Added){
+///		 // reconnect to event.device.getDevicePath()
+///	 }
+/// });
+/// ~~~~
+///
+/// ofSerial::getDeviceList() and ofSerial::setup(deviceNumber) use the
+/// default registry. Device IDs are positions in the list, they shift when
+/// a device before them goes away.
+class ofSerialDeviceRegistry {
+
+public:
+	using Callback = std::function<void(const ofSerialDeviceEvent & event)>;
+	using SubscriptionId = size_t;
+
+	/// \brief Interval of the modification time checks when inotify is not available.
+	static constexpr int rescanIntervalMs = 500;
+
+	/// \brief The registry of /dev shared by every ofSerial, created on first use.
+	static ofSerialDeviceRegistry & getDefault();
+
+	/// \brief Lists 'directory' and starts watching it.
+	/// \param directory Where the device nodes are, another directory can be used for testing.
+	explicit ofSerialDeviceRegistry(std::string_view directory = "/dev");
+
+	~ofSerialDeviceRegistry();
+
+	ofSerialDeviceRegistry(const ofSerialDeviceRegistry &) = delete;
+	ofSerialDeviceRegistry & operator=(const ofSerialDeviceRegistry &) = delete;
+
+	/// \returns true if changes are pushed by inotify rather than found by polling.
+	bool isWatching() const{
+		return inotifyFd != -1;
+	}
+
+	/// \brief Applies the pending changes now instead of waiting for the watcher thread.
+	///
+	/// Subscribers are called from the calling thread.
+	/// \returns true if the list changed.
+	bool update();
+
+	/// \returns a number that changes every time the list does.
+	uint64_t getGeneration() const;
+
+	size_t getNumDevices() const;
+
+	/// \brief Copies a device into 'device', reusing its strings.
+	/// \returns false if 'index' is out of range.
+	bool getDevice(size_t index, ofSerialDeviceInfo & device) const;
+
+	/// \brief Finds a device by name (ttyUSB0) or path (/dev/ttyUSB0).
+	/// \returns its index, or -1.
+	int findDevice(std::string_view nameOrPath) const;
+
+	/// \brief Copies the list into 'devices' if it changed since 'generation'.
+	///
+	/// 'generation' is updated, start with 0 to always get a first copy.
+	/// \returns true if 'devices' was replaced.
+	bool copyDevices(std::vector<ofSerialDeviceInfo> & devices, uint64_t & generation) const;
+
+	/// \brief Calls 'callback' for each device added or removed from now on.
+	///
+	/// Callbacks are run from the watcher thread, or from the thread calling
+	/// update(). They may query the registry but must not subscribe or
+	/// unsubscribe.
+	SubscriptionId subscribe(Callback callback);
+
+	void unsubscribe(SubscriptionId id);
+
+protected:
+	/// \cond INTERNAL
+	struct Pending {
+		ofSerialDeviceEvent::Type type;
+		ofSerialDeviceInfo device;
+	};
+
+	struct Subscription {
+		SubscriptionId id;
+		Callback callback;
+	};
+
+	static bool isSerialDevice(std::string_view name);
+	void rescan(bool bNotify);
+	void readEvents();
+	bool hasDirectoryChanged();
+	void addDevice(std::string_view name);
+	void removeDevice(std::string_view name);
+	void watch();
+
+	std::string directory;
+	int inotifyFd = -1;  ///< \brief Linux only, -1 elsewhere or if inotify failed.
+	int stopPipe[2] = { -1, -1 };  ///< \brief Wakes the watcher thread up when destroyed.
+	time_t lastModified = 0;
+	std::thread watcher;
+
+	mutable std::mutex mutex;  ///< \brief Protects devices and generation.
+	std::vector<ofSerialDeviceInfo> devices;
+	uint64_t generation = 0;
+
+	std::mutex dispatchMutex;  ///< \brief Serialises update() so events are delivered in order.
+	std::vector<Pending> pending;
+	std::vector<Subscription> subscriptions;
+	SubscriptionId nextSubscriptionId = 1;
+	/// \endcond
+};
+
+#endif // TARGET_WIN32
@@ -0,0 +1,352 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialFraming.h"
+
+#include <cstring>
+#include <iostream>
+
+static constexpr uint8_t SLIP_END = 0xC0;
+static constexpr uint8_t SLIP_ESC = 0xDB;
+static constexpr uint8_t SLIP_ESC_END = 0xDC;
+static constexpr uint8_t SLIP_ESC_ESC = 0xDD;
+
+//----------------------------------------------------------------
+ofSerialFrameDecoder::ofSerialFrameDecoder(size_t maxFrameLength)
+:frame(std::make_unique<uint8_t[]>(maxFrameLength > 0 ? maxFrameLength : 1))
+,maxFrameLength(maxFrameLength){
+}
+
+//----------------------------------------------------------------
+void ofSerialFrameDecoder::reset(){
+	frameLength = 0;
+	bDiscarding = false;
+}
+
+//----------------------------------------------------------------
+bool ofSerialFrameDecoder::append(const uint8_t * data, size_t length){
+	if(length > maxFrameLength - frameLength){
+		return false;
+	}
+	memcpy(frame.get() + frameLength, data, length);
+	frameLength += length;
+	return true;
+}
+
+//----------------------------------------------------------------
+void ofSerialFrameDecoder::dropFrame(){
+	errorCount++;
+	frameLength = 0;
+	bDiscarding = true;
+}
+
+//----------------------------------------------------------------
+ofSerialCobsDecoder::ofSerialCobsDecoder(size_t maxFrameLength)
+:ofSerialFrameDecoder(maxFrameLength){
+}
+
+//----------------------------------------------------------------
+void ofSerialCobsDecoder::reset(){
+	ofSerialFrameDecoder::reset();
+	blockRemaining = 0;
+	bZeroPending = false;
+	bInFrame = false;
+}
+
+//----------------------------------------------------------------
+size_t ofSerialCobsDecoder::feed(const uint8_t * data, size_t length, const FrameCallback & onFrame){
+	size_t nFrames = 0;
+	size_t i = 0;
+	while(i < length){
+		if(bDiscarding){
+			auto end = static_cast<const uint8_t *>(memchr(data + i, 0, length - i));
+			if(end == nullptr){
+				break;
+			}
+			i = size_t(end - data) + 1;
+			reset();
+			continue;
+		}
+
+		if(blockRemaining == 0){
+			const uint8_t code = data[i++];
+			if(code == 0){
+				if(bInFrame){
+					onFrame(std::span<const uint8_t>(frame.get(), frameLength));
+					nFrames++;
+				}
+				reset();
+				continue;
+			}
+			const uint8_t zero = 0;
+			if(bZeroPending && !append(&zero, 1)){
+				dropFrame();
+				continue;
+			}
+			bInFrame = true;
+			blockRemaining = code - 1u;
+			bZeroPending = code != 0xFF;
+			continue;
+		}
+
+		// copy the block data in one go, a zero in there cuts the frame short
+		const size_t n = std::min(blockRemaining, length - i);
+		auto end = static_cast<const uint8_t *>(memchr(data + i, 0, n));
+		if(end != nullptr){
+			errorCount++;
+			i = size_t(end - data) + 1;
+			reset();
+			continue;
+		}
+		if(!append(data + i, n)){
+			dropFrame();
+			continue;
+		}
+		i += n;
+		blockRemaining -= n;
+	}
+	return nFrames;
+}
+
+//----------------------------------------------------------------
+ofSerialSlipDecoder::ofSerialSlipDecoder(size_t maxFrameLength)
+:ofSerialFrameDecoder(maxFrameLength)
+,specials({SLIP_END, SLIP_ESC}){
+}
+
+//----------------------------------------------------------------
+void ofSerialSlipDecoder::reset(){
+	ofSerialFrameDecoder::reset();
+	bEscaped = false;
+}
+
+//----------------------------------------------------------------
+size_t ofSerialSlipDecoder::feed(const uint8_t * data, size_t length, const FrameCallback & onFrame){
+	size_t nFrames = 0;
+	size_t i = 0;
+	while(i < length){
+		if(bEscaped){
+			// RFC 1055 keeps the byte as is after a bad escape
+			uint8_t byte = data[i++];
+			if(byte == SLIP_ESC_END){
+				byte = SLIP_END;
+			} else if(byte == SLIP_ESC_ESC){
+				byte = SLIP_ESC;
+			}
+			bEscaped = false;
+			if(!append(&byte, 1)){
+				dropFrame();
+			}
+			continue;
+		}
+
+		// copy up to the next END or ESC
+		const size_t run = specials.find(data + i, length - i);
+		if(!bDiscarding && run > 0 && !append(data + i, run)){
+			dropFrame();
+		}
+		i += run;
+		if(i == length){
+			break;
+		}
+
+		if(data[i++] == SLIP_END){
+			if(!bDiscarding && frameLength > 0){
+				onFrame(std::span<const uint8_t>(frame.get(), frameLength));
+				nFrames++;
+			}
+			reset();
+		} else if(!bDiscarding){
+			bEscaped = true;
+		}
+	}
+	return nFrames;
+}
+
+//----------------------------------------------------------------
+ofSerialLengthPrefixDecoder::ofSerialLengthPrefixDecoder(size_t maxFrameLength, size_t prefixBytes, bool bigEndian)
+:ofSerialFrameDecoder(maxFrameLength)
+,prefixBytes(prefixBytes == 1 || prefixBytes == 4 ? prefixBytes : 2)
+,bBigEndian(bigEndian){
+}
+
+//----------------------------------------------------------------
+void ofSerialLengthPrefixDecoder::reset(){
+	ofSerialFrameDecoder::reset();
+	prefixLength = 0;
+	expected = 0;
+}
+
+//----------------------------------------------------------------
+size_t ofSerialLengthPrefixDecoder::feed(const uint8_t * data, size_t length, const FrameCallback & onFrame){
+	size_t nFrames = 0;
+	size_t i = 0;
+	while(i < length){
+		if(prefixLength < prefixBytes){
+			prefix[prefixLength++] = data[i++];
+			if(prefixLength < prefixBytes){
+				continue;
+			}
+			expected = 0;
+			for(size_t k = 0; k < prefixBytes; k++){
+				const size_t byte = prefix[bBigEndian ? k : prefixBytes - 1 - k];
+				expected = (expected << 8) | byte;
+			}
+			frameLength = 0;
+			if(expected > maxFrameLength){
+				// there is no delimiter to resync on, skip the announced payload
+				errorCount++;
+				bDiscarding = true;
+			}
+		} else if(!bDiscarding && frameLength == 0 && length - i >= expected){
+			// the whole payload is in this chunk, no need to copy it
+			onFrame(std::span<const uint8_t>(data + i, expected));
+			nFrames++;
+			i += expected;
+			reset();
+			continue;
+		} else {
+			const size_t n = std::min(expected - frameLength, length - i);
+			if(bDiscarding){
+				frameLength += n;
+			} else {
+				append(data + i, n);
+			}
+			i += n;
+		}
+
+		if(prefixLength == prefixBytes && frameLength == expected){
+			if(!bDiscarding){
+				onFrame(std::span<const uint8_t>(frame.get(), frameLength));
+				nFrames++;
+			}
+			reset();
+		}
+	}
+	return nFrames;
+}
+
+//----------------------------------------------------------------
+ofSerialCobsEncoder::ofSerialCobsEncoder(size_t maxFrameLength)
+:buffer(std::make_unique<uint8_t[]>(getMaxEncodedLength(maxFrameLength)))
+,maxFrameLength(maxFrameLength){
+}
+
+//----------------------------------------------------------------
+size_t ofSerialCobsEncoder::encode(std::span<const uint8_t> payload, std::span<uint8_t> out){
+	if(out.size() < getMaxEncodedLength(payload.size())){
+		return 0;
+	}
+
+	const uint8_t * data = payload.data();
+	const size_t length = payload.size();
+	size_t i = 0;
+	size_t o = 0;
+	while(true){
+		// a block is a code byte followed by up to 254 non zero bytes
+		const size_t run = std::min<size_t>(254, length - i);
+		auto zero = static_cast<const uint8_t *>(run > 0 ? memchr(data + i, 0, run) : nullptr);
+		const size_t n = zero != nullptr ? size_t(zero - (data + i)) : run;
+		out[o++] = static_cast<uint8_t>(n + 1);
+		memcpy(out.data() + o, data + i, n);
+		o += n;
+		i += n;
+		if(zero != nullptr){
+			// the zero is implied by the code, a trailing one needs an empty block
+			i++;
+			if(i == length){
+				out[o++] = 1;
+				break;
+			}
+		} else if(i == length){
+			break;
+		}
+	}
+	out[o++] = 0;
+	return o;
+}
+
+//----------------------------------------------------------------
+bool ofSerialCobsEncoder::write(ofSerial & port, std::span<const uint8_t> payload){
+	if(payload.size() > maxFrameLength){
+		std::cerr << "write(): frame of " << payload.size() << " bytes is too large" << std::endl;
+		return false;
+	}
+	const size_t length = encode(payload, std::span<uint8_t>(buffer.get(), getMaxEncodedLength(maxFrameLength)));
+	return port.writeBytes(buffer.get(), length) == length;
+}
+
+//----------------------------------------------------------------
+ofSerialSlipEncoder::ofSerialSlipEncoder(size_t maxFrameLength)
+:buffer(std::make_unique<uint8_t[]>(getMaxEncodedLength(maxFrameLength)))
+,maxFrameLength(maxFrameLength){
+}
+
+//----------------------------------------------------------------
+size_t ofSerialSlipEncoder::encode(std::span<const uint8_t> payload, std::span<uint8_t> out){
+	if(out.size() < getMaxEncodedLength(payload.size())){
+		return 0;
+	}
+
+	static const ofSerialScanner specials({SLIP_END, SLIP_ESC});
+	const uint8_t * data = payload.data();
+	const size_t length = payload.size();
+	size_t i = 0;
+	size_t o = 0;
+	out[o++] = SLIP_END;
+	while(i < length){
+		const size_t run = specials.find(data + i, length - i);
+		memcpy(out.data() + o, data + i, run);
+		o += run;
+		i += run;
+		if(i < length){
+			out[o++] = SLIP_ESC;
+			out[o++] = data[i++] == SLIP_END ? SLIP_ESC_END : SLIP_ESC_ESC;
+		}
+	}
+	out[o++] = SLIP_END;
+	return o;
+}
+
+//----------------------------------------------------------------
+bool ofSerialSlipEncoder::write(ofSerial & port, std::span<const uint8_t> payload){
+	if(payload.size() > maxFrameLength){
+		std::cerr << "write(): frame of " << payload.size() << " bytes is too large" << std::endl;
+		return false;
+	}
+	const size_t length = encode(payload, std::span<uint8_t>(buffer.get(), getMaxEncodedLength(maxFrameLength)));
+	return port.writeBytes(buffer.get(), length) == length;
+}
+
+//----------------------------------------------------------------
+ofSerialLengthPrefixEncoder::ofSerialLengthPrefixEncoder(size_t maxFrameLength, size_t prefixBytes, bool bigEndian)
+:maxFrameLength(maxFrameLength)
+,prefixBytes(prefixBytes == 1 || prefixBytes == 4 ? prefixBytes : 2)
+,bBigEndian(bigEndian){
+	buffer = std::make_unique<uint8_t[]>(getMaxEncodedLength(maxFrameLength));
+}
+
+//----------------------------------------------------------------
+size_t ofSerialLengthPrefixEncoder::encode(std::span<const uint8_t> payload, std::span<uint8_t> out) const{
+	const size_t length = payload.size();
+	if(out.size() < getMaxEncodedLength(length) || (prefixBytes < sizeof(size_t) && (length >> (8 * prefixBytes)) != 0)){
+		return 0;
+	}
+	for(size_t k = 0; k < prefixBytes; k++){
+		const size_t shift = 8 * (bBigEndian ? prefixBytes - 1 - k : k);
+		out[k] = static_cast<uint8_t>(length >> shift);
+	}
+	memcpy(out.data() + prefixBytes, payload.data(), length);
+	return prefixBytes + length;
+}
+
+//----------------------------------------------------------------
+bool ofSerialLengthPrefixEncoder::write(ofSerial & port, std::span<const uint8_t> payload){
+	if(payload.size() > maxFrameLength){
+		std::cerr << "write(): frame of " << payload.size() << " bytes is too large" << std::endl;
+		return false;
+	}
+	const size_t length = encode(payload, std::span<uint8_t>(buffer.get(), getMaxEncodedLength(maxFrameLength)));
+	return length > 0 && port.writeBytes(buffer.get(), length) == length;
+}
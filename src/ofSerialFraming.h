@@ -0,0 +1,194 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include "ofSerial.h"
+
+#include <functional>
+#include <memory>
+#include <span>
+
+/// \brief Base class of the streaming frame decoders.
+///
+/// A decoder is fed with chunks cut anywhere by the serial port, it keeps the
+/// partial frame between calls and emits every complete frame as a view. The
+/// view points into a buffer owned by the decoder (or straight into the fed
+/// chunk when no copy is needed), it is only valid during the callback. The
+/// buffer is allocated once, decoding a frame never allocates.
+///
+/// ~~~~{.cpp}
+/// ofSerialCobsDecoder cobs(1024);
+/// serial.readFrames(cobs, [](std::span<const uint8_t> frame){
+///	 handle(frame);
+/// });
+/// ~~~~
+class ofSerialFrameDecoder {
+
+public:
+	using FrameCallback = std::function<void(std::span<const uint8_t> frame)>;
+
+	/// \param maxFrameLength Size of the decoded frames above which they are dropped.
+	ofSerialFrameDecoder(size_t maxFrameLength);
+	virtual ~ofSerialFrameDecoder() = default;
+
+	/// \brief Decodes a chunk of received bytes.
+	/// \returns The number of frames passed to onFrame.
+	virtual size_t feed(const uint8_t * data, size_t length, const FrameCallback & onFrame) = 0;
+
+	/// \brief Drops the partial frame, the next byte starts a new one.
+	virtual void reset();
+
+	/// \returns The number of malformed or oversized frames dropped so far.
+	size_t getErrorCount() const{
+		return errorCount;
+	}
+
+	size_t getMaxFrameLength() const{
+		return maxFrameLength;
+	}
+
+protected:
+	/// \cond INTERNAL
+	bool append(const uint8_t * data, size_t length);
+	void dropFrame();
+
+	std::unique_ptr<uint8_t[]> frame;
+	size_t frameLength = 0;
+	size_t maxFrameLength;
+	size_t errorCount = 0;
+	bool bDiscarding = false;  ///< \brief Skipping the rest of a bad frame until the next delimiter.
+	/// \endcond
+};
+
+/// \brief Consistent Overhead Byte Stuffing decoder, frames end with 0x00.
+class ofSerialCobsDecoder: public ofSerialFrameDecoder {
+
+public:
+	ofSerialCobsDecoder(size_t maxFrameLength = 1024);
+
+	size_t feed(const uint8_t * data, size_t length, const FrameCallback & onFrame) override;
+	void reset() override;
+
+protected:
+	/// \cond INTERNAL
+	size_t blockRemaining = 0;  ///< \brief Data bytes left in the current block.
+	bool bZeroPending = false;  ///< \brief The current block is followed by an implicit zero.
+	bool bInFrame = false;  ///< \brief A block code was received since the last delimiter.
+	/// \endcond
+};
+
+/// \brief SLIP (RFC 1055) decoder, frames end with 0xC0.
+class ofSerialSlipDecoder: public ofSerialFrameDecoder {
+
+public:
+	ofSerialSlipDecoder(size_t maxFrameLength = 1024);
+
+	size_t feed(const uint8_t * data, size_t length, const FrameCallback & onFrame) override;
+	void reset() override;
+
+protected:
+	/// \cond INTERNAL
+	ofSerialScanner specials;
+	bool bEscaped = false;
+	/// \endcond
+};
+
+/// \brief Decoder of frames preceded by their length.
+///
+/// The prefix is 1, 2 or 4 bytes, big or little endian, and only counts the
+/// payload. A frame received in one piece is emitted without being copied.
+class ofSerialLengthPrefixDecoder: public ofSerialFrameDecoder {
+
+public:
+	ofSerialLengthPrefixDecoder(size_t maxFrameLength = 1024, size_t prefixBytes = 2, bool bigEndian = true);
+
+	size_t feed(const uint8_t * data, size_t length, const FrameCallback & onFrame) override;
+	void reset() override;
+
+protected:
+	/// \cond INTERNAL
+	size_t prefixBytes;
+	bool bBigEndian;
+	uint8_t prefix[4] = {};
+	size_t prefixLength = 0;  ///< \brief Prefix bytes received so far.
+	size_t expected = 0;  ///< \brief Payload length announced by the prefix.
+	/// \endcond
+};
+
+/// \brief COBS encoder writing 0x00 terminated frames.
+///
+/// ~~~~{.cpp}
+/// ofSerialCobsEncoder cobs(1024);
+/// cobs.write(serial, payload);
+/// ~~~~
+class ofSerialCobsEncoder {
+
+public:
+	/// \param maxFrameLength Largest payload write() accepts, sizes the internal buffer.
+	ofSerialCobsEncoder(size_t maxFrameLength = 1024);
+
+	/// \returns The worst case encoded size of a 'length' bytes payload, delimiter included.
+	static constexpr size_t getMaxEncodedLength(size_t length){
+		return length + length / 254 + 2;
+	}
+
+	/// \brief Encodes 'payload' into 'out', which must hold getMaxEncodedLength() bytes.
+	/// \returns The encoded length, 0 if 'out' is too small.
+	static size_t encode(std::span<const uint8_t> payload, std::span<uint8_t> out);
+
+	/// \brief Encodes 'payload' and writes it with a single writeBytes().
+	/// \returns false if the payload is too large or the write failed.
+	bool write(ofSerial & port, std::span<const uint8_t> payload);
+
+protected:
+	/// \cond INTERNAL
+	std::unique_ptr<uint8_t[]> buffer;
+	size_t maxFrameLength;
+	/// \endcond
+};
+
+/// \brief SLIP encoder, every frame is surrounded with 0xC0.
+class ofSerialSlipEncoder {
+
+public:
+	ofSerialSlipEncoder(size_t maxFrameLength = 1024);
+
+	static constexpr size_t getMaxEncodedLength(size_t length){
+		return 2 * length + 2;
+	}
+
+	static size_t encode(std::span<const uint8_t> payload, std::span<uint8_t> out);
+
+	bool write(ofSerial & port, std::span<const uint8_t> payload);
+
+protected:
+	/// \cond INTERNAL
+	std::unique_ptr<uint8_t[]> buffer;
+	size_t maxFrameLength;
+	/// \endcond
+};
+
+/// \brief Length prefixed frames encoder, matching ofSerialLengthPrefixDecoder.
+class ofSerialLengthPrefixEncoder {
+
+public:
+	ofSerialLengthPrefixEncoder(size_t maxFrameLength = 1024, size_t prefixBytes = 2, bool bigEndian = true);
+
+	size_t getMaxEncodedLength(size_t length) const{
+		return prefixBytes + length;
+	}
+
+	size_t encode(std::span<const uint8_t> payload, std::span<uint8_t> out) const;
+
+	bool write(ofSerial & port, std::span<const uint8_t> payload);
+
+protected:
+	/// \cond INTERNAL
+	std::unique_ptr<uint8_t[]> buffer;
+	size_t maxFrameLength;
+	size_t prefixBytes;
+	bool bBigEndian;
+	/// \endcond
+};
@@ -0,0 +1,150 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialGroup.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+//----------------------------------------------------------------
+std::chrono::nanoseconds ofSerialGroupResult::getSkew() const{
+	auto first = std::chrono::nanoseconds::max();
+	auto last = std::chrono::nanoseconds::min();
+	for(auto & port: ports){
+		if(port.status == ofSerialWriteStatus::Done){
+			first = std::min(first, port.completed);
+			last = std::max(last, port.completed);
+		}
+	}
+	return numDone > 0 ? last - first : std::chrono::nanoseconds(0);
+}
+
+//----------------------------------------------------------------
+bool ofSerialGroup::addPort(ofSerial & port){
+	if(!port.isInitialized()){
+		std::cerr << "ofSerialGroup: addPort() with a port that is not opened" << std::endl;
+		return false;
+	}
+	if(std::find(ports.begin(), ports.end(), &port) != ports.end()){
+		return false;
+	}
+	ports.push_back(&port);
+	return true;
+}
+
+//----------------------------------------------------------------
+bool ofSerialGroup::removePort(ofSerial & port){
+	auto found = std::find(ports.begin(), ports.end(), &port);
+	if(found == ports.end()){
+		return false;
+	}
+	ports.erase(found);
+	return true;
+}
+
+//----------------------------------------------------------------
+const ofSerialGroupResult & ofSerialGroup::write(std::span<const uint8_t> data, std::chrono::milliseconds timeout){
+	const auto begin = std::chrono::steady_clock::now();
+	result.ports.assign(ports.size(), ofSerialGroupPortResult());
+	result.numDone = 0;
+
+	// everything that could delay the first write is done before any port is written
+	for(size_t i = 0; i < ports.size(); i++){
+		if(!ports[i]->isInitialized() || ports[i]->isWriterThreadRunning() || !ports[i]->flushWrites()){
+			result.ports[i].status = ofSerialWriteStatus::Failed;
+		}
+	}
+
+	#ifndef TARGET_WIN32
+		// one non blocking write per port, back to back
+		pollFds.clear();
+		pollPorts.clear();
+		for(size_t i = 0; i < ports.size(); i++){
+			if(result.ports[i].status != ofSerialWriteStatus::Pending){
+				continue;
+			}
+			if(writePort(i, data, begin) && result.ports[i].status == ofSerialWriteStatus::Pending){
+				pollFds.push_back({ ports[i]->getFileDescriptor(), POLLOUT, 0 });
+				pollPorts.push_back(i);
+			}
+		}
+
+		// the ports that were full are finished as they drain
+		const auto deadline = begin + timeout;
+		while(!pollFds.empty()){
+			const auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+			const int n = left > 0 ? ::poll(pollFds.data(), nfds_t(pollFds.size()), int(std::min<long long>(left, INT32_MAX))) : 0;
+			if(n < 0 && errno == EINTR){
+				continue;
+			}
+			if(n <= 0){
+				if(n < 0){
+					std::cerr << "ofSerialGroup: poll failed: " << errno << " " << strerror(errno) << std::endl;
+				}
+				for(size_t i: pollPorts){
+					result.ports[i].status = ofSerialWriteStatus::Failed;
+				}
+				break;
+			}
+			for(size_t k = pollFds.size(); k-- > 0;){
+				const short revents = pollFds[k].revents;
+				if(revents == 0){
+					continue;
+				}
+				const size_t i = pollPorts[k];
+				if((revents & POLLOUT) == 0){
+					result.ports[i].status = ofSerialWriteStatus::Failed;
+				} else {
+					writePort(i, data, begin);
+				}
+				if(result.ports[i].status != ofSerialWriteStatus::Pending){
+					pollFds[k] = pollFds.back();
+					pollFds.pop_back();
+					pollPorts[k] = pollPorts.back();
+					pollPorts.pop_back();
+				}
+			}
+		}
+	#else
+		(void)timeout;
+		for(size_t i = 0; i < ports.size(); i++){
+			if(result.ports[i].status == ofSerialWriteStatus::Pending){
+				writePort(i, data, begin);
+				if(result.ports[i].status == ofSerialWriteStatus::Pending){
+					result.ports[i].status = ofSerialWriteStatus::Failed;
+				}
+			}
+		}
+	#endif
+
+	result.elapsed = std::chrono::steady_clock::now() - begin;
+	return result;
+}
+
+//----------------------------------------------------------------
+bool ofSerialGroup::writePort(size_t i, std::span<const uint8_t> data, std::chrono::steady_clock::time_point begin){
+	ofSerialGroupPortResult & port = result.ports[i];
+	const uint8_t * left = data.data() + port.bytesWritten;
+	const size_t length = data.size() - port.bytesWritten;
+	size_t n = 0;
+	#ifndef TARGET_WIN32
+		ofSerialWriteStatus status = ofSerialWriteStatus::Done;
+		n = length > 0 ? ports[i]->writeSome(left, length, &status) : 0;
+		if(status == ofSerialWriteStatus::Failed){
+			port.status = ofSerialWriteStatus::Failed;
+			return false;
+		}
+	#else
+		n = ports[i]->writeBytes(left, length);
+	#endif
+	port.bytesWritten += n;
+	if(port.bytesWritten == data.size()){
+		port.status = ofSerialWriteStatus::Done;
+		port.completed = std::chrono::steady_clock::now() - begin;
+		result.numDone++;
+	}
+	return true;
+}
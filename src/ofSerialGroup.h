@@ -0,0 +1,111 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include "ofSerial.h"
+
+#include <chrono>
+#include <span>
+#include <vector>
+
+#ifndef TARGET_WIN32
+	#include <poll.h>
+#endif
+
+/// \brief Outcome of ofSerialGroup::write() on one port.
+struct ofSerialGroupPortResult {
+	ofSerialWriteStatus status = ofSerialWriteStatus::Pending;  ///< \brief Done, or Failed on error or timeout.
+	size_t bytesWritten = 0;
+	std::chrono::nanoseconds completed{0};  ///< \brief When the last byte was accepted, from the start of the call.
+};
+
+/// \brief Outcome of ofSerialGroup::write(), one entry per port in the order they were added.
+struct ofSerialGroupResult {
+	std::vector<ofSerialGroupPortResult> ports;
+	size_t numDone = 0;
+	std::chrono::nanoseconds elapsed{0};  ///< \brief Duration of the whole call.
+
+	bool isDone() const{
+		return numDone == ports.size();
+	}
+
+	/// \returns The time between the first and the last port to complete, among those that did.
+	std::chrono::nanoseconds getSkew() const;
+};
+
+/// \brief Writes the same buffer to many ports at once.
+///
+/// Writing a sync frame with a loop of writeBytes() delays each port by the
+/// time the previous ones took, and a port whose output buffer is full
+/// blocks all the ports after it. write() first offers the frame to every
+/// port with one non blocking write() each, back to back, so that ports with
+/// room all get it within a few microseconds. The ports that took only part
+/// of it are then finished together, waiting for them with a single poll().
+/// The buffer is shared, it is never copied.
+///
+/// ~~~~{.cpp}
+/// ofSerialGroup group;
+/// for(auto & port: ports){
+///	 group.addPort(port);
+/// }
+/// auto & result = group.write(syncFrame, std::chrono::milliseconds(50));
+/// if(!result.isDone()){
+///	 // result.ports[i].status tells which ports failed
+/// }
+/// ~~~~
+///
+/// Staged coalesced bytes are flushed first, so that they keep their order.
+/// Ports whose writer thread runs are skipped and reported as failed, their
+/// writes would interleave. The group is not thread safe. On Windows the
+/// ports are written one after the other with writeBytes().
+class ofSerialGroup {
+
+public:
+	ofSerialGroup() = default;
+
+	ofSerialGroup(const ofSerialGroup &) = delete;
+	ofSerialGroup & operator=(const ofSerialGroup &) = delete;
+
+	/// \brief Adds an opened port, which must outlive the group or be removed first.
+	/// \returns false if the port is not opened or already in the group.
+	bool addPort(ofSerial & port);
+
+	bool removePort(ofSerial & port);
+
+	size_t getNumPorts() const{
+		return ports.size();
+	}
+
+	/// \brief Writes 'data' to every port of the group.
+	///
+	/// Returns once every port took the whole buffer, or failed, or after
+	/// 'timeout'. The bytes are then in the kernel buffers, not necessarily
+	/// on the wire, see ofSerial::drain().
+	/// \returns The per port outcome, valid until the next call.
+	const ofSerialGroupResult & write(std::span<const uint8_t> data, std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+	const ofSerialGroupResult & write(std::string_view data, std::chrono::milliseconds timeout = std::chrono::seconds(10)){
+		return write(std::span<const uint8_t>(reinterpret_cast<const uint8_t *>(data.data()), data.size()), timeout);
+	}
+
+	/// \returns The outcome of the last write().
+	const ofSerialGroupResult & getLastResult() const{
+		return result;
+	}
+
+protected:
+	/// \cond INTERNAL
+	/// \brief Writes what is left for port 'i', updates its result.
+	/// \returns false if the port failed.
+	bool writePort(size_t i, std::span<const uint8_t> data, std::chrono::steady_clock::time_point begin);
+
+	std::vector<ofSerial *> ports;
+	ofSerialGroupResult result;
+	#ifndef TARGET_WIN32
+		std::vector<struct pollfd> pollFds;  ///< \brief The ports still writing, reused from call to call.
+		std::vector<size_t> pollPorts;  ///< \brief Index in 'ports' of each entry of 'pollFds'.
+	#endif
+	/// \endcond
+};
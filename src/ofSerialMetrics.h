@@ -0,0 +1,253 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/// \brief Set to 0 to compile the metrics out, every record call becomes empty.
+#ifndef OF_SERIAL_METRICS
+	#define OF_SERIAL_METRICS 1
+#endif
+
+/// \brief Copy of a latency histogram, see ofSerialHistogram.
+///
+/// Values are grouped by power of two, each power of two being split in
+/// subBuckets linear buckets: a value is known within 1 / subBuckets
+/// (12.5%) whatever its magnitude, from nanoseconds to minutes.
+struct ofSerialHistogramSnapshot {
+	static constexpr size_t subBucketBits = 3;
+	static constexpr size_t subBuckets = size_t(1) << subBucketBits;
+	static constexpr size_t numBuckets = (64 - subBucketBits + 1) * subBuckets;
+
+	uint64_t count = 0;
+	uint64_t sumNs = 0;
+	uint64_t maxNs = 0;
+	std::array<uint64_t, numBuckets> buckets = {};
+
+	/// \returns The bucket holding 'ns'.
+	static constexpr size_t getBucket(uint64_t ns){
+		if(ns < subBuckets){
+			return size_t(ns);
+		}
+		const size_t msb = size_t(63 - __builtin_clzll(ns));
+		const size_t shift = msb - subBucketBits;
+		return (shift + 1) * subBuckets + size_t((ns >> shift) & (subBuckets - 1));
+	}
+
+	/// \returns The smallest value that falls in 'bucket'.
+	static constexpr uint64_t getBucketLowerBound(size_t bucket){
+		if(bucket < subBuckets){
+			return bucket;
+		}
+		const size_t shift = bucket / subBuckets - 1;
+		return (uint64_t(subBuckets) | (bucket % subBuckets)) << shift;
+	}
+
+	/// \param p Between 0 and 1, 0.99 for the 99th percentile.
+	/// \returns The lower bound of the bucket holding the percentile, 0 if empty.
+	uint64_t getPercentile(double p) const{
+		if(count == 0){
+			return 0;
+		}
+		const auto target = uint64_t(p * double(count - 1)) + 1;
+		uint64_t seen = 0;
+		for(size_t i = 0; i < numBuckets; i++){
+			seen += buckets[i];
+			if(seen >= target){
+				return getBucketLowerBound(i);
+			}
+		}
+		return maxNs;
+	}
+
+	double getMeanNs() const{
+		return count > 0 ? double(sumNs) / double(count) : 0;
+	}
+};
+
+/// \brief Log-bucket latency histogram updated with relaxed atomics.
+///
+/// record() costs a few uncontended atomic adds, readers take a snapshot
+/// at any time. Counts are only approximately consistent with each other
+/// while records are in flight.
+class ofSerialHistogram {
+
+public:
+	void record(uint64_t ns){
+		buckets[ofSerialHistogramSnapshot::getBucket(ns)].fetch_add(1, std::memory_order_relaxed);
+		count.fetch_add(1, std::memory_order_relaxed);
+		sumNs.fetch_add(ns, std::memory_order_relaxed);
+		uint64_t previous = maxNs.load(std::memory_order_relaxed);
+		while(ns > previous && !maxNs.compare_exchange_weak(previous, ns, std::memory_order_relaxed)){}
+	}
+
+	ofSerialHistogramSnapshot snapshot() const{
+		ofSerialHistogramSnapshot copy;
+		for(size_t i = 0; i < copy.numBuckets; i++){
+			copy.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+		}
+		copy.count = count.load(std::memory_order_relaxed);
+		copy.sumNs = sumNs.load(std::memory_order_relaxed);
+		copy.maxNs = maxNs.load(std::memory_order_relaxed);
+		return copy;
+	}
+
+	void reset(){
+		for(auto & bucket: buckets){
+			bucket.store(0, std::memory_order_relaxed);
+		}
+		count.store(0, std::memory_order_relaxed);
+		sumNs.store(0, std::memory_order_relaxed);
+		maxNs.store(0, std::memory_order_relaxed);
+	}
+
+protected:
+	/// \cond INTERNAL
+	std::array<std::atomic<uint64_t>, ofSerialHistogramSnapshot::numBuckets> buckets = {};
+	std::atomic<uint64_t> count{0};
+	std::atomic<uint64_t> sumNs{0};
+	std::atomic<uint64_t> maxNs{0};
+	/// \endcond
+};
+
+/// \brief Everything ofSerial counted, see ofSerial::getMetrics().
+struct ofSerialMetricsSnapshot {
+	uint64_t bytesRead = 0;  ///< \brief Bytes read from the device, by the reader thread when it runs.
+	uint64_t bytesWritten = 0;  ///< \brief Bytes accepted by the device.
+	uint64_t readCalls = 0;  ///< \brief read() / ReadFile() calls on the device.
+	uint64_t writeCalls = 0;  ///< \brief write() / writev() / WriteFile() calls on the device.
+	uint64_t ioctlCalls = 0;  ///< \brief ioctl() calls, mostly FIONREAD from available().
+	uint64_t eagain = 0;  ///< \brief read() or write() calls that returned EAGAIN.
+	uint64_t eintr = 0;  ///< \brief System calls interrupted by a signal.
+	uint64_t writeStalls = 0;  ///< \brief Times a write waited for the device to accept more bytes.
+	uint64_t bytesDropped = 0;  ///< \brief Bytes discarded by flush(), as far as they could be counted.
+	uint64_t bytesOversized = 0;  ///< \brief Bytes of lines and frames longer than ofSerial::getMaxFrameLength(), discarded.
+	ofSerialHistogramSnapshot readLatency;  ///< \brief Duration of each device read() call.
+	ofSerialHistogramSnapshot writeLatency;  ///< \brief Duration of each device write, stalls included.
+};
+
+/// \brief Per-port counters kept by ofSerial.
+///
+/// Built with OF_SERIAL_METRICS=0 every method is empty and the class holds
+/// nothing, the snapshot is all zeros.
+class ofSerialMetrics {
+
+public:
+#if OF_SERIAL_METRICS
+	using TimePoint = std::chrono::steady_clock::time_point;
+
+	static TimePoint now(){
+		return std::chrono::steady_clock::now();
+	}
+
+	void addRead(size_t bytes, TimePoint begin){
+		readCalls.fetch_add(1, std::memory_order_relaxed);
+		bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+		readLatency.record(elapsedNs(begin));
+	}
+	void addBytesRead(size_t bytes){
+		bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+	}
+	void addWriteCall(){
+		writeCalls.fetch_add(1, std::memory_order_relaxed);
+	}
+	void addBytesWritten(size_t bytes){
+		bytesWritten.fetch_add(bytes, std::memory_order_relaxed);
+	}
+	void addWriteLatency(TimePoint begin){
+		writeLatency.record(elapsedNs(begin));
+	}
+	void addIoctl(){
+		ioctlCalls.fetch_add(1, std::memory_order_relaxed);
+	}
+	/// \brief Counts EAGAIN and EINTR, other errors are ignored.
+	void addError(int error){
+		if(error == EAGAIN){
+			eagain.fetch_add(1, std::memory_order_relaxed);
+		} else if(error == EINTR){
+			eintr.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	void addWriteStall(){
+		writeStalls.fetch_add(1, std::memory_order_relaxed);
+	}
+	void addBytesDropped(size_t bytes){
+		bytesDropped.fetch_add(bytes, std::memory_order_relaxed);
+	}
+	void addBytesOversized(size_t bytes){
+		bytesOversized.fetch_add(bytes, std::memory_order_relaxed);
+	}
+
+	ofSerialMetricsSnapshot snapshot() const{
+		ofSerialMetricsSnapshot copy;
+		copy.bytesRead = bytesRead.load(std::memory_order_relaxed);
+		copy.bytesWritten = bytesWritten.load(std::memory_order_relaxed);
+		copy.readCalls = readCalls.load(std::memory_order_relaxed);
+		copy.writeCalls = writeCalls.load(std::memory_order_relaxed);
+		copy.ioctlCalls = ioctlCalls.load(std::memory_order_relaxed);
+		copy.eagain = eagain.load(std::memory_order_relaxed);
+		copy.eintr = eintr.load(std::memory_order_relaxed);
+		copy.writeStalls = writeStalls.load(std::memory_order_relaxed);
+		copy.bytesDropped = bytesDropped.load(std::memory_order_relaxed);
+		copy.bytesOversized = bytesOversized.load(std::memory_order_relaxed);
+		copy.readLatency = readLatency.snapshot();
+		copy.writeLatency = writeLatency.snapshot();
+		return copy;
+	}
+
+	void reset(){
+		for(auto counter: { &bytesRead, &bytesWritten, &readCalls, &writeCalls, &ioctlCalls, &eagain, &eintr, &writeStalls, &bytesDropped, &bytesOversized }){
+			counter->store(0, std::memory_order_relaxed);
+		}
+		readLatency.reset();
+		writeLatency.reset();
+	}
+
+protected:
+	/// \cond INTERNAL
+	static uint64_t elapsedNs(TimePoint begin){
+		return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now() - begin).count());
+	}
+
+	std::atomic<uint64_t> bytesRead{0};
+	std::atomic<uint64_t> bytesWritten{0};
+	std::atomic<uint64_t> readCalls{0};
+	std::atomic<uint64_t> writeCalls{0};
+	std::atomic<uint64_t> ioctlCalls{0};
+	std::atomic<uint64_t> eagain{0};
+	std::atomic<uint64_t> eintr{0};
+	std::atomic<uint64_t> writeStalls{0};
+	std::atomic<uint64_t> bytesDropped{0};
+	std::atomic<uint64_t> bytesOversized{0};
+	ofSerialHistogram readLatency;
+	ofSerialHistogram writeLatency;
+	/// \endcond
+#else
+	struct TimePoint {};
+
+	static TimePoint now(){
+		return {};
+	}
+	void addRead(size_t, TimePoint){}
+	void addBytesRead(size_t){}
+	void addWriteCall(){}
+	void addBytesWritten(size_t){}
+	void addWriteLatency(TimePoint){}
+	void addIoctl(){}
+	void addError(int){}
+	void addWriteStall(){}
+	void addBytesDropped(size_t){}
+	void addBytesOversized(size_t){}
+	ofSerialMetricsSnapshot snapshot() const{
+		return {};
+	}
+	void reset(){}
+#endif
+};
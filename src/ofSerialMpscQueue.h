@@ -0,0 +1,105 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/// \brief Bounded lock-free multi-producer/single-consumer queue.
+///
+/// Any number of threads may push while one thread pops, without any lock.
+/// Each cell carries a sequence number telling whose turn it is: producers
+/// claim a position with a compare-and-swap on the tail, fill the cell and
+/// publish it by bumping its sequence; the consumer takes cells in order as
+/// their sequence says they are full. A producer that claimed a cell but was
+/// preempted before publishing it holds the consumer back, nobody else.
+///
+/// The cells are allocated once, the queue never allocates afterwards.
+/// ofSerial uses it for the writer thread queue, see ofSerial::writeAsync().
+template<typename T>
+class ofSerialMpscQueue {
+
+public:
+	static constexpr size_t cacheLineSize = 64;
+
+	/// \param capacity Number of elements the queue holds, at least 1.
+	explicit ofSerialMpscQueue(size_t capacity)
+	:numCells(capacity > 0 ? capacity : 1)
+	,cells(std::make_unique<Cell[]>(numCells)){
+		for(size_t i = 0; i < numCells; i++){
+			cells[i].sequence.store(2 * i, std::memory_order_relaxed);
+		}
+	}
+
+	ofSerialMpscQueue(const ofSerialMpscQueue &) = delete;
+	ofSerialMpscQueue & operator=(const ofSerialMpscQueue &) = delete;
+
+	size_t capacity() const{
+		return numCells;
+	}
+
+	/// \returns The number of queued elements, only a hint while producers push.
+	size_t size() const{
+		const size_t h = head.value.load(std::memory_order_acquire);
+		const size_t t = tail.value.load(std::memory_order_acquire);
+		return t > h ? t - h : 0;
+	}
+
+	/// \brief Moves 'value' into the queue, from any thread.
+	/// \returns false if the queue is full, 'value' is left untouched.
+	bool tryPush(T && value){
+		size_t position = tail.value.load(std::memory_order_relaxed);
+		while(true){
+			Cell & cell = cells[position % numCells];
+			const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			if(sequence == 2 * position){
+				if(tail.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)){
+					cell.value = std::move(value);
+					cell.sequence.store(2 * position + 1, std::memory_order_release);
+					return true;
+				}
+			} else if(sequence < 2 * position){
+				// the cell still holds the element of the previous lap
+				return false;
+			} else {
+				position = tail.value.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/// \brief Moves the oldest element into 'value', consumer thread only.
+	/// \returns false if the queue is empty, or its oldest element is not published yet.
+	bool tryPop(T & value){
+		const size_t position = head.value.load(std::memory_order_relaxed);
+		Cell & cell = cells[position % numCells];
+		if(cell.sequence.load(std::memory_order_acquire) != 2 * position + 1){
+			return false;
+		}
+		value = std::move(cell.value);
+		cell.value = T();
+		cell.sequence.store(2 * (position + numCells), std::memory_order_release);
+		head.value.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+protected:
+	/// \cond INTERNAL
+	struct Cell {
+		std::atomic<size_t> sequence{0};  ///< \brief 2 * position while free for it, 2 * position + 1 once filled.
+		T value;
+	};
+
+	struct alignas(cacheLineSize) PaddedIndex {
+		std::atomic<size_t> value{0};
+	};
+
+	PaddedIndex tail;  ///< \brief Next position to push, claimed by the producers.
+	PaddedIndex head;  ///< \brief Next position to pop, owned by the consumer.
+	size_t numCells;
+	std::unique_ptr<Cell[]> cells;
+	/// \endcond
+};
@@ -0,0 +1,322 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialReactor.h"
+
+#ifdef TARGET_LINUX
+
+#include <algorithm>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+//----------------------------------------------------------------
+ofSerialReactor::ofSerialReactor(size_t readChunkSize){
+	readBuffer.resize(readChunkSize > 0 ? readChunkSize : 1);
+
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if(epollFd == -1){
+		std::cerr << "ofSerialReactor(): epoll_create1 failed: " << strerror(errno) << std::endl;
+		return;
+	}
+
+	wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(wakeFd == -1){
+		std::cerr << "ofSerialReactor(): eventfd failed: " << strerror(errno) << std::endl;
+		::close(epollFd);
+		epollFd = -1;
+		return;
+	}
+
+	// a null data pointer identifies the wake up event
+	struct epoll_event ev = {};
+	ev.events = EPOLLIN;
+	ev.data.ptr = nullptr;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+
+	if(timerWheel.getFileDescriptor() != -1){
+		ev.data.ptr = &timerWheel;
+		epoll_ctl(epollFd, EPOLL_CTL_ADD, timerWheel.getFileDescriptor(), &ev);
+	}
+}
+
+//----------------------------------------------------------------
+ofSerialReactor::~ofSerialReactor(){
+	// the ports outlive the reactor, their write staged callbacks must not reach it anymore
+	for(auto & entry: entries){
+		if(!entry->removed){
+			epoll_ctl(epollFd, EPOLL_CTL_DEL, entry->fd, nullptr);
+			entry->removed = true;
+			entry->writeTimer.cancel();
+			entry->port->setWriteStagedCallback(nullptr);
+		}
+	}
+	if(wakeFd != -1){
+		::close(wakeFd);
+	}
+	if(epollFd != -1){
+		::close(epollFd);
+	}
+}
+
+//----------------------------------------------------------------
+bool ofSerialReactor::isValid() const{
+	return epollFd != -1;
+}
+
+//----------------------------------------------------------------
+ofSerialReactor::Entry * ofSerialReactor::findEntry(const ofSerial & port) const{
+	for(auto & entry: entries){
+		if(entry->port == &port && !entry->removed){
+			return entry.get();
+		}
+	}
+	return nullptr;
+}
+
+//----------------------------------------------------------------
+bool ofSerialReactor::addPort(ofSerial & port, DataCallback onData, EventCallback onReadable, EventCallback onHangup){
+	if(!isValid()){
+		return false;
+	}
+	const int fd = port.getFileDescriptor();
+	if(fd == -1){
+		std::cerr << "addPort(): serial not inited" << std::endl;
+		return false;
+	}
+	if(findEntry(port) != nullptr){
+		std::cerr << "addPort(): port already registered" << std::endl;
+		return false;
+	}
+
+	auto entry = std::make_unique<Entry>();
+	entry->port = &port;
+	entry->fd = fd;
+	entry->onData = std::move(onData);
+	entry->onReadable = std::move(onReadable);
+	entry->onHangup = std::move(onHangup);
+	entry->removed = false;
+	Entry * timed = entry.get();
+	entry->writeTimer.setCallback([this, timed](){
+		timed->port->pollWriteTimer();
+		// a write in progress on another thread kept the bytes, try again on the next tick
+		armWriteTimer(*timed, true);
+	});
+
+	struct epoll_event ev = {};
+	ev.events = EPOLLIN | EPOLLRDHUP;
+	ev.data.ptr = entry.get();
+	if(epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0){
+		std::cerr << "addPort(): epoll_ctl failed: " << strerror(errno) << std::endl;
+		return false;
+	}
+
+	port.setWriteStagedCallback([this, timed](ofSerial &){
+		queueWriteTimer(timed);
+	});
+	// the port may be staging already
+	armWriteTimer(*timed);
+
+	entries.push_back(std::move(entry));
+	return true;
+}
+
+//----------------------------------------------------------------
+bool ofSerialReactor::removePort(ofSerial & port){
+	Entry * entry = findEntry(port);
+	if(entry == nullptr){
+		return false;
+	}
+
+	epoll_ctl(epollFd, EPOLL_CTL_DEL, entry->fd, nullptr);
+	entry->removed = true;
+	entry->writeTimer.cancel();
+	// no writer thread can queue the entry once this returns
+	port.setWriteStagedCallback(nullptr);
+	{
+		std::lock_guard<std::mutex> lock(armMutex);
+		armQueue.erase(std::remove(armQueue.begin(), armQueue.end(), entry), armQueue.end());
+		entry->bArmQueued = false;
+	}
+	std::replace(armBatch.begin(), armBatch.end(), entry, static_cast<Entry *>(nullptr));
+
+	// events already fetched by poll() may still point to the entry
+	if(!bDispatching){
+		collectRemoved();
+	}
+	return true;
+}
+
+//----------------------------------------------------------------
+void ofSerialReactor::collectRemoved(){
+	entries.erase(std::remove_if(entries.begin(), entries.end(), [](const std::unique_ptr<Entry> & entry){
+		return entry->removed;
+	}), entries.end());
+}
+
+//----------------------------------------------------------------
+size_t ofSerialReactor::getNumPorts() const{
+	size_t count = 0;
+	for(auto & entry: entries){
+		if(!entry->removed){
+			count++;
+		}
+	}
+	return count;
+}
+
+//----------------------------------------------------------------
+int ofSerialReactor::poll(int timeoutMs){
+	if(!isValid()){
+		return -1;
+	}
+
+	pollThread = std::this_thread::get_id();
+	armQueuedWriteTimers();
+
+	constexpr int maxEvents = 64;
+	struct epoll_event events[maxEvents];
+	const int nEvents = epoll_wait(epollFd, events, maxEvents, timeoutMs);
+	if(nEvents < 0){
+		if(errno == EINTR){
+			return 0;
+		}
+		std::cerr << "poll(): epoll_wait failed: " << strerror(errno) << std::endl;
+		return -1;
+	}
+
+	bDispatching = true;
+	int dispatched = 0;
+	for(int i = 0; i < nEvents; i++){
+		auto * entry = static_cast<Entry *>(events[i].data.ptr);
+		const uint32_t flags = events[i].events;
+
+		if(entry == nullptr){
+			uint64_t value;
+			while(read(wakeFd, &value, sizeof(value)) > 0){}
+			armQueuedWriteTimers();
+			continue;
+		}
+		if(events[i].data.ptr == &timerWheel){
+			timerWheel.advance();
+			dispatched++;
+			continue;
+		}
+		if(entry->removed){
+			continue;
+		}
+
+		ofSerial & port = *entry->port;
+		const bool hangup = (flags & (EPOLLHUP | EPOLLRDHUP | EPOLLERR)) != 0;
+
+		// on hang up a tty stays readable forever, only read what is left
+		if((flags & EPOLLIN) && (!hangup || port.available() > 0)){
+			if(entry->onData){
+				const size_t nRead = port.readBytes(readBuffer.data(), readBuffer.size());
+				if(nRead > 0){
+					entry->onData(port, readBuffer.data(), nRead);
+				}
+			} else if(entry->onReadable){
+				entry->onReadable(port);
+			}
+			dispatched++;
+		} else if(hangup){
+			EventCallback onHangup = entry->onHangup;
+			removePort(port);
+			if(onHangup){
+				onHangup(port);
+			}
+			dispatched++;
+		}
+	}
+	bDispatching = false;
+	// the callbacks may have staged writes
+	armQueuedWriteTimers();
+	collectRemoved();
+	pollThread = std::thread::id();
+
+	return dispatched;
+}
+
+//----------------------------------------------------------------
+void ofSerialReactor::queueWriteTimer(Entry * entry){
+	{
+		std::lock_guard<std::mutex> lock(armMutex);
+		if(entry->bArmQueued){
+			return;
+		}
+		entry->bArmQueued = true;
+		armQueue.push_back(entry);
+	}
+	// the reactor thread arms the queue before it waits again
+	if(std::this_thread::get_id() != pollThread){
+		const uint64_t one = 1;
+		auto unused = write(wakeFd, &one, sizeof(one));
+		(void)unused;
+	}
+}
+
+//----------------------------------------------------------------
+void ofSerialReactor::armQueuedWriteTimers(){
+	{
+		std::lock_guard<std::mutex> lock(armMutex);
+		if(armQueue.empty()){
+			return;
+		}
+		armBatch.swap(armQueue);
+		for(Entry * entry: armBatch){
+			entry->bArmQueued = false;
+		}
+	}
+	// a timer callback may remove a port meanwhile, it clears its slot
+	for(size_t i = 0; i < armBatch.size(); i++){
+		if(armBatch[i] != nullptr){
+			armWriteTimer(*armBatch[i]);
+		}
+	}
+	armBatch.clear();
+}
+
+//----------------------------------------------------------------
+void ofSerialReactor::armWriteTimer(Entry & entry, bool bRetry){
+	if(entry.removed){
+		return;
+	}
+	const auto deadline = entry.port->getWriteDeadline();
+	if(deadline == std::chrono::steady_clock::time_point::max()){
+		entry.writeTimer.cancel();
+		return;
+	}
+	if(bRetry){
+		timerWheel.arm(entry.writeTimer, std::max(deadline, std::chrono::steady_clock::now() + std::chrono::microseconds(100)));
+	} else {
+		timerWheel.arm(entry.writeTimer, deadline);
+	}
+}
+
+//----------------------------------------------------------------
+void ofSerialReactor::run(){
+	bRunning = true;
+	while(bRunning){
+		if(poll(-1) < 0){
+			break;
+		}
+	}
+	bRunning = false;
+}
+
+//----------------------------------------------------------------
+void ofSerialReactor::stop(){
+	bRunning = false;
+	const uint64_t one = 1;
+	if(wakeFd != -1){
+		auto unused = write(wakeFd, &one, sizeof(one));
+		(void)unused;
+	}
+}
+
+#endif // TARGET_LINUX
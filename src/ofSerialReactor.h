@@ -0,0 +1,138 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include "ofSerial.h"
+#include "ofSerialTimerWheel.h"
+
+#ifdef TARGET_LINUX
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// \brief ofSerialReactor services many ofSerial ports from a single thread.
+///
+/// Instead of one thread per port spinning on available() and readBytes(),
+/// the file descriptors of all registered ports are watched with epoll. When
+/// a port becomes readable the reactor reads it once into a shared buffer and
+/// hands the bytes to the data callback, so an idle port costs nothing.
+///
+/// ~~~~{.cpp}
+/// ofSerialReactor reactor;
+/// reactor.addPort(serial, [](ofSerial & port, const uint8_t * data, size_t length){
+///	 // consume data
+/// });
+/// reactor.run(); // returns once stop() is called from any thread
+/// ~~~~
+///
+/// The ports must stay opened and alive while registered, the destructor
+/// unregisters the ports left, which may then be used on their own. Callbacks are run
+/// from the thread calling poll() or run(), they may add or remove ports.
+/// Writes staged by ports using setWriteCoalescing() are sent on time, even
+/// when another thread wrote them while the reactor was blocked: a port that
+/// starts staging queues itself and wakes the reactor up, which arms a timer
+/// for its deadline on its ofSerialTimerWheel, whose timerfd is watched with
+/// the ports. Other timeouts can be armed on the same wheel, see
+/// getTimerWheel().
+class ofSerialReactor {
+
+public:
+	/// \brief Called with the bytes read from a readable port.
+	using DataCallback = std::function<void(ofSerial & port, const uint8_t * data, size_t length)>;
+
+	/// \brief Called with a port that is readable or that was hung up.
+	using EventCallback = std::function<void(ofSerial & port)>;
+
+	/// \brief Creates the epoll instance.
+	/// \param readChunkSize Size of the buffer shared by all the ports for reading.
+	ofSerialReactor(size_t readChunkSize = 4096);
+
+	~ofSerialReactor();
+
+	ofSerialReactor(const ofSerialReactor &) = delete;
+	ofSerialReactor & operator=(const ofSerialReactor &) = delete;
+
+	/// \returns true if the epoll instance was created.
+	bool isValid() const;
+
+	/// \brief Registers an opened port.
+	///
+	/// If onData is set the reactor reads the port when it becomes readable
+	/// and passes the data along. Otherwise onReadable is called and reading
+	/// is left to the callback. onHangup is called once when the device goes
+	/// away, the port is then removed from the reactor.
+	///
+	/// \returns false if the port is not opened or already registered.
+	bool addPort(ofSerial & port, DataCallback onData, EventCallback onReadable = nullptr, EventCallback onHangup = nullptr);
+
+	/// \brief Unregisters a port, it is safe to call it from a callback.
+	bool removePort(ofSerial & port);
+
+	/// \returns the number of registered ports.
+	size_t getNumPorts() const;
+
+	/// \brief Waits for events and dispatches them once.
+	/// \param timeoutMs Maximum time to wait, -1 waits forever.
+	/// \returns the number of dispatched events, or -1 on error.
+	int poll(int timeoutMs = -1);
+
+	/// \brief Dispatches events until stop() is called.
+	void run();
+
+	/// \brief Makes run() return, it can be called from any thread.
+	void stop();
+
+	/// \brief The wheel advanced by poll(), its timers run on the reactor thread.
+	///
+	/// Its tick is 100 us, fine enough for write coalescing delays.
+	ofSerialTimerWheel & getTimerWheel(){
+		return timerWheel;
+	}
+
+protected:
+	/// \cond INTERNAL
+	struct Entry {
+		ofSerial * port;
+		int fd;
+		DataCallback onData;
+		EventCallback onReadable;
+		EventCallback onHangup;
+		bool removed;
+		ofSerialTimer writeTimer;  ///< \brief Sends the staged writes of the port at their deadline.
+		bool bArmQueued = false;  ///< \brief The entry is in armQueue, guarded by armMutex.
+	};
+
+	Entry * findEntry(const ofSerial & port) const;
+	void collectRemoved();
+
+	/// \brief Called by a port that starts staging writes, from any thread.
+	void queueWriteTimer(Entry * entry);
+
+	/// \brief Arms the write timers of the ports in armQueue, on the reactor thread.
+	void armQueuedWriteTimers();
+
+	/// \brief Arms the write timer of an entry for the current deadline of its port.
+	/// \param bRetry The write side was busy, an overdue deadline is pushed to the next tick.
+	void armWriteTimer(Entry & entry, bool bRetry = false);
+
+	int epollFd = -1; ///< \brief The epoll instance watching every port.
+	int wakeFd = -1; ///< \brief eventfd used by stop() to interrupt epoll_wait().
+	std::atomic<bool> bRunning{false};
+	bool bDispatching = false;
+	std::thread::id pollThread;  ///< \brief The thread in poll(), it does not need to be woken up.
+	std::mutex armMutex;
+	std::vector <Entry *> armQueue;  ///< \brief Entries whose port started staging writes, guarded by armMutex.
+	std::vector <Entry *> armBatch;  ///< \brief armQueue swapped out by the reactor thread.
+	ofSerialTimerWheel timerWheel{std::chrono::microseconds(100)};  ///< \brief Declared before the entries, their timers go first.
+	std::vector <std::unique_ptr<Entry>> entries;
+	std::vector <uint8_t> readBuffer;
+	/// \endcond
+};
+
+#endif // TARGET_LINUX
@@ -0,0 +1,181 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+/// \brief Lock-free single-producer/single-consumer byte ring.
+///
+/// One thread may write while another one reads without any lock or syscall.
+/// The capacity is rounded up to a power of two and allocated once. The
+/// producer and consumer indices live on their own cache lines, each side
+/// keeps a cached copy of the other index so that it only touches the shared
+/// line when the cached value says the ring is full (or empty).
+///
+/// Besides the copying read() and write(), the regions can be accessed in
+/// place, which lets the producer read() a file descriptor straight into the
+/// ring:
+/// ~~~~{.cpp}
+/// auto region = ring.writableRegion();
+/// auto n = ::read(fd, region.data(), region.size());
+/// if(n > 0) ring.commitWrite(size_t(n));
+/// ~~~~
+class ofSerialRingBuffer {
+
+public:
+	static constexpr size_t cacheLineSize = 64;
+
+	/// \brief Allocates the ring.
+	/// \param capacity Minimum number of bytes the ring can hold.
+	explicit ofSerialRingBuffer(size_t capacity){
+		size_t rounded = 1;
+		while(rounded < capacity){
+			rounded <<= 1;
+		}
+		storage.resize(rounded);
+		mask = rounded - 1;
+	}
+
+	ofSerialRingBuffer(const ofSerialRingBuffer &) = delete;
+	ofSerialRingBuffer & operator=(const ofSerialRingBuffer &) = delete;
+
+	/// \returns the number of bytes the ring can hold.
+	size_t capacity() const{
+		return storage.size();
+	}
+
+	/// \returns the number of bytes ready to be read, consumer side.
+	size_t size() const{
+		return head.value.load(std::memory_order_acquire) - tail.value.load(std::memory_order_relaxed);
+	}
+
+	/// \returns true if there is nothing to read, consumer side.
+	bool empty() const{
+		return size() == 0;
+	}
+
+	/// \returns the number of bytes that can be written, producer side.
+	size_t freeSpace() const{
+		return capacity() - (head.value.load(std::memory_order_relaxed) - tail.value.load(std::memory_order_acquire));
+	}
+
+	/// \name Producer
+	/// \{
+
+	/// \brief Gets the contiguous region that can be written in place.
+	///
+	/// The region may be shorter than freeSpace() when it wraps around.
+	std::span<uint8_t> writableRegion(){
+		const size_t h = head.value.load(std::memory_order_relaxed);
+		if(capacity() - (h - cachedTail) == 0){
+			cachedTail = tail.value.load(std::memory_order_acquire);
+		}
+		const size_t free = capacity() - (h - cachedTail);
+		const size_t offset = h & mask;
+		return std::span<uint8_t>(storage.data() + offset, std::min(free, capacity() - offset));
+	}
+
+	/// \brief Publishes 'length' bytes written in the writable region.
+	void commitWrite(size_t length){
+		head.value.store(head.value.load(std::memory_order_relaxed) + length, std::memory_order_release);
+	}
+
+	/// \brief Copies at most 'length' bytes into the ring.
+	/// \returns the number of bytes actually written.
+	size_t write(const uint8_t * buffer, size_t length){
+		size_t written = 0;
+		while(written < length){
+			auto region = writableRegion();
+			if(region.empty()){
+				break;
+			}
+			const size_t n = std::min(region.size(), length - written);
+			memcpy(region.data(), buffer + written, n);
+			commitWrite(n);
+			written += n;
+		}
+		return written;
+	}
+
+	/// \}
+	/// \name Consumer
+	/// \{
+
+	/// \brief Gets the contiguous region that can be read in place.
+	///
+	/// The region may be shorter than size() when it wraps around.
+	std::span<const uint8_t> readableRegion(){
+		const size_t t = tail.value.load(std::memory_order_relaxed);
+		if(cachedHead == t){
+			cachedHead = head.value.load(std::memory_order_acquire);
+		}
+		const size_t offset = t & mask;
+		return std::span<const uint8_t>(storage.data() + offset, std::min(cachedHead - t, capacity() - offset));
+	}
+
+	/// \brief Releases 'length' bytes read from the readable region.
+	void commitRead(size_t length){
+		tail.value.store(tail.value.load(std::memory_order_relaxed) + length, std::memory_order_release);
+	}
+
+	/// \brief Copies at most 'length' bytes out of the ring.
+	/// \returns the number of bytes actually read.
+	size_t read(uint8_t * buffer, size_t length){
+		size_t nRead = 0;
+		while(nRead < length){
+			auto region = readableRegion();
+			if(region.empty()){
+				break;
+			}
+			const size_t n = std::min(region.size(), length - nRead);
+			memcpy(buffer + nRead, region.data(), n);
+			commitRead(n);
+			nRead += n;
+		}
+		return nRead;
+	}
+
+	/// \brief Reads a single byte.
+	/// \returns the byte, or -1 if the ring is empty.
+	int readByte(){
+		const size_t t = tail.value.load(std::memory_order_relaxed);
+		if(cachedHead == t){
+			cachedHead = head.value.load(std::memory_order_acquire);
+			if(cachedHead == t){
+				return -1;
+			}
+		}
+		const uint8_t byte = storage[t & mask];
+		tail.value.store(t + 1, std::memory_order_release);
+		return byte;
+	}
+
+	/// \brief Drops everything that is ready to be read.
+	void discard(){
+		cachedHead = head.value.load(std::memory_order_acquire);
+		tail.value.store(cachedHead, std::memory_order_release);
+	}
+
+	/// \}
+
+protected:
+	/// \cond INTERNAL
+	struct alignas(cacheLineSize) PaddedIndex {
+		std::atomic<size_t> value{0};
+	};
+
+	PaddedIndex head; ///< \brief Total number of bytes written, owned by the producer.
+	PaddedIndex tail; ///< \brief Total number of bytes read, owned by the consumer.
+	alignas(cacheLineSize) size_t cachedTail = 0; ///< \brief Producer copy of tail.
+	alignas(cacheLineSize) size_t cachedHead = 0; ///< \brief Consumer copy of head.
+	alignas(cacheLineSize) size_t mask = 0;
+	std::vector <uint8_t> storage;
+	/// \endcond
+};
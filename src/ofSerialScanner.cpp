@@ -0,0 +1,161 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialScanner.h"
+
+#include <algorithm>
+
+#if ( defined( __x86_64__ ) || defined( __i386__ ) ) && ( defined( __GNUC__ ) || defined( __clang__ ) )
+	#define OF_SERIAL_SCANNER_X86
+	#include <immintrin.h>
+#endif
+
+using Kernel = size_t (*)(const ofSerialScanner & scanner, const uint8_t * data, size_t length, size_t * offsets, size_t maxOffsets);
+
+//----------------------------------------------------------------
+static size_t scanScalar(const ofSerialScanner & scanner, const uint8_t * data, size_t length, size_t * offsets, size_t maxOffsets){
+	size_t n = 0;
+	for(size_t i = 0; i < length && n < maxOffsets; i++){
+		if(scanner.isDelimiter(data[i])){
+			offsets[n++] = i;
+		}
+	}
+	return n;
+}
+
+#ifdef OF_SERIAL_SCANNER_X86
+
+//----------------------------------------------------------------
+__attribute__((target("sse2")))
+static size_t scanSSE2(const ofSerialScanner & scanner, const uint8_t * data, size_t length, size_t * offsets, size_t maxOffsets){
+	const auto delimiters = scanner.getDelimiters();
+	__m128i needles[ofSerialScanner::maxDelimiters];
+	for(size_t k = 0; k < delimiters.size(); k++){
+		needles[k] = _mm_set1_epi8(static_cast<char>(delimiters[k]));
+	}
+
+	size_t n = 0;
+	size_t i = 0;
+	for(; i + 16 <= length; i += 16){
+		const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+		__m128i matches = _mm_cmpeq_epi8(block, needles[0]);
+		for(size_t k = 1; k < delimiters.size(); k++){
+			matches = _mm_or_si128(matches, _mm_cmpeq_epi8(block, needles[k]));
+		}
+		auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+		while(mask != 0){
+			offsets[n++] = i + static_cast<size_t>(__builtin_ctz(mask));
+			if(n == maxOffsets){
+				return n;
+			}
+			mask &= mask - 1;
+		}
+	}
+
+	const size_t tail = scanScalar(scanner, data + i, length - i, offsets + n, maxOffsets - n);
+	for(size_t k = n; k < n + tail; k++){
+		offsets[k] += i;
+	}
+	return n + tail;
+}
+
+//----------------------------------------------------------------
+__attribute__((target("avx2")))
+static size_t scanAVX2(const ofSerialScanner & scanner, const uint8_t * data, size_t length, size_t * offsets, size_t maxOffsets){
+	const auto delimiters = scanner.getDelimiters();
+	__m256i needles[ofSerialScanner::maxDelimiters];
+	for(size_t k = 0; k < delimiters.size(); k++){
+		needles[k] = _mm256_set1_epi8(static_cast<char>(delimiters[k]));
+	}
+
+	size_t n = 0;
+	size_t i = 0;
+	for(; i + 32 <= length; i += 32){
+		const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+		__m256i matches = _mm256_cmpeq_epi8(block, needles[0]);
+		for(size_t k = 1; k < delimiters.size(); k++){
+			matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(block, needles[k]));
+		}
+		auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+		while(mask != 0){
+			offsets[n++] = i + static_cast<size_t>(__builtin_ctz(mask));
+			if(n == maxOffsets){
+				return n;
+			}
+			mask &= mask - 1;
+		}
+	}
+
+	const size_t tail = scanSSE2(scanner, data + i, length - i, offsets + n, maxOffsets - n);
+	for(size_t k = n; k < n + tail; k++){
+		offsets[k] += i;
+	}
+	return n + tail;
+}
+
+#endif // OF_SERIAL_SCANNER_X86
+
+//----------------------------------------------------------------
+struct KernelChoice {
+	Kernel kernel;
+	const char * name;
+};
+
+static const KernelChoice & getKernel(){
+	static const KernelChoice choice = [](){
+		#ifdef OF_SERIAL_SCANNER_X86
+			__builtin_cpu_init();
+			if(__builtin_cpu_supports("avx2")){
+				return KernelChoice{ scanAVX2, "avx2" };
+			}
+			if(__builtin_cpu_supports("sse2")){
+				return KernelChoice{ scanSSE2, "sse2" };
+			}
+		#endif
+		return KernelChoice{ scanScalar, "scalar" };
+	}();
+	return choice;
+}
+
+//----------------------------------------------------------------
+ofSerialScanner::ofSerialScanner(std::initializer_list<uint8_t> list){
+	init(list.begin(), list.size());
+}
+
+//----------------------------------------------------------------
+ofSerialScanner::ofSerialScanner(std::span<const uint8_t> list){
+	init(list.data(), list.size());
+}
+
+//----------------------------------------------------------------
+void ofSerialScanner::init(const uint8_t * list, size_t count){
+	for(size_t i = 0; i < count && numDelimiters < maxDelimiters; i++){
+		if(!table[list[i]]){
+			table[list[i]] = true;
+			delimiters[numDelimiters++] = list[i];
+		}
+	}
+}
+
+//----------------------------------------------------------------
+size_t ofSerialScanner::find(const uint8_t * data, size_t length) const{
+	size_t offset;
+	if(scan(data, length, std::span<size_t>(&offset, 1)) == 0){
+		return length;
+	}
+	return offset;
+}
+
+//----------------------------------------------------------------
+size_t ofSerialScanner::scan(const uint8_t * data, size_t length, std::span<size_t> offsets) const{
+	if(numDelimiters == 0 || offsets.empty()){
+		return 0;
+	}
+	return getKernel().kernel(*this, data, length, offsets.data(), offsets.size());
+}
+
+//----------------------------------------------------------------
+const char * ofSerialScanner::getKernelName(){
+	return getKernel().name;
+}
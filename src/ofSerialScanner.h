@@ -0,0 +1,69 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+
+/// \brief Finds any of a small set of delimiter bytes in received data.
+///
+/// Serial framings end their frames with a known byte: '\n' (or "\r\n") for
+/// lines, 0xC0 for SLIP, 0x00 for COBS. The scanner compares 16 (SSE2) or 32
+/// (AVX2) bytes per instruction against every delimiter and turns the matches
+/// into offsets with a bit scan, so a 64 KiB burst is split into frames in
+/// one pass. The best kernel is picked once at runtime, a scalar lookup table
+/// is used on other CPUs.
+///
+/// ~~~~{.cpp}
+/// ofSerialScanner scanner({'\r', '\n'});
+/// size_t offsets[256];
+/// size_t n = scanner.scan(data, length, offsets);
+/// // data[offsets[0]] is the first delimiter, data[offsets[1]] the next...
+/// ~~~~
+class ofSerialScanner {
+
+public:
+	/// \brief Maximum number of delimiters a scanner can look for.
+	static constexpr size_t maxDelimiters = 8;
+
+	/// \brief Creates a scanner, extra delimiters beyond maxDelimiters are ignored.
+	ofSerialScanner(std::initializer_list<uint8_t> delimiters);
+	ofSerialScanner(std::span<const uint8_t> delimiters);
+
+	/// \brief Finds the first delimiter.
+	/// \returns its offset, or 'length' if there is none.
+	size_t find(const uint8_t * data, size_t length) const;
+
+	/// \brief Finds the delimiters in bulk.
+	///
+	/// Stops when 'offsets' is full, scan again from the byte following the
+	/// last offset to get the next ones.
+	/// \returns the number of offsets written.
+	size_t scan(const uint8_t * data, size_t length, std::span<size_t> offsets) const;
+
+	/// \returns true if 'byte' is one of the delimiters.
+	bool isDelimiter(uint8_t byte) const{
+		return table[byte];
+	}
+
+	/// \returns the delimiters.
+	std::span<const uint8_t> getDelimiters() const{
+		return std::span<const uint8_t>(delimiters, numDelimiters);
+	}
+
+	/// \returns the name of the kernel in use: "avx2", "sse2" or "scalar".
+	static const char * getKernelName();
+
+protected:
+	/// \cond INTERNAL
+	void init(const uint8_t * list, size_t count);
+
+	uint8_t delimiters[maxDelimiters] = {};
+	size_t numDelimiters = 0;
+	bool table[256] = {};
+	/// \endcond
+};
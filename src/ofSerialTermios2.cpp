@@ -0,0 +1,44 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialTermios2.h"
+
+#if defined( __linux__ )
+
+#include <asm/termbits.h>
+#include <sys/ioctl.h>
+
+//----------------------------------------------------------------
+bool ofSerialHasArbitraryBaud(){
+	// some architectures' headers predate termios2
+	#if defined( BOTHER ) && defined( TCGETS2 )
+		return true;
+	#else
+		return false;
+	#endif
+}
+
+//----------------------------------------------------------------
+bool ofSerialSetArbitraryBaud(int fd, size_t baud){
+	struct termios2 options;
+	if(ioctl(fd, TCGETS2, &options) != 0){
+		return false;
+	}
+	options.c_cflag &= ~tcflag_t(CBAUD | (CBAUD << IBSHIFT));
+	options.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+	options.c_ispeed = static_cast<speed_t>(baud);
+	options.c_ospeed = static_cast<speed_t>(baud);
+	return ioctl(fd, TCSETS2, &options) == 0;
+}
+
+//----------------------------------------------------------------
+size_t ofSerialGetBaud(int fd){
+	struct termios2 options;
+	if(ioctl(fd, TCGETS2, &options) != 0){
+		return 0;
+	}
+	return options.c_ospeed;
+}
+
+#endif
@@ -0,0 +1,22 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include <cstddef>
+
+/// \cond INTERNAL
+// termios2 comes from <asm/termbits.h>, which clashes with <termios.h>, so
+// the ioctls are wrapped in their own translation unit.
+
+/// \brief Sets any baud rate with termios2 and BOTHER, the other settings are kept.
+/// \returns false if the driver refused it, errno is set.
+bool ofSerialSetArbitraryBaud(int fd, size_t baud);
+
+/// \returns true if the kernel headers define termios2 and BOTHER, so ofSerialSetArbitraryBaud() can work.
+bool ofSerialHasArbitraryBaud();
+
+/// \returns The output rate reported by the driver, 0 if it can't be read.
+size_t ofSerialGetBaud(int fd);
+/// \endcond
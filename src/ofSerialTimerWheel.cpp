@@ -0,0 +1,192 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialTimerWheel.h"
+
+#include <algorithm>
+#include <bit>
+#include <iostream>
+
+#ifdef TARGET_LINUX
+	#include <sys/timerfd.h>
+	#include <unistd.h>
+	#include <cerrno>
+	#include <cstring>
+#endif
+
+//----------------------------------------------------------------
+ofSerialTimer::~ofSerialTimer(){
+	cancel();
+}
+
+//----------------------------------------------------------------
+void ofSerialTimer::cancel(){
+	if(wheel != nullptr){
+		wheel->cancel(*this);
+	}
+}
+
+//----------------------------------------------------------------
+ofSerialTimerWheel::ofSerialTimerWheel(std::chrono::microseconds tick)
+:origin(Clock::now())
+,tickDuration(std::max<std::chrono::nanoseconds>(tick, std::chrono::microseconds(1)))
+,tickNs(uint64_t(tickDuration.count())){
+	#ifdef TARGET_LINUX
+		timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		if(timerFd == -1){
+			std::cerr << "ofSerialTimerWheel(): timerfd_create failed: " << strerror(errno) << std::endl;
+		}
+	#endif
+}
+
+//----------------------------------------------------------------
+ofSerialTimerWheel::~ofSerialTimerWheel(){
+	for(auto & head: slots){
+		while(head != nullptr){
+			unlink(*head);
+		}
+	}
+	#ifdef TARGET_LINUX
+		if(timerFd != -1){
+			::close(timerFd);
+		}
+	#endif
+}
+
+//----------------------------------------------------------------
+size_t ofSerialTimerWheel::findOccupied(size_t level, size_t index) const{
+	size_t bit = level * slotsPerLevel + index;
+	const size_t end = (level + 1) * slotsPerLevel;
+	while(bit < end){
+		const uint64_t word = occupied[bit / 64] >> (bit % 64);
+		if(word != 0){
+			bit += size_t(std::countr_zero(word));
+			return bit < end ? bit - level * slotsPerLevel : slotsPerLevel;
+		}
+		bit = (bit / 64 + 1) * 64;
+	}
+	return slotsPerLevel;
+}
+
+//----------------------------------------------------------------
+void ofSerialTimerWheel::cascade(size_t level, size_t index){
+	const size_t slot = level * slotsPerLevel + index;
+	ofSerialTimer * pending = slots[slot];
+	if(pending == nullptr){
+		return;
+	}
+	// detached first: some timers may land in the same slot again
+	slots[slot] = nullptr;
+	pending->pprev = &pending;
+	occupied[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+	while(pending != nullptr){
+		insert(*pending, pending->expires, next);
+	}
+}
+
+//----------------------------------------------------------------
+size_t ofSerialTimerWheel::advance(Clock::time_point now){
+	const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - origin).count();
+	const uint64_t target = elapsed > 0 ? uint64_t(elapsed) / tickNs : 0;
+
+	#ifdef TARGET_LINUX
+		// only a timerfd that expired is readable, and it stays so until read
+		if(timerFd != -1 && armedTick <= target){
+			uint64_t expirations;
+			auto unused = read(timerFd, &expirations, sizeof(expirations));
+			(void)unused;
+			armedTick = UINT64_MAX;
+		}
+	#endif
+	size_t fired = 0;
+	while(next <= target){
+		if(numArmed == 0){
+			next = target + 1;
+			break;
+		}
+		const size_t index = size_t(next & slotMask);
+		if(index == 0){
+			// level n wrapped around: bring the timers of the next slot of level n + 1 closer
+			for(size_t level = 1; level < numLevels; level++){
+				const size_t levelIndex = size_t((next >> (slotBits * level)) & slotMask);
+				cascade(level, levelIndex);
+				if(levelIndex != 0){
+					break;
+				}
+			}
+		}
+
+		// skip the empty slots up to the next timer or the next wrap around
+		const size_t found = findOccupied(0, index);
+		if(found != index){
+			const uint64_t boundary = (next | slotMask) + 1;
+			const uint64_t jump = found == slotsPerLevel ? boundary : next - index + found;
+			next = std::min(jump, target + 1);
+			continue;
+		}
+
+		ofSerialTimer * pending = slots[index];
+		slots[index] = nullptr;
+		pending->pprev = &pending;
+		occupied[index / 64] &= ~(uint64_t(1) << (index % 64));
+		// timers armed by the callbacks go to later ticks
+		next++;
+		while(pending != nullptr){
+			ofSerialTimer & timer = *pending;
+			if(timer.expires >= next){
+				// armed further than the wheel reaches
+				insert(timer, timer.expires, next);
+				continue;
+			}
+			unlink(timer);
+			fired++;
+			if(timer.onExpire){
+				timer.onExpire();
+			}
+		}
+	}
+
+	setTimerFd(getNextExpiryTick());
+	return fired;
+}
+
+//----------------------------------------------------------------
+uint64_t ofSerialTimerWheel::getNextExpiryTick() const{
+	if(numArmed == 0){
+		return UINT64_MAX;
+	}
+	// level 0 holds the exact ticks of this turn, the higher levels are not due before it ends
+	const size_t index = size_t(next & slotMask);
+	const size_t found = findOccupied(0, index);
+	if(found != slotsPerLevel){
+		return next - index + found;
+	}
+	return (next | slotMask) + 1;
+}
+
+//----------------------------------------------------------------
+ofSerialTimerWheel::Clock::time_point ofSerialTimerWheel::getNextExpiry() const{
+	const uint64_t tick = getNextExpiryTick();
+	return tick == UINT64_MAX ? Clock::time_point::max() : toTime(tick);
+}
+
+//----------------------------------------------------------------
+void ofSerialTimerWheel::setTimerFd(uint64_t tick){
+	#ifdef TARGET_LINUX
+		if(timerFd == -1 || tick == armedTick){
+			return;
+		}
+		armedTick = tick;
+		// steady_clock is CLOCK_MONOTONIC, a zero itimerspec disarms the timer
+		struct itimerspec spec = {};
+		if(tick != UINT64_MAX){
+			const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(toTime(tick).time_since_epoch()).count();
+			spec.it_value.tv_sec = std::max<decltype(ns)>(ns / 1000000000, 0);
+			spec.it_value.tv_nsec = std::max<decltype(ns)>(ns % 1000000000, 1);
+		}
+		timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+	#else
+		(void)tick;
+	#endif
+}
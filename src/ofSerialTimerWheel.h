@@ -0,0 +1,229 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include "ofSerial.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+class ofSerialTimerWheel;
+
+/// \brief A timeout that can be armed on an ofSerialTimerWheel.
+///
+/// The timer is linked into the wheel, arming or cancelling it allocates
+/// nothing. It must not be moved or destroyed while armed, the destructor
+/// cancels it.
+class ofSerialTimer {
+	friend class ofSerialTimerWheel;
+
+	public:
+		using Callback = std::function<void()>;
+
+		ofSerialTimer() = default;
+
+		explicit ofSerialTimer(Callback onExpire)
+		:onExpire(std::move(onExpire)){
+		}
+
+		~ofSerialTimer();
+
+		ofSerialTimer(const ofSerialTimer &) = delete;
+		ofSerialTimer & operator=(const ofSerialTimer &) = delete;
+
+		/// \brief Sets what the timer calls when it expires, only while it is not armed.
+		void setCallback(Callback callback){
+			onExpire = std::move(callback);
+		}
+
+		bool isArmed() const{
+			return wheel != nullptr;
+		}
+
+		/// \brief Cancels the timer if it is armed.
+		void cancel();
+
+	protected:
+		/// \cond INTERNAL
+		Callback onExpire;
+		ofSerialTimerWheel * wheel = nullptr;
+		ofSerialTimer * next = nullptr;
+		ofSerialTimer ** pprev = nullptr;  ///< \brief The pointer to this timer in its slot, unlinking needs no search.
+		uint64_t expires = 0;  ///< \brief Tick at which the timer fires.
+		uint16_t slot = 0;  ///< \brief Level * slotsPerLevel + index, to update the occupancy bits.
+		/// \endcond
+};
+
+/// \brief Schedules and cancels thousands of timeouts in constant time.
+///
+/// Four levels of 256 slots each cover 2^32 ticks, about 49 days with the
+/// default 1 ms tick. A timer goes into the slot of its expiry tick on the
+/// finest level that reaches it, and is moved down a level each time the
+/// level below wraps around. Arming and cancelling are a few pointer updates,
+/// see bench/timer_wheel_bench.cpp.
+///
+/// ~~~~{.cpp}
+/// ofSerialTimerWheel wheel;
+/// ofSerialTimer timeout([&](){ onTimeout(); });
+/// wheel.armAfter(timeout, std::chrono::milliseconds(200));
+/// ...
+/// timeout.cancel();
+/// ~~~~
+///
+/// On Linux the wheel owns a timerfd that becomes readable when the next
+/// timer is due: add getFileDescriptor() to epoll and call advance() when it
+/// fires. ofSerialReactor and ofSerialScheduler do that with their own wheel.
+/// Elsewhere call advance() from your loop, getNextExpiry() tells how long it
+/// may sleep. Timers fire at most one tick late, never early. The wheel is
+/// not thread safe, and callbacks run from advance().
+class ofSerialTimerWheel {
+
+public:
+	using Clock = std::chrono::steady_clock;
+
+	/// \param tick Resolution of the wheel.
+	explicit ofSerialTimerWheel(std::chrono::microseconds tick = std::chrono::milliseconds(1));
+
+	/// \brief Cancels the armed timers, they are not called.
+	~ofSerialTimerWheel();
+
+	ofSerialTimerWheel(const ofSerialTimerWheel &) = delete;
+	ofSerialTimerWheel & operator=(const ofSerialTimerWheel &) = delete;
+
+	/// \brief Arms 'timer' to expire at 'deadline', or re-arms it if it is already armed.
+	///
+	/// A deadline that already passed fires at the next advance().
+	void arm(ofSerialTimer & timer, Clock::time_point deadline){
+		insert(timer, toTick(deadline), next);
+		if(timerFd != -1 && timer.expires < armedTick){
+			setTimerFd(timer.expires);
+		}
+	}
+
+	/// \brief Arms 'timer' to expire 'timeout' from now.
+	void armAfter(ofSerialTimer & timer, std::chrono::nanoseconds timeout){
+		arm(timer, Clock::now() + timeout);
+	}
+
+	/// \brief Cancels 'timer' if it is armed on this wheel.
+	void cancel(ofSerialTimer & timer){
+		if(timer.wheel == this){
+			unlink(timer);
+		}
+	}
+
+	/// \brief Fires every timer due at 'now'.
+	/// \returns The number of timers fired.
+	size_t advance(Clock::time_point now = Clock::now());
+
+	/// \returns A time no later than the earliest armed timer, Clock::time_point::max() if none is armed.
+	Clock::time_point getNextExpiry() const;
+
+	/// \returns The number of armed timers.
+	size_t getNumArmed() const{
+		return numArmed;
+	}
+
+	std::chrono::nanoseconds getTick() const{
+		return tickDuration;
+	}
+
+	/// \returns The timerfd to watch for readability, -1 if there is none (not Linux, or it could not be created).
+	int getFileDescriptor() const{
+		return timerFd;
+	}
+
+protected:
+	/// \cond INTERNAL
+	static constexpr size_t numLevels = 4;
+	static constexpr size_t slotBits = 8;
+	static constexpr size_t slotsPerLevel = size_t(1) << slotBits;
+	static constexpr uint64_t slotMask = slotsPerLevel - 1;
+	static constexpr uint64_t maxDelta = (uint64_t(1) << (slotBits * numLevels)) - 1;
+
+	/// \brief First tick at or after 'deadline', so that a timer never fires early.
+	uint64_t toTick(Clock::time_point deadline) const{
+		const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - origin).count();
+		if(elapsed <= 0){
+			return 0;
+		}
+		return (uint64_t(elapsed) + tickNs - 1) / tickNs;
+	}
+
+	Clock::time_point toTime(uint64_t tick) const{
+		return origin + std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(int64_t(tick * tickNs)));
+	}
+
+	/// \brief Links 'timer' in the slot of 'expires', not before tick 'base'.
+	void insert(ofSerialTimer & timer, uint64_t expires, uint64_t base){
+		if(timer.wheel != nullptr){
+			unlink(timer);
+		}
+		if(expires < base){
+			expires = base;
+		}
+		// beyond the last level the timer waits in its last slot, advance() puts it back
+		const uint64_t placed = expires - base > maxDelta ? base + maxDelta : expires;
+		const uint64_t delta = placed - base;
+		size_t level = 0;
+		while(level + 1 < numLevels && delta >= (uint64_t(1) << (slotBits * (level + 1)))){
+			level++;
+		}
+		const size_t index = size_t((placed >> (slotBits * level)) & slotMask);
+		const size_t slot = level * slotsPerLevel + index;
+
+		ofSerialTimer *& head = slots[slot];
+		timer.next = head;
+		if(head != nullptr){
+			head->pprev = &timer.next;
+		}
+		head = &timer;
+		timer.pprev = &head;
+		timer.wheel = this;
+		timer.expires = expires;
+		timer.slot = uint16_t(slot);
+		occupied[slot / 64] |= uint64_t(1) << (slot % 64);
+		numArmed++;
+	}
+
+	void unlink(ofSerialTimer & timer){
+		*timer.pprev = timer.next;
+		if(timer.next != nullptr){
+			timer.next->pprev = timer.pprev;
+		}
+		if(slots[timer.slot] == nullptr){
+			occupied[timer.slot / 64] &= ~(uint64_t(1) << (timer.slot % 64));
+		}
+		timer.wheel = nullptr;
+		timer.next = nullptr;
+		timer.pprev = nullptr;
+		numArmed--;
+	}
+
+	/// \brief Moves the timers of a slot of 'level' to the levels below.
+	void cascade(size_t level, size_t index);
+
+	/// \returns The index of the first non empty slot of 'level' at or after 'index', slotsPerLevel if there is none.
+	size_t findOccupied(size_t level, size_t index) const;
+
+	/// \returns A tick no later than the earliest armed timer, UINT64_MAX if none is armed.
+	uint64_t getNextExpiryTick() const;
+
+	/// \brief Sets the timerfd to fire at 'tick', UINT64_MAX disarms it.
+	void setTimerFd(uint64_t tick);
+
+	Clock::time_point origin;
+	std::chrono::nanoseconds tickDuration;
+	uint64_t tickNs;
+	uint64_t next = 1;  ///< \brief The next tick advance() processes, 0 is the origin itself.
+	uint64_t armedTick = UINT64_MAX;  ///< \brief Tick the timerfd is set for, UINT64_MAX when disarmed.
+	size_t numArmed = 0;
+	int timerFd = -1;
+	std::array<ofSerialTimer *, numLevels * slotsPerLevel> slots = {};
+	std::array<uint64_t, numLevels * slotsPerLevel / 64> occupied = {};  ///< \brief One bit per non empty slot.
+	/// \endcond
+};
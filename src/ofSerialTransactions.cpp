@@ -0,0 +1,259 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialTransactions.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+#ifndef TARGET_WIN32
+	#include <poll.h>
+	#include <cerrno>
+#endif
+
+//----------------------------------------------------------------
+ofSerialTransactions::ofSerialTransactions(ofSerial & port, ofSerialFrameDecoder & decoder, IdExtractor extractId, size_t window, size_t maxQueued)
+:port(port)
+,decoder(decoder)
+,extractId(std::move(extractId))
+,window(std::max<size_t>(window, 1))
+,maxQueued(maxQueued)
+,ownWheel(std::make_unique<ofSerialTimerWheel>())
+,wheel(ownWheel.get()){
+	inFlight.reserve(this->window);
+}
+
+//----------------------------------------------------------------
+ofSerialTransactions::~ofSerialTransactions(){
+	bClosing = true;
+	cancelAll();
+}
+
+//----------------------------------------------------------------
+ofSerialTransaction ofSerialTransactions::send(uint32_t id, std::span<const uint8_t> request, std::chrono::milliseconds timeout, CompletionCallback onComplete){
+	ofSerialTransaction transaction;
+	if(bClosing || numQueued >= maxQueued || isPending(id)){
+		return transaction;
+	}
+	auto state = std::make_shared<ofSerialTransaction::State>();
+	state->id = id;
+	state->request.assign(request.begin(), request.end());
+	state->onComplete = std::move(onComplete);
+	ofSerialTransaction::State * raw = state.get();
+	state->deadline.setCallback([this, raw](){
+		onDeadline(raw->shared_from_this());
+	});
+	wheel->armAfter(state->deadline, timeout);
+	transaction.state = state;
+	queued.push_back(std::move(state));
+	numQueued++;
+
+	// the window may have room, don't wait for the next update() to use it
+	writeQueued();
+	return transaction;
+}
+
+//----------------------------------------------------------------
+size_t ofSerialTransactions::update(int timeoutMs){
+	const size_t before = numCompleted;
+	writeQueued();
+
+	if(timeoutMs != 0){
+		// with nothing in flight only unsolicited frames can come
+		if(!inFlight.empty()){
+			const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(wheel->getNextExpiry() - std::chrono::steady_clock::now()).count();
+			const int untilDeadline = left > 0 ? int(std::min<long long>(left + 1, INT32_MAX)) : 0;
+			timeoutMs = timeoutMs < 0 ? untilDeadline : std::min(timeoutMs, untilDeadline);
+		}
+		waitReadable(timeoutMs);
+	}
+
+	port.readFrames(decoder, [this](std::span<const uint8_t> frame){
+		onFrame(frame);
+	});
+	wheel->advance();
+	writeQueued();
+	return numCompleted - before;
+}
+
+//----------------------------------------------------------------
+ofSerialTransactionStatus ofSerialTransactions::wait(const ofSerialTransaction & transaction){
+	while(!transaction.isDone()){
+		update(-1);
+	}
+	return transaction.getStatus();
+}
+
+//----------------------------------------------------------------
+size_t ofSerialTransactions::feed(const uint8_t * data, size_t length){
+	const size_t before = numCompleted;
+	decoder.feed(data, length, [this](std::span<const uint8_t> frame){
+		onFrame(frame);
+	});
+	wheel->advance();
+	writeQueued();
+	return numCompleted - before;
+}
+
+//----------------------------------------------------------------
+void ofSerialTransactions::cancelAll(){
+	// completions may send new requests, they stay queued and are cancelled too
+	const bool bWasCancelling = bCancelling;
+	bCancelling = true;
+	while(getNumPending() > 0){
+		std::vector<StatePtr> cancelled;
+		cancelled.swap(inFlight);
+		for(auto & state: queued){
+			if(state->status == ofSerialTransactionStatus::Pending){
+				cancelled.push_back(std::move(state));
+			}
+		}
+		queued.clear();
+		numQueued = 0;
+		for(auto & state: cancelled){
+			complete(state, ofSerialTransactionStatus::Cancelled);
+		}
+	}
+	bCancelling = bWasCancelling;
+}
+
+//----------------------------------------------------------------
+bool ofSerialTransactions::setTimerWheel(ofSerialTimerWheel & newWheel){
+	if(getNumPending() > 0){
+		std::cerr << "ofSerialTransactions: setTimerWheel() with pending requests" << std::endl;
+		return false;
+	}
+	wheel = &newWheel;
+	ownWheel.reset();
+	return true;
+}
+
+//----------------------------------------------------------------
+void ofSerialTransactions::setWindow(size_t newWindow){
+	window = std::max<size_t>(newWindow, 1);
+	writeQueued();
+}
+
+//----------------------------------------------------------------
+bool ofSerialTransactions::isPending(uint32_t id) const{
+	for(auto & state: inFlight){
+		if(state->id == id){
+			return true;
+		}
+	}
+	for(auto & state: queued){
+		if(state->id == id && state->status == ofSerialTransactionStatus::Pending){
+			return true;
+		}
+	}
+	return false;
+}
+
+//----------------------------------------------------------------
+size_t ofSerialTransactions::writeQueued(){
+	size_t written = 0;
+	if(bCancelling){
+		return written;
+	}
+	while(inFlight.size() < window && !queued.empty()){
+		auto state = std::move(queued.front());
+		queued.pop_front();
+		if(state->status != ofSerialTransactionStatus::Pending){
+			// timed out while queued
+			continue;
+		}
+		numQueued--;
+		// in flight before the write, a response may come back before writeBytes() returns
+		state->written = std::chrono::steady_clock::now();
+		inFlight.push_back(state);
+		if(port.writeBytes(state->request.data(), state->request.size()) != state->request.size()){
+			std::cerr << "ofSerialTransactions: could not write request " << state->id << std::endl;
+			inFlight.erase(std::find(inFlight.begin(), inFlight.end(), state));
+			complete(std::move(state), ofSerialTransactionStatus::Failed);
+			continue;
+		}
+		written++;
+	}
+	return written;
+}
+
+//----------------------------------------------------------------
+void ofSerialTransactions::onDeadline(StatePtr state){
+	auto found = std::find(inFlight.begin(), inFlight.end(), state);
+	if(found != inFlight.end()){
+		inFlight.erase(found);
+	} else {
+		// still queued, writeQueued() drops it when it comes up
+		numQueued--;
+	}
+	complete(std::move(state), ofSerialTransactionStatus::TimedOut);
+}
+
+//----------------------------------------------------------------
+size_t ofSerialTransactions::onFrame(std::span<const uint8_t> frame){
+	uint32_t id = 0;
+	if(extractId(frame, id)){
+		for(size_t i = 0; i < inFlight.size(); i++){
+			if(inFlight[i]->id == id){
+				auto state = std::move(inFlight[i]);
+				inFlight.erase(inFlight.begin() + std::ptrdiff_t(i));
+				state->response.assign(frame.begin(), frame.end());
+				complete(std::move(state), ofSerialTransactionStatus::Done);
+				return 1;
+			}
+		}
+	}
+	numUnsolicited++;
+	if(onUnsolicited){
+		onUnsolicited(frame);
+	}
+	return 0;
+}
+
+//----------------------------------------------------------------
+void ofSerialTransactions::complete(StatePtr state, ofSerialTransactionStatus status){
+	state->deadline.cancel();
+	state->status = status;
+	state->completed = std::chrono::steady_clock::now();
+	state->request.clear();
+	state->request.shrink_to_fit();
+	numCompleted++;
+	if(state->onComplete){
+		ofSerialTransaction transaction;
+		transaction.state = state;
+		// the callback may send() again, it is released once it ran
+		auto onComplete = std::move(state->onComplete);
+		onComplete(transaction);
+	}
+}
+
+//----------------------------------------------------------------
+bool ofSerialTransactions::waitReadable(int timeoutMs){
+	if(port.available() > 0){
+		return true;
+	}
+	#ifndef TARGET_WIN32
+		if(port.getFileDescriptor() == -1){
+			return false;
+		}
+		struct pollfd pfd = { port.getFileDescriptor(), POLLIN, 0 };
+		while(true){
+			const int n = ::poll(&pfd, 1, timeoutMs);
+			if(n < 0 && errno == EINTR){
+				continue;
+			}
+			return n > 0 && (pfd.revents & POLLIN) != 0;
+		}
+	#else
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+		while(port.available() == 0){
+			if(timeoutMs >= 0 && std::chrono::steady_clock::now() >= deadline){
+				return false;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return true;
+	#endif
+}
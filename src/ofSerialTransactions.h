@@ -0,0 +1,222 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include "ofSerial.h"
+#include "ofSerialFraming.h"
+#include "ofSerialTimerWheel.h"
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+/// \brief Outcome of a request, see ofSerialTransactions::send().
+enum class ofSerialTransactionStatus {
+	Pending,  ///< \brief Queued, or written and waiting for its response.
+	Done,  ///< \brief The response arrived, see ofSerialTransaction::getResponse().
+	TimedOut,  ///< \brief No response before the deadline.
+	Failed,  ///< \brief The request could not be written.
+	Cancelled,  ///< \brief cancelAll() was called, or the engine was destroyed.
+	Rejected  ///< \brief The queue was full, or the same id is already pending.
+};
+
+/// \brief Handle on a request sent with ofSerialTransactions::send().
+///
+/// Handles are cheap to copy, they all refer to the same request. A rejected
+/// request gets an empty handle whose status is ofSerialTransactionStatus::Rejected.
+class ofSerialTransaction {
+	friend class ofSerialTransactions;
+
+	public:
+		ofSerialTransactionStatus getStatus() const{
+			return state ? state->status : ofSerialTransactionStatus::Rejected;
+		}
+
+		/// \returns true once the request is no longer pending.
+		bool isDone() const{
+			return getStatus() != ofSerialTransactionStatus::Pending;
+		}
+
+		/// \returns The correlation id given to send().
+		uint32_t getId() const{
+			return state ? state->id : 0;
+		}
+
+		/// \returns The response frame, empty until the request is done.
+		std::span<const uint8_t> getResponse() const{
+			return state ? std::span<const uint8_t>(state->response) : std::span<const uint8_t>();
+		}
+
+		/// \returns The time between writing the request and receiving its response.
+		std::chrono::microseconds getRoundTrip() const{
+			return state && state->status == ofSerialTransactionStatus::Done ? std::chrono::duration_cast<std::chrono::microseconds>(state->completed - state->written) : std::chrono::microseconds(0);
+		}
+
+	protected:
+		/// \cond INTERNAL
+		struct State: std::enable_shared_from_this<State> {
+			uint32_t id = 0;
+			ofSerialTransactionStatus status = ofSerialTransactionStatus::Pending;
+			std::vector<uint8_t> request;
+			std::vector<uint8_t> response;
+			ofSerialTimer deadline;
+			std::chrono::steady_clock::time_point written;
+			std::chrono::steady_clock::time_point completed;
+			std::function<void(const ofSerialTransaction & transaction)> onComplete;
+		};
+
+		std::shared_ptr<State> state;
+		/// \endcond
+};
+
+/// \brief Keeps a window of requests in flight on a port and matches the responses.
+///
+/// Sending a command then waiting for its reply leaves the link idle for a
+/// whole round trip, which is several milliseconds on USB adapters. Here up
+/// to 'window' requests are written before the first response comes back,
+/// the responses are decoded with an ofSerialFrameDecoder and matched to
+/// their request by the correlation id 'extractId' finds in them, in any
+/// order.
+///
+/// ~~~~{.cpp}
+/// ofSerialLengthPrefixDecoder decoder;
+/// ofSerialTransactions transactions(serial, decoder, [](std::span<const uint8_t> frame, uint32_t & id){
+///	 if(frame.size() < 1) return false;
+///	 id = frame[0];
+///	 return true;
+/// }, 8);
+/// for(uint8_t i = 0; i < 100; i++){
+///	 transactions.send(i, encodeCommand(i), std::chrono::milliseconds(200), [](const ofSerialTransaction & t){
+///		 // t.getStatus(), t.getResponse()
+///	 });
+/// }
+/// while(transactions.getNumPending() > 0){
+///	 transactions.update(10);
+/// }
+/// ~~~~
+///
+/// The engine is driven by update(), from one thread, like ofSerialReactor:
+/// requests are written, responses matched, deadlines enforced and callbacks
+/// run from there. The bytes can also be read by someone else, a reactor
+/// callback for instance, and handed over with feed(). The port and the
+/// decoder must outlive the engine.
+///
+/// Each deadline is a timer on an ofSerialTimerWheel, owned by the engine or
+/// shared with the loop driving it, see setTimerWheel().
+class ofSerialTransactions {
+
+public:
+	/// \brief Finds the correlation id of a response.
+	/// \returns false if the frame is not a response, it is then passed to the unsolicited callback.
+	using IdExtractor = std::function<bool(std::span<const uint8_t> frame, uint32_t & id)>;
+
+	/// \brief Called when a request is done, whatever the outcome.
+	using CompletionCallback = std::function<void(const ofSerialTransaction & transaction)>;
+
+	/// \brief Called with the frames that match no pending request.
+	using FrameCallback = std::function<void(std::span<const uint8_t> frame)>;
+
+	/// \param window Maximum number of requests written and waiting for their response.
+	/// \param maxQueued Maximum number of requests waiting for a slot in the window.
+	ofSerialTransactions(ofSerial & port, ofSerialFrameDecoder & decoder, IdExtractor extractId, size_t window = 8, size_t maxQueued = 1024);
+
+	/// \brief Cancels the pending requests, send() from their completions is rejected.
+	~ofSerialTransactions();
+
+	ofSerialTransactions(const ofSerialTransactions &) = delete;
+	ofSerialTransactions & operator=(const ofSerialTransactions &) = delete;
+
+	/// \brief Queues a request, it is written as soon as the window has room.
+	///
+	/// 'request' is sent as is, it must already be framed for the device.
+	/// The timeout runs from now, time spent queued included.
+	/// \returns A handle on the request, rejected if the queue is full, 'id' is already pending or the engine is being destroyed.
+	ofSerialTransaction send(uint32_t id, std::span<const uint8_t> request, std::chrono::milliseconds timeout, CompletionCallback onComplete = nullptr);
+
+	/// \brief Writes queued requests, reads and matches responses, and expires deadlines.
+	///
+	/// Waits up to 'timeoutMs' for the port to become readable, but never
+	/// past the earliest deadline. 0 does not wait.
+	/// \returns The number of requests completed by this call, whatever their status.
+	size_t update(int timeoutMs = 0);
+
+	/// \brief Calls update() until 'transaction' is done.
+	/// \returns The final status.
+	ofSerialTransactionStatus wait(const ofSerialTransaction & transaction);
+
+	/// \brief Hands bytes read elsewhere to the decoder and matches the responses.
+	/// \returns The number of requests completed.
+	size_t feed(const uint8_t * data, size_t length);
+
+	/// \brief Completes every pending request with ofSerialTransactionStatus::Cancelled.
+	///
+	/// Requests sent by the completions are cancelled too, before being written.
+	void cancelAll();
+
+	/// \brief Arms the deadlines on 'wheel', ofSerialReactor::getTimerWheel() for instance.
+	///
+	/// The wheel must outlive the engine and be advanced from the same thread,
+	/// update() and feed() advance it too. Only while no request is pending.
+	/// \returns false if requests are pending.
+	bool setTimerWheel(ofSerialTimerWheel & wheel);
+
+	/// \brief Changes the size of the window, requests already written stay in flight.
+	void setWindow(size_t window);
+
+	size_t getWindow() const{
+		return window;
+	}
+
+	/// \brief Receives the frames that match no pending request: late responses, notifications.
+	void setUnsolicitedCallback(FrameCallback onUnsolicited){
+		this->onUnsolicited = std::move(onUnsolicited);
+	}
+
+	/// \returns The number of requests written and waiting for their response.
+	size_t getNumInFlight() const{
+		return inFlight.size();
+	}
+
+	/// \returns The number of requests not done yet, in flight or queued.
+	size_t getNumPending() const{
+		return inFlight.size() + numQueued;
+	}
+
+	/// \returns The number of frames that matched no pending request.
+	size_t getNumUnsolicited() const{
+		return numUnsolicited;
+	}
+
+protected:
+	/// \cond INTERNAL
+	using StatePtr = std::shared_ptr<ofSerialTransaction::State>;
+
+	bool isPending(uint32_t id) const;
+	size_t writeQueued();
+	void onDeadline(StatePtr state);
+	size_t onFrame(std::span<const uint8_t> frame);
+	void complete(StatePtr state, ofSerialTransactionStatus status);
+	bool waitReadable(int timeoutMs);
+
+	ofSerial & port;
+	ofSerialFrameDecoder & decoder;
+	IdExtractor extractId;
+	FrameCallback onUnsolicited;
+	size_t window;
+	size_t maxQueued;
+	size_t numUnsolicited = 0;
+	size_t numCompleted = 0;  ///< \brief Counted by complete(), feed() and update() return the difference.
+	size_t numQueued = 0;  ///< \brief Pending requests in 'queued'.
+	std::unique_ptr<ofSerialTimerWheel> ownWheel;
+	ofSerialTimerWheel * wheel;
+	std::vector<StatePtr> inFlight;  ///< \brief Written requests, a small window searched linearly.
+	std::deque<StatePtr> queued;  ///< \brief Requests waiting for a slot, in send() order, those that timed out there are skipped.
+	bool bClosing = false;  ///< \brief Set by the destructor, send() rejects.
+	bool bCancelling = false;  ///< \brief Set by cancelAll(), writeQueued() writes nothing.
+	/// \endcond
+};
@@ -0,0 +1,217 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialTransport.h"
+
+#include <iostream>
+
+#ifndef TARGET_WIN32
+	#include <fcntl.h>
+	#include <poll.h>
+	#include <sys/ioctl.h>
+	#include <sys/socket.h>
+	#include <unistd.h>
+	#include <cerrno>
+	#include <cstring>
+#endif
+
+#if defined( TARGET_LINUX )
+	#include <pty.h>
+#elif defined( TARGET_OSX )
+	#include <util.h>
+#endif
+
+#ifndef TARGET_WIN32
+//----------------------------------------------------------------
+static bool pollFd(int fd, short events, int timeoutMs){
+	struct pollfd pfd = { fd, events, 0 };
+	while(true){
+		const int n = ::poll(&pfd, 1, timeoutMs);
+		if(n < 0 && errno == EINTR){
+			continue;
+		}
+		return n > 0 && (pfd.revents & events) != 0;
+	}
+}
+
+//----------------------------------------------------------------
+// Hung up with nothing left to read, e.g. the master of a pty was closed.
+static bool pollHungUp(int fd){
+	struct pollfd pfd = { fd, POLLIN, 0 };
+	while(true){
+		const int n = ::poll(&pfd, 1, 0);
+		if(n < 0 && errno == EINTR){
+			continue;
+		}
+		return n > 0 && (pfd.revents & (POLLHUP | POLLERR)) != 0 && (pfd.revents & POLLIN) == 0;
+	}
+}
+
+//----------------------------------------------------------------
+static bool setNonBlocking(int fd){
+	const int flags = fcntl(fd, F_GETFL);
+	return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0 && fcntl(fd, F_SETFD, FD_CLOEXEC) == 0;
+}
+#endif
+
+//----------------------------------------------------------------
+bool ofSerialTtyTransport::waitReadable(int timeoutMs){
+	if(serial.available() > 0){
+		return true;
+	}
+	#ifndef TARGET_WIN32
+		return serial.getFileDescriptor() != -1 && pollFd(serial.getFileDescriptor(), POLLIN, timeoutMs);
+	#else
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+		while(serial.available() == 0){
+			if(timeoutMs >= 0 && std::chrono::steady_clock::now() >= deadline){
+				return false;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return true;
+	#endif
+}
+
+//----------------------------------------------------------------
+bool ofSerialTtyTransport::isHungUp(){
+	#ifndef TARGET_WIN32
+		return serial.getFileDescriptor() != -1 && serial.available() == 0 && pollHungUp(serial.getFileDescriptor());
+	#else
+		return false;
+	#endif
+}
+
+//----------------------------------------------------------------
+bool ofSerialTtyTransport::waitWritable(int timeoutMs){
+	#ifndef TARGET_WIN32
+		return serial.getFileDescriptor() != -1 && pollFd(serial.getFileDescriptor(), POLLOUT, timeoutMs);
+	#else
+		// writeBytes() waits for the device itself
+		(void)timeoutMs;
+		return serial.isInitialized();
+	#endif
+}
+
+#ifndef TARGET_WIN32
+//----------------------------------------------------------------
+ofSerialFdTransport::~ofSerialFdTransport(){
+	close();
+}
+
+//----------------------------------------------------------------
+size_t ofSerialFdTransport::read(uint8_t * buffer, size_t length){
+	const auto n = ::read(fd, buffer, length);
+	if(n < 0){
+		if(errno == EIO){
+			// a pty whose master was closed
+			bHungUp = true;
+		} else if(errno != EAGAIN && errno != EINTR){
+			std::cerr << "ofSerialFdTransport: read error: " << strerror(errno) << std::endl;
+		}
+		return 0;
+	}
+	if(n == 0 && length > 0){
+		bHungUp = true;
+	}
+	return size_t(n);
+}
+
+//----------------------------------------------------------------
+size_t ofSerialFdTransport::write(const uint8_t * buffer, size_t length){
+	const auto n = ::write(fd, buffer, length);
+	if(n < 0){
+		if(errno != EAGAIN && errno != EINTR){
+			std::cerr << "ofSerialFdTransport: write error: " << strerror(errno) << std::endl;
+		}
+		return 0;
+	}
+	return size_t(n);
+}
+
+//----------------------------------------------------------------
+size_t ofSerialFdTransport::available(){
+	int queued = 0;
+	if(fd == -1 || ioctl(fd, FIONREAD, &queued) != 0 || queued < 0){
+		return 0;
+	}
+	return size_t(queued);
+}
+
+//----------------------------------------------------------------
+bool ofSerialFdTransport::waitReadable(int timeoutMs){
+	return fd != -1 && !bHungUp && pollFd(fd, POLLIN, timeoutMs);
+}
+
+//----------------------------------------------------------------
+bool ofSerialFdTransport::waitWritable(int timeoutMs){
+	return fd != -1 && pollFd(fd, POLLOUT, timeoutMs);
+}
+
+//----------------------------------------------------------------
+bool ofSerialFdTransport::isHungUp(){
+	return fd != -1 && (bHungUp || pollHungUp(fd));
+}
+
+//----------------------------------------------------------------
+void ofSerialFdTransport::close(){
+	for(int * end: { &fd, &peerFd }){
+		if(*end != -1){
+			::close(*end);
+			*end = -1;
+		}
+	}
+	bHungUp = false;
+}
+
+//----------------------------------------------------------------
+bool ofSerialPtyTransport::setup(){
+	close();
+	int master = -1;
+	int slave = -1;
+	if(openpty(&master, &slave, nullptr, nullptr, nullptr) != 0){
+		std::cerr << "ofSerialPtyTransport: openpty failed: " << strerror(errno) << std::endl;
+		return false;
+	}
+	// raw, like ofSerial::setup() leaves a real device
+	struct termios options;
+	tcgetattr(slave, &options);
+	cfmakeraw(&options);
+	tcsetattr(slave, TCSANOW, &options);
+	if(!setNonBlocking(master) || !setNonBlocking(slave)){
+		std::cerr << "ofSerialPtyTransport: can't set O_NONBLOCK: " << strerror(errno) << std::endl;
+		::close(master);
+		::close(slave);
+		return false;
+	}
+	fd = slave;
+	peerFd = master;
+	return true;
+}
+
+//----------------------------------------------------------------
+bool ofSerialSocketpairTransport::setup(int bufferSize){
+	close();
+	int ends[2];
+	if(socketpair(AF_UNIX, SOCK_STREAM, 0, ends) != 0){
+		std::cerr << "ofSerialSocketpairTransport: socketpair failed: " << strerror(errno) << std::endl;
+		return false;
+	}
+	for(int end: ends){
+		if(bufferSize > 0){
+			setsockopt(end, SOL_SOCKET, SO_SNDBUF, &bufferSize, sizeof(bufferSize));
+			setsockopt(end, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+		}
+		if(!setNonBlocking(end)){
+			std::cerr << "ofSerialSocketpairTransport: can't set O_NONBLOCK: " << strerror(errno) << std::endl;
+			::close(ends[0]);
+			::close(ends[1]);
+			return false;
+		}
+	}
+	fd = ends[0];
+	peerFd = ends[1];
+	return true;
+}
+#endif // TARGET_WIN32
@@ -0,0 +1,439 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include "ofSerial.h"
+#include "ofSerialFraming.h"
+#include "ofSerialRingBuffer.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <span>
+#include <thread>
+#include <utility>
+
+/// \name Transports
+///
+/// A transport moves bytes to and from something that behaves like a serial
+/// device. ofSerialPort takes one as a template parameter, so the calls are
+/// resolved at compile time and inlined, there is no virtual dispatch. A
+/// transport provides:
+///
+/// ~~~~{.cpp}
+/// bool isOpen() const;
+/// size_t read(uint8_t * buffer, size_t length);         // never blocks, 0 if nothing came
+/// size_t write(const uint8_t * buffer, size_t length);  // never blocks, returns what was taken
+/// size_t available();
+/// bool waitReadable(int timeoutMs);   // true if read() has something
+/// bool waitWritable(int timeoutMs);   // true if write() can take something
+/// bool isHungUp();                    // the other end went away and everything it sent was read
+/// void close();
+/// ~~~~
+///
+/// - ofSerialTtyTransport: a real device through ofSerial.
+/// - ofSerialPtyTransport: a pseudo terminal, the test plays the device on the master side (Linux).
+/// - ofSerialSocketpairTransport: a unix socket pair, the cheapest kernel path (POSIX).
+/// - ofSerialLoopbackTransport: two in-memory rings, no syscall at all.
+/// \{
+
+/// \brief A device opened with ofSerial, with all its settings and features.
+class ofSerialTtyTransport {
+
+public:
+	ofSerialTtyTransport() = default;
+
+	/// \brief Opens the device, same arguments as ofSerial::setup().
+	template<class... Args>
+	bool setup(Args&&... args){
+		return serial.setup(std::forward<Args>(args)...);
+	}
+
+	bool isOpen() const{
+		return serial.isInitialized();
+	}
+
+	size_t read(uint8_t * buffer, size_t length){
+		return serial.readBytes(buffer, length);
+	}
+
+	size_t write(const uint8_t * buffer, size_t length){
+		#ifndef TARGET_WIN32
+			return serial.writeSome(buffer, length);
+		#else
+			return serial.writeBytes(buffer, length);
+		#endif
+	}
+
+	size_t available(){
+		return serial.available();
+	}
+
+	bool waitReadable(int timeoutMs);
+	bool waitWritable(int timeoutMs);
+	bool isHungUp();
+
+	void close(){
+		serial.close();
+	}
+
+	/// \returns the port, for everything the transport interface does not cover.
+	ofSerial & getSerial(){
+		return serial;
+	}
+
+protected:
+	/// \cond INTERNAL
+	ofSerial serial;
+	/// \endcond
+};
+
+#ifndef TARGET_WIN32
+
+/// \brief Non blocking file descriptor, the base of the pty and socketpair transports.
+class ofSerialFdTransport {
+
+public:
+	ofSerialFdTransport() = default;
+	~ofSerialFdTransport();
+
+	ofSerialFdTransport(const ofSerialFdTransport &) = delete;
+	ofSerialFdTransport & operator=(const ofSerialFdTransport &) = delete;
+
+	bool isOpen() const{
+		return fd != -1;
+	}
+
+	size_t read(uint8_t * buffer, size_t length);
+	size_t write(const uint8_t * buffer, size_t length);
+	size_t available();
+	bool waitReadable(int timeoutMs);
+	bool waitWritable(int timeoutMs);
+	bool isHungUp();
+	void close();
+
+	int getFileDescriptor() const{
+		return fd;
+	}
+
+	/// \returns the other end, where a test or a fake device reads and writes.
+	int getPeerFileDescriptor() const{
+		return peerFd;
+	}
+
+protected:
+	/// \cond INTERNAL
+	int fd = -1;
+	int peerFd = -1;
+	bool bHungUp = false;  ///< \brief read() met the end of the stream.
+	/// \endcond
+};
+
+/// \brief The slave side of a raw mode pseudo terminal.
+///
+/// The bytes go through the tty layer like with a USB adapter, without the
+/// wire. The master side is the peer.
+class ofSerialPtyTransport: public ofSerialFdTransport {
+
+public:
+	/// \brief Opens a new pseudo terminal pair.
+	bool setup();
+};
+
+/// \brief One end of a unix stream socket pair, the peer is the other end.
+class ofSerialSocketpairTransport: public ofSerialFdTransport {
+
+public:
+	/// \brief Creates the pair.
+	/// \param bufferSize Socket buffer size in bytes, 0 keeps the system default.
+	bool setup(int bufferSize = 0);
+};
+
+#endif // TARGET_WIN32
+
+/// \brief Two byte rings joining two ofSerialLoopbackTransport in memory.
+///
+/// ~~~~{.cpp}
+/// ofSerialLoopback loopback;
+/// ofSerialPort<ofSerialLoopbackTransport> host(loopback, ofSerialLoopback::Host);
+/// ofSerialPort<ofSerialLoopbackTransport> device(loopback, ofSerialLoopback::Device);
+/// host.writeBytes(request, length);  // device.readBytes() gets it
+/// ~~~~
+///
+/// Each direction is a lock-free single producer, single consumer ring: one
+/// thread per side. Closing a side hangs up the other one, like unplugging a
+/// cable: it reads what was already sent, then isHungUp() and its writes
+/// fail. It must outlive both transports.
+class ofSerialLoopback {
+
+public:
+	enum Side {
+		Host,
+		Device
+	};
+
+	/// \param capacity Bytes each direction can hold.
+	explicit ofSerialLoopback(size_t capacity = 1 << 20)
+	:hostToDevice(capacity)
+	,deviceToHost(capacity){
+	}
+
+	/// \cond INTERNAL
+	ofSerialRingBuffer hostToDevice;
+	ofSerialRingBuffer deviceToHost;
+	std::atomic<bool> bClosed[2] = { false, false };  ///< \brief Per Side, set by close().
+	/// \endcond
+};
+
+/// \brief One side of an ofSerialLoopback.
+///
+/// Waiting spins on the ring with std::this_thread::yield(), nothing sleeps
+/// in the kernel: the loopback is meant to run benchmarks at memory speed.
+class ofSerialLoopbackTransport {
+
+public:
+	ofSerialLoopbackTransport(ofSerialLoopback & loopback, ofSerialLoopback::Side side)
+	:rx(side == ofSerialLoopback::Host ? loopback.deviceToHost : loopback.hostToDevice)
+	,tx(side == ofSerialLoopback::Host ? loopback.hostToDevice : loopback.deviceToHost)
+	,bClosed(loopback.bClosed[side])
+	,bPeerClosed(loopback.bClosed[side == ofSerialLoopback::Host ? ofSerialLoopback::Device : ofSerialLoopback::Host]){
+		bClosed.store(false, std::memory_order_release);
+	}
+
+	bool isOpen() const{
+		return bOpen;
+	}
+
+	size_t read(uint8_t * buffer, size_t length){
+		return rx.read(buffer, length);
+	}
+
+	size_t write(const uint8_t * buffer, size_t length){
+		return bPeerClosed.load(std::memory_order_acquire) ? 0 : tx.write(buffer, length);
+	}
+
+	size_t available(){
+		return rx.size();
+	}
+
+	bool waitReadable(int timeoutMs){
+		spinUntil(timeoutMs, [this]{ return !rx.empty() || bPeerClosed.load(std::memory_order_acquire); });
+		return !rx.empty();
+	}
+
+	bool waitWritable(int timeoutMs){
+		spinUntil(timeoutMs, [this]{ return tx.freeSpace() > 0 || bPeerClosed.load(std::memory_order_acquire); });
+		return tx.freeSpace() > 0 && !bPeerClosed.load(std::memory_order_acquire);
+	}
+
+	bool isHungUp(){
+		// the bytes written before close() come first
+		return bPeerClosed.load(std::memory_order_acquire) && rx.empty();
+	}
+
+	void close(){
+		bOpen = false;
+		bClosed.store(true, std::memory_order_release);
+	}
+
+	/// \brief Hands the received bytes in place to 'onData', without copying them.
+	/// \returns The number of bytes consumed.
+	template<class Callback>
+	size_t readInPlace(Callback && onData){
+		size_t total = 0;
+		for(int i = 0; i < 2; i++){
+			auto region = rx.readableRegion();
+			if(region.empty()){
+				break;
+			}
+			onData(region.data(), region.size());
+			rx.commitRead(region.size());
+			total += region.size();
+		}
+		return total;
+	}
+
+protected:
+	/// \cond INTERNAL
+	template<class Ready>
+	static bool spinUntil(int timeoutMs, Ready && ready){
+		if(ready()){
+			return true;
+		}
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+		while(!ready()){
+			if(timeoutMs >= 0 && std::chrono::steady_clock::now() >= deadline){
+				return false;
+			}
+			std::this_thread::yield();
+		}
+		return true;
+	}
+
+	ofSerialRingBuffer & rx;
+	ofSerialRingBuffer & tx;
+	std::atomic<bool> & bClosed;
+	std::atomic<bool> & bPeerClosed;
+	bool bOpen = true;
+	/// \endcond
+};
+
+/// \}
+
+/// \brief The hot path of ofSerial on any transport, chosen at compile time.
+///
+/// ~~~~{.cpp}
+/// ofSerialPort<ofSerialTtyTransport> port;
+/// port.getTransport().setup("/dev/ttyUSB0", 115200);
+///
+/// ofSerialPort<ofSerialPtyTransport> fake;
+/// fake.getTransport().setup();
+/// ~~~~
+///
+/// Protocol code written as a template over the port type runs unchanged on
+/// hardware, on a pty, on a socket pair or on the in-memory loopback.
+template<class Transport>
+class ofSerialPort {
+
+public:
+	/// \brief Constructs the transport with 'args'.
+	template<class... Args>
+	explicit ofSerialPort(Args&&... args)
+	:transport(std::forward<Args>(args)...){
+	}
+
+	Transport & getTransport(){
+		return transport;
+	}
+
+	bool isInitialized() const{
+		return transport.isOpen();
+	}
+
+	size_t available(){
+		return transport.available();
+	}
+
+	/// \brief Reads what is there, up to 'length' bytes, without waiting.
+	size_t readBytes(uint8_t * buffer, size_t length){
+		return transport.read(buffer, length);
+	}
+
+	size_t readInto(std::span<uint8_t> buffer){
+		return transport.read(buffer.data(), buffer.size());
+	}
+
+	/// \returns the next byte, or OF_SERIAL_NO_DATA.
+	int readByte(){
+		uint8_t byte;
+		return transport.read(&byte, 1) == 1 ? byte : OF_SERIAL_NO_DATA;
+	}
+
+	/// \brief Waits until 'length' bytes are read, or the deadline.
+	///
+	/// Like ofSerial::readExactly(), on any other status than Done bytesRead
+	/// tells how much of 'buffer' was filled: Closed after close(),
+	/// Disconnected once the other end hung up and what it sent was read.
+	ofSerialReadResult readExactly(uint8_t * buffer, size_t length, std::chrono::steady_clock::time_point deadline){
+		ofSerialReadResult result;
+		while(result.bytesRead < length){
+			if(!transport.isOpen()){
+				result.status = ofSerialReadStatus::Closed;
+				return result;
+			}
+			const size_t n = transport.read(buffer + result.bytesRead, length - result.bytesRead);
+			result.bytesRead += n;
+			if(n > 0){
+				continue;
+			}
+			if(transport.isHungUp()){
+				result.status = ofSerialReadStatus::Disconnected;
+				return result;
+			}
+			if(std::chrono::steady_clock::now() >= deadline){
+				result.status = ofSerialReadStatus::Timeout;
+				return result;
+			}
+			transport.waitReadable(remainingMs(deadline));
+		}
+		return result;
+	}
+	ofSerialReadResult readExactly(std::span<uint8_t> buffer, std::chrono::steady_clock::time_point deadline){
+		return readExactly(buffer.data(), buffer.size(), deadline);
+	}
+	ofSerialReadResult readExactly(std::span<uint8_t> buffer, std::chrono::milliseconds timeout){
+		return readExactly(buffer.data(), buffer.size(), std::chrono::steady_clock::now() + timeout);
+	}
+
+	/// \brief Writes everything, waiting up to 'timeoutMs' each time the transport is full.
+	/// \returns The number of bytes written.
+	size_t writeBytes(const uint8_t * buffer, size_t length, int timeoutMs = 1000){
+		size_t done = 0;
+		while(done < length){
+			const size_t n = transport.write(buffer + done, length - done);
+			done += n;
+			if(n == 0 && !transport.waitWritable(timeoutMs)){
+				break;
+			}
+		}
+		return done;
+	}
+
+	size_t writeBytes(std::span<const uint8_t> buffer, int timeoutMs = 1000){
+		return writeBytes(buffer.data(), buffer.size(), timeoutMs);
+	}
+
+	/// \brief Reads what is there and feeds it to a frame decoder.
+	/// \returns The number of frames passed to onFrame.
+	size_t readFrames(ofSerialFrameDecoder & decoder, const ofSerialFrameDecoder::FrameCallback & onFrame){
+		if constexpr(requires { transport.readInPlace([](const uint8_t *, size_t){}); }){
+			size_t nFrames = 0;
+			transport.readInPlace([&](const uint8_t * data, size_t length){
+				nFrames += decoder.feed(data, length, onFrame);
+			});
+			return nFrames;
+		} else {
+			if(!readBuffer){
+				readBuffer = std::make_unique<uint8_t[]>(readBufferSize);
+			}
+			size_t nFrames = 0;
+			while(true){
+				const size_t n = transport.read(readBuffer.get(), readBufferSize);
+				nFrames += decoder.feed(readBuffer.get(), n, onFrame);
+				if(n < readBufferSize){
+					break;
+				}
+			}
+			return nFrames;
+		}
+	}
+
+	bool waitReadable(int timeoutMs){
+		return transport.waitReadable(timeoutMs);
+	}
+
+	/// \returns true once the other end went away and everything it sent was read.
+	bool isHungUp(){
+		return transport.isHungUp();
+	}
+
+	void close(){
+		transport.close();
+	}
+
+protected:
+	/// \cond INTERNAL
+	static int remainingMs(std::chrono::steady_clock::time_point deadline){
+		const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+		return left > 0 ? int(left) : 0;
+	}
+
+	static constexpr size_t readBufferSize = 16384;
+
+	Transport transport;
+	std::unique_ptr<uint8_t[]> readBuffer;
+	/// \endcond
+};
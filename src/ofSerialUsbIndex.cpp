@@ -0,0 +1,252 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#include "ofSerialUsbIndex.h"
+
+#ifdef TARGET_LINUX
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+
+//----------------------------------------------------------------
+// Reads a sysfs attribute without its trailing newline.
+static bool readAttribute(const std::string & path, std::string & value){
+	const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if(fd == -1){
+		return false;
+	}
+	char buffer[256];
+	const auto n = read(fd, buffer, sizeof(buffer));
+	::close(fd);
+	if(n < 0){
+		return false;
+	}
+	size_t length = size_t(n);
+	while(length > 0 && (buffer[length - 1] == '\n' || buffer[length - 1] == '\0')){
+		length--;
+	}
+	value.assign(buffer, length);
+	return true;
+}
+
+//----------------------------------------------------------------
+static bool readHexAttribute(const std::string & path, unsigned long & value){
+	std::string text;
+	if(!readAttribute(path, text) || text.empty()){
+		return false;
+	}
+	char * end = nullptr;
+	value = strtoul(text.c_str(), &end, 16);
+	return end != text.c_str();
+}
+
+//----------------------------------------------------------------
+static bool fileExists(const std::string & path){
+	return access(path.c_str(), F_OK) == 0;
+}
+
+//----------------------------------------------------------------
+ofSerialUsbIndex::ofSerialUsbIndex(std::string_view sysfsRoot, std::string_view devRoot)
+:sysfsRoot(sysfsRoot)
+,devRoot(devRoot){
+	rebuild();
+}
+
+//----------------------------------------------------------------
+std::string_view ofSerialUsbIndex::getBaseName(std::string_view path){
+	const auto slash = path.find_last_of('/');
+	return slash == std::string_view::npos ? path : path.substr(slash + 1);
+}
+
+//----------------------------------------------------------------
+size_t ofSerialUsbIndex::rebuild(){
+	struct Record {
+		uint16_t vendorId;
+		uint16_t productId;
+		uint8_t interfaceNumber;
+		std::string ttyName;
+		std::string serialNumber;
+		std::string manufacturer;
+		std::string product;
+		std::string byIdLink;
+	};
+	std::vector<Record> records;
+
+	devices.clear();
+	byIdentity.clear();
+	byProduct.clear();
+	byIdLink.clear();
+	byName.clear();
+	strings.clear();
+
+	const std::string classDir = sysfsRoot + "/class/tty";
+	DIR * dir = opendir(classDir.c_str());
+	if(dir == nullptr){
+		std::cerr << "ofSerialUsbIndex: can't list " << classDir << std::endl;
+		return 0;
+	}
+	while(struct dirent * entry = readdir(dir)){
+		if(entry->d_name[0] == '.'){
+			continue;
+		}
+		char resolved[PATH_MAX];
+		const std::string link = classDir + "/" + entry->d_name + "/device";
+		if(realpath(link.c_str(), resolved) == nullptr){
+			// virtual terminals have no device
+			continue;
+		}
+
+		// ttyACM points at the USB interface, ttyUSB at a port below it:
+		// walk up to the interface, then to the USB device holding the ids
+		std::string path(resolved);
+		Record record{};
+		bool bInterface = false;
+		bool bDevice = false;
+		for(int depth = 0; depth < 4 && !bDevice && path.size() > 1; depth++){
+			unsigned long value = 0;
+			if(!bInterface && readHexAttribute(path + "/bInterfaceNumber", value)){
+				record.interfaceNumber = uint8_t(value);
+				bInterface = true;
+			}
+			if(fileExists(path + "/idVendor")){
+				bDevice = true;
+				break;
+			}
+			path.resize(path.find_last_of('/'));
+		}
+		if(!bDevice){
+			// a platform or PCI port
+			continue;
+		}
+
+		unsigned long vendorId = 0;
+		unsigned long productId = 0;
+		if(!readHexAttribute(path + "/idVendor", vendorId) || !readHexAttribute(path + "/idProduct", productId)){
+			continue;
+		}
+		record.vendorId = uint16_t(vendorId);
+		record.productId = uint16_t(productId);
+		record.ttyName = entry->d_name;
+		readAttribute(path + "/serial", record.serialNumber);
+		readAttribute(path + "/manufacturer", record.manufacturer);
+		readAttribute(path + "/product", record.product);
+		records.push_back(std::move(record));
+	}
+	closedir(dir);
+
+	const std::string byIdDir = devRoot + "/serial/by-id";
+	dir = opendir(byIdDir.c_str());
+	if(dir != nullptr){
+		while(struct dirent * entry = readdir(dir)){
+			if(entry->d_name[0] == '.'){
+				continue;
+			}
+			char target[PATH_MAX];
+			const std::string link = byIdDir + "/" + entry->d_name;
+			const auto n = readlink(link.c_str(), target, sizeof(target) - 1);
+			if(n <= 0){
+				continue;
+			}
+			const std::string_view ttyName = getBaseName(std::string_view(target, size_t(n)));
+			for(auto & record: records){
+				if(record.ttyName == ttyName){
+					record.byIdLink = entry->d_name;
+					break;
+				}
+			}
+		}
+		closedir(dir);
+	}
+
+	std::sort(records.begin(), records.end(), [](const Record & a, const Record & b){
+		return a.ttyName < b.ttyName;
+	});
+
+	// the views below point into 'strings', it must not grow past its reservation
+	size_t total = 0;
+	for(auto & record: records){
+		total += record.ttyName.size() * 2 + devRoot.size() + 1 + record.serialNumber.size() + record.manufacturer.size() + record.product.size();
+		if(!record.byIdLink.empty()){
+			total += byIdDir.size() + 1 + record.byIdLink.size();
+		}
+	}
+	strings.reserve(total);
+	auto intern = [this](std::initializer_list<std::string_view> parts){
+		const size_t begin = strings.size();
+		for(auto part: parts){
+			strings.append(part);
+		}
+		return std::string_view(strings.data() + begin, strings.size() - begin);
+	};
+
+	devices.reserve(records.size());
+	for(auto & record: records){
+		ofSerialUsbDevice device;
+		device.vendorId = record.vendorId;
+		device.productId = record.productId;
+		device.interfaceNumber = record.interfaceNumber;
+		device.ttyName = intern({ record.ttyName });
+		device.devicePath = intern({ devRoot, "/", record.ttyName });
+		device.serialNumber = intern({ record.serialNumber });
+		device.manufacturer = intern({ record.manufacturer });
+		device.product = intern({ record.product });
+		if(!record.byIdLink.empty()){
+			device.byIdPath = intern({ byIdDir, "/", record.byIdLink });
+		}
+		devices.push_back(device);
+	}
+
+	for(uint32_t i = 0; i < uint32_t(devices.size()); i++){
+		const auto & device = devices[i];
+		const uint32_t product = uint32_t(device.vendorId) << 16 | device.productId;
+		byIdentity.emplace(Key{ product, device.serialNumber, device.interfaceNumber }, i);
+		auto first = byIdentity.emplace(Key{ product, device.serialNumber, -1 }, i);
+		if(!first.second && devices[first.first->second].interfaceNumber > device.interfaceNumber){
+			first.first->second = i;
+		}
+		byProduct.emplace(product, i);
+		byName.emplace(device.ttyName, i);
+		if(!device.byIdPath.empty()){
+			byIdLink.emplace(getBaseName(device.byIdPath), i);
+		}
+	}
+	return devices.size();
+}
+
+//----------------------------------------------------------------
+const ofSerialUsbDevice * ofSerialUsbIndex::find(uint16_t vendorId, uint16_t productId, std::string_view serialNumber) const{
+	auto found = byIdentity.find(Key{ uint32_t(vendorId) << 16 | productId, serialNumber, -1 });
+	return found == byIdentity.end() ? nullptr : &devices[found->second];
+}
+
+//----------------------------------------------------------------
+const ofSerialUsbDevice * ofSerialUsbIndex::find(uint16_t vendorId, uint16_t productId) const{
+	auto found = byProduct.find(uint32_t(vendorId) << 16 | productId);
+	return found == byProduct.end() ? nullptr : &devices[found->second];
+}
+
+//----------------------------------------------------------------
+const ofSerialUsbDevice * ofSerialUsbIndex::findInterface(uint16_t vendorId, uint16_t productId, std::string_view serialNumber, uint8_t interfaceNumber) const{
+	auto found = byIdentity.find(Key{ uint32_t(vendorId) << 16 | productId, serialNumber, int(interfaceNumber) });
+	return found == byIdentity.end() ? nullptr : &devices[found->second];
+}
+
+//----------------------------------------------------------------
+const ofSerialUsbDevice * ofSerialUsbIndex::findByIdPath(std::string_view path) const{
+	auto found = byIdLink.find(getBaseName(path));
+	return found == byIdLink.end() ? nullptr : &devices[found->second];
+}
+
+//----------------------------------------------------------------
+const ofSerialUsbDevice * ofSerialUsbIndex::findByName(std::string_view nameOrPath) const{
+	auto found = byName.find(getBaseName(nameOrPath));
+	return found == byName.end() ? nullptr : &devices[found->second];
+}
+
+#endif // TARGET_LINUX
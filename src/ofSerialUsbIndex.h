@@ -0,0 +1,117 @@
+// This class is part of the standalone version of openFrameworks communication/serial
+// Distributerd under the MIT License.
+// Copyright (c) 2022 - Jean-François Erdelyi
+
+#pragma once
+
+#include "ofSerial.h"
+
+#ifdef TARGET_LINUX
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/// \brief USB identity of a serial device, see ofSerialUsbIndex.
+///
+/// The strings point into the index that produced it and stay valid until
+/// its next rebuild() or its destruction.
+struct ofSerialUsbDevice {
+	uint16_t vendorId = 0;  ///< \brief idVendor, 0x0403 for FTDI.
+	uint16_t productId = 0;  ///< \brief idProduct.
+	uint8_t interfaceNumber = 0;  ///< \brief bInterfaceNumber, devices with several ports have one per port.
+	std::string_view ttyName;  ///< \brief ttyUSB0, ttyACM1...
+	std::string_view devicePath;  ///< \brief The path to give to ofSerial::setup(), /dev/ttyUSB0.
+	std::string_view serialNumber;  ///< \brief Empty if the device has none.
+	std::string_view manufacturer;
+	std::string_view product;
+	std::string_view byIdPath;  ///< \brief The /dev/serial/by-id link naming this device, empty if udev made none.
+};
+
+/// \brief Finds serial devices by USB vendor, product and serial number.
+///
+/// rebuild() reads the attributes of every /sys/class/tty entry backed by a
+/// USB interface once, and the /dev/serial/by-id links, into a table whose
+/// strings share one buffer. Lookups are then hash table hits, they touch
+/// neither the file system nor the allocator.
+///
+/// ~~~~{.cpp}
+/// ofSerialUsbIndex index;
+/// if(auto device = index.find(0x0403, 0x6001, "A600EXYZ")){
+///	 serial.setup(std::string(device->devicePath), 115200);
+/// }
+/// ~~~~
+///
+/// The roots can point to a copy of the sysfs and /dev layouts, to test or
+/// benchmark the indexing without the devices. The index is not updated by
+/// itself, call rebuild() when ofSerialDeviceRegistry reports a change.
+class ofSerialUsbIndex {
+
+public:
+	/// \brief Builds the index.
+	/// \param sysfsRoot Where sysfs is mounted.
+	/// \param devRoot Where the device nodes and the serial/by-id links are.
+	explicit ofSerialUsbIndex(std::string_view sysfsRoot = "/sys", std::string_view devRoot = "/dev");
+
+	/// \brief Reads sysfs again, every ofSerialUsbDevice handed before is invalidated.
+	/// \returns the number of USB serial devices found.
+	size_t rebuild();
+
+	/// \returns every indexed device, ordered by tty name.
+	std::span<const ofSerialUsbDevice> getDevices() const{
+		return devices;
+	}
+
+	/// \brief Finds a device by USB identity.
+	///
+	/// With several interfaces (an FT2232 has two ports) the lowest interface
+	/// number is returned, use findInterface() for the others.
+	/// \returns nullptr if no device matches.
+	const ofSerialUsbDevice * find(uint16_t vendorId, uint16_t productId, std::string_view serialNumber) const;
+
+	/// \brief Finds the first device with this vendor and product, whatever its serial number.
+	const ofSerialUsbDevice * find(uint16_t vendorId, uint16_t productId) const;
+
+	/// \brief Finds one interface of a device with several ports.
+	const ofSerialUsbDevice * findInterface(uint16_t vendorId, uint16_t productId, std::string_view serialNumber, uint8_t interfaceNumber) const;
+
+	/// \brief Finds a device by its by-id link, either the full path or the link name.
+	const ofSerialUsbDevice * findByIdPath(std::string_view path) const;
+
+	/// \brief Finds a device by tty name (ttyUSB0) or path (/dev/ttyUSB0).
+	const ofSerialUsbDevice * findByName(std::string_view nameOrPath) const;
+
+protected:
+	/// \cond INTERNAL
+	struct Key {
+		uint32_t product;  ///< \brief vendorId << 16 | productId.
+		std::string_view serialNumber;
+		int interfaceNumber;  ///< \brief -1 in the table of first interfaces.
+
+		bool operator==(const Key & other) const = default;
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key & key) const{
+			return std::hash<std::string_view>()(key.serialNumber) ^ (size_t(key.product) * size_t(0x9E3779B97F4A7C15ull)) ^ size_t(key.interfaceNumber + 1);
+		}
+	};
+
+	static std::string_view getBaseName(std::string_view path);
+
+	std::string sysfsRoot;
+	std::string devRoot;
+
+	std::string strings;  ///< \brief Every string of the table, sized once per rebuild().
+	std::vector<ofSerialUsbDevice> devices;
+	std::unordered_map<Key, uint32_t, KeyHash> byIdentity;  ///< \brief Indices in devices, for find() and findInterface().
+	std::unordered_map<uint32_t, uint32_t> byProduct;
+	std::unordered_map<std::string_view, uint32_t> byIdLink;  ///< \brief Keyed by link name.
+	std::unordered_map<std::string_view, uint32_t> byName;
+	/// \endcond
+};
+
+#endif // TARGET_LINUX